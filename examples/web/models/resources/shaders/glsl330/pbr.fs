@@ -12,24 +12,21 @@
 #define     MAX_DEPTH_LAYER         20
 #define     MIN_DEPTH_LAYER         10
 
-#define     MAX_LIGHTS              4
+#define     MAX_LIGHTS              64
 #define     LIGHT_DIRECTIONAL       0
 #define     LIGHT_POINT             1
 
+#define     LIGHTS_MASKS            ((MAX_LIGHTS + 31)/32)
+#define     CLUSTERS_X              16
+#define     CLUSTERS_Y              9
+#define     CLUSTERS_Z              24
+
 struct MaterialProperty {
     vec3 color;
     int useSampler;
     sampler2D sampler;
 };
 
-struct Light {
-    int enabled;
-    int type;
-    vec3 position;
-    vec3 target;
-    vec4 color;
-};
-
 // Input vertex attributes (from vertex shader)
 in vec3 fragPosition;
 in vec2 fragTexCoord;
@@ -52,7 +49,15 @@ uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
 
 // Input lighting values
-uniform Light lights[MAX_LIGHTS];
+// NOTE: Every light is packed into three vec4: position (direction for directional lights) and type (negative if disabled), color, radius
+uniform vec4 lightsData[MAX_LIGHTS*3];
+uniform int lightsCount;
+
+// Input lights clusters values
+// NOTE: Clusters texture keeps a lights bitmask for every view frustum cluster, clusters view
+// rows map fragment position to cluster tile and depth slice (all zero if clusters not available)
+uniform sampler2D lightsClusters;
+uniform vec4 lightsClustersView[4];
 
 // Other uniform values
 uniform int renderMode;
@@ -72,6 +77,8 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec3 fresnelSchlick(float cosTheta, vec3 F0);
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir);
+vec2 GetClusterCoords(vec3 position);
+void AddLight(vec4 lightData, vec4 lightColor, vec4 lightRadius, vec3 normal, vec3 view, vec3 color, vec3 F0, float metal, float rough, inout vec3 Lo, inout vec3 lightDot);
 
 // WARNING: There is some weird behaviour with this function, always returns black!
 // Yes, I even tried: return texture(property.sampler, texCoord).rgb;
@@ -173,6 +180,70 @@ vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir)
     return finalTexCoords;
 }
 
+// Get fragment cluster first lights mask texture coordinates
+vec2 GetClusterCoords(vec3 position)
+{
+    vec4 point = vec4(position, 1.0);
+    float depth = max(dot(lightsClustersView[2], point), 0.0001);
+
+    float x = clamp(floor(dot(lightsClustersView[0], point)/depth + lightsClustersView[3].x), 0.0, float(CLUSTERS_X - 1));
+    float y = clamp(floor(dot(lightsClustersView[1], point)/depth + lightsClustersView[3].y), 0.0, float(CLUSTERS_Y - 1));
+    float z = clamp(floor(log(depth)*lightsClustersView[3].z + lightsClustersView[3].w), 0.0, float(CLUSTERS_Z - 1));
+
+    return vec2((x + y*float(CLUSTERS_X) + 0.5)/float(CLUSTERS_X*CLUSTERS_Y), (z*float(LIGHTS_MASKS) + 0.5)/float(CLUSTERS_Z*LIGHTS_MASKS));
+}
+
+// Add light outgoing radiance and lighting contribution
+void AddLight(vec4 lightData, vec4 lightColor, vec4 lightRadius, vec3 normal, vec3 view, vec3 color, vec3 F0, float metal, float rough, inout vec3 Lo, inout vec3 lightDot)
+{
+    int lightType = int(lightData.w);
+    if (lightType < 0) return;
+
+    // Calculate per-light radiance
+    vec3 light = vec3(0.0);
+    vec3 radiance = lightColor.rgb;
+    if (lightType == LIGHT_DIRECTIONAL) light = normalize(lightData.xyz);
+    else if (lightType == LIGHT_POINT)
+    {
+        light = normalize(lightData.xyz - fragPosition);
+        float distance = length(lightData.xyz - fragPosition);
+        float attenuation = 1.0/(distance*distance);
+
+        // Fade light out to zero at light radius (if any)
+        if (lightRadius.x > 0.0)
+        {
+            float window = clamp(1.0 - pow(distance/lightRadius.x, 4.0), 0.0, 1.0);
+            attenuation *= window*window;
+        }
+
+        radiance *= attenuation;
+    }
+
+    // Cook-torrance BRDF
+    vec3 high = normalize(view + light);
+    float NDF = DistributionGGX(normal, high, rough);
+    float G = GeometrySmith(normal, view, light, rough);
+    vec3 F = fresnelSchlick(max(dot(high, view), 0.0), F0);
+    vec3 nominator = NDF*G*F;
+    float denominator = 4*max(dot(normal, view), 0.0)*max(dot(normal, light), 0.0) + 0.001;
+    vec3 brdf = nominator/denominator;
+
+    // Store to kS the fresnel value and calculate energy conservation
+    vec3 kS = F;
+    vec3 kD = vec3(1.0) - kS;
+
+    // Multiply kD by the inverse metalness such that only non-metals have diffuse lighting
+    kD *= 1.0 - metal;
+
+    // Scale light by dot product between normal and light direction
+    float NdotL = max(dot(normal, light), 0.0);
+
+    // Add to outgoing radiance Lo
+    // Note: BRDF is already multiplied by the Fresnel so it doesn't need to be multiplied again
+    Lo += (kD*color/PI + brdf)*radiance*NdotL*lightColor.a;
+    lightDot += radiance*NdotL + brdf*lightColor.a;
+}
+
 void main()
 {
     // Calculate TBN and RM matrices
@@ -215,45 +286,28 @@ void main()
     vec3 Lo = vec3(0.0);
     vec3 lightDot = vec3(0.0);
 
-    for (int i = 0; i < MAX_LIGHTS; i++)
+    // Evaluate only the lights in fragment cluster (every light if clusters not available)
+    // NOTE: Lights masks are scanned by bytes, so empty groups of eight lights are skipped
+    bool clustered = (lightsClustersView[3].x > 0.0);
+    vec2 clusterCoords = GetClusterCoords(fragPosition);
+
+    for (int m = 0; m < LIGHTS_MASKS; m++)
     {
-        if (lights[i].enabled == 1)
+        vec4 mask = vec4(255.0);
+        if (clustered) mask = floor(texture(lightsClusters, clusterCoords + vec2(0.0, float(m)/float(CLUSTERS_Z*LIGHTS_MASKS)))*255.0 + 0.5);
+
+        for (int c = 0; c < 4; c++)
         {
-            // Calculate per-light radiance
-            vec3 light = vec3(0.0);
-            vec3 radiance = lights[i].color.rgb;
-            if (lights[i].type == LIGHT_DIRECTIONAL) light = -normalize(lights[i].target - lights[i].position);
-            else if (lights[i].type == LIGHT_POINT)
+            float bits = mask[c];
+
+            for (int b = 0; b < 8; b++)
             {
-                light = normalize(lights[i].position - fragPosition);
-                float distance = length(lights[i].position - fragPosition);
-                float attenuation = 1.0/(distance*distance);
-                radiance *= attenuation;
-            }
+                if ((bits < 1.0) || ((m*32 + c*8 + b) >= lightsCount)) break;
 
-            // Cook-torrance BRDF
-            vec3 high = normalize(view + light);
-            float NDF = DistributionGGX(normal, high, rough.r);
-            float G = GeometrySmith(normal, view, light, rough.r);
-            vec3 F = fresnelSchlick(max(dot(high, view), 0.0), F0);
-            vec3 nominator = NDF*G*F;
-            float denominator = 4*max(dot(normal, view), 0.0)*max(dot(normal, light), 0.0) + 0.001;
-            vec3 brdf = nominator/denominator;
-
-            // Store to kS the fresnel value and calculate energy conservation
-            vec3 kS = F;
-            vec3 kD = vec3(1.0) - kS;
-
-            // Multiply kD by the inverse metalness such that only non-metals have diffuse lighting
-            kD *= 1.0 - metal.r;
-
-            // Scale light by dot product between normal and light direction
-            float NdotL = max(dot(normal, light), 0.0);
-
-            // Add to outgoing radiance Lo
-            // Note: BRDF is already multiplied by the Fresnel so it doesn't need to be multiplied again
-            Lo += (kD*color/PI + brdf)*radiance*NdotL*lights[i].color.a;
-            lightDot += radiance*NdotL + brdf*lights[i].color.a;
+                int i = m*32 + c*8 + b;
+                if (mod(bits, 2.0) >= 1.0) AddLight(lightsData[i*3], lightsData[i*3 + 1], lightsData[i*3 + 2], normal, view, color, F0, metal.r, rough.r, Lo, lightDot);
+                bits = floor(bits*0.5);
+            }
         }
     }
 
@@ -9,6 +9,37 @@
 *       If not defined, the library is in header only mode and can be included in other headers 
 *       or source files without problems. But only ONE file should hold the implementation.
 *
+*   #define MAX_LIGHTS
+*       Max lights supported by the shader, must match the shader MAX_LIGHTS define (default: 64).
+*       Every light takes three vec4 of the shader lightsData uniform array. GLSL 330 drivers usually
+*       allow some hundreds of lights, but GLSL 100 (OpenGL ES 2.0, WebGL 1.0) devices may only allow
+*       64 fragment uniform vectors, so GLSL 100 shaders support 16 lights: define MAX_LIGHTS as 16
+*       before including this header when using them.
+*
+*   #define LIGHTS_CLUSTERS_X
+*   #define LIGHTS_CLUSTERS_Y
+*   #define LIGHTS_CLUSTERS_Z
+*       View frustum clusters grid size (default: 16x9x24), must match the shader CLUSTERS_X/Y/Z defines.
+*       Clusters depth slices are exponentially distributed between LIGHTS_CLUSTERS_NEAR and LIGHTS_CLUSTERS_FAR.
+*
+*   NOTE: Lights values are packed into a single vec4 array (position or direction and type, color, radius),
+*   UpdateLightValues() only packs the light and marks it dirty, UpdateLightsBuffer() sends all lights
+*   changed since last upload to a shader in one upload, so it should be called once per frame after
+*   updating the lights. Lights are not tied to any shader, a LightsBinding (LoadLightsBinding()) keeps
+*   the lights uniforms locations of a shader (retrieved once) and what was already sent to it, so the
+*   same lights can be sent to multiple shaders. Call LoadLightsBinding() again after reloading a shader.
+*
+*   NOTE: UpdateLightsClusters() assigns lights to view frustum clusters (froxels) and uploads a bitmask of
+*   the lights affecting every cluster as a texture (LoadLightsClusters()), so the shader only evaluates
+*   the lights affecting the fragment cluster. Point lights with no radius and directional lights affect
+*   all clusters. Shaders evaluate every light while no clusters have been sent.
+*
+*   NOTE: Lights values are kept in a uniform array, not in a uniform buffer or a float texture: raylib has no
+*   uniform buffers API and OpenGL ES 2.0 / WebGL 1.0 do not guarantee float textures, so a vec4 array works the
+*   same on every GLSL version (lights count is limited by shader uniform vectors, see MAX_LIGHTS). Lights clusters
+*   only need one bit per light, so they use a regular RGBA8 texture, bound once to the shader through a spare
+*   material map like any other second texture (i.e. MATERIAL_MAP_EMISSION, as shaders_simple_mask example does).
+*
 *   LICENSE: zlib/libpng
 *
 *   Copyright (c) 2017 Victor Fisac and Ramon Santamaria
@@ -36,10 +67,33 @@
 //----------------------------------------------------------------------------------
 // Defines and Macros
 //----------------------------------------------------------------------------------
-#define         MAX_LIGHTS            4         // Max lights supported by shader
+#if !defined(MAX_LIGHTS)
+    #define     MAX_LIGHTS            64        // Max lights supported by shader
+#endif
+
 #define         LIGHT_DISTANCE        3.5f      // Light distance from world center
 #define         LIGHT_HEIGHT          1.0f      // Light height position
 
+#define         LIGHT_DATA_VECTORS    3         // Packed light data vec4 count (position or direction and type, color, radius)
+
+#if !defined(LIGHTS_CLUSTERS_X)
+    #define     LIGHTS_CLUSTERS_X     16        // View frustum clusters grid horizontal tiles
+#endif
+#if !defined(LIGHTS_CLUSTERS_Y)
+    #define     LIGHTS_CLUSTERS_Y     9         // View frustum clusters grid vertical tiles
+#endif
+#if !defined(LIGHTS_CLUSTERS_Z)
+    #define     LIGHTS_CLUSTERS_Z     24        // View frustum clusters grid depth slices
+#endif
+#if !defined(LIGHTS_CLUSTERS_NEAR)
+    #define     LIGHTS_CLUSTERS_NEAR  0.1f      // First clusters depth slice far distance (nearer fragments use first slice)
+#endif
+#if !defined(LIGHTS_CLUSTERS_FAR)
+    #define     LIGHTS_CLUSTERS_FAR   100.0f    // Last clusters depth slice near distance (farther fragments use last slice)
+#endif
+
+#define         LIGHTS_CLUSTERS_MASKS ((MAX_LIGHTS + 31)/32)    // Lights mask texels per cluster (32 lights per RGBA texel)
+
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
 //----------------------------------------------------------------------------------
@@ -54,13 +108,21 @@ typedef struct {
     Vector3 position;
     Vector3 target;
     Color color;
-    int enabledLoc;
-    int typeLoc;
-    int posLoc;
-    int targetLoc;
-    int colorLoc;
+    float radius;           // Point light influence radius (0 for unlimited radius)
+    int id;                 // Light index in packed lights buffer (-1 if light could not be created)
 } Light;
 
+// Lights shader binding
+typedef struct {
+    Shader shader;                  // Shader lights are sent to
+    int dataLoc;                    // Shader location of packed lights values (lightsData)
+    int countLoc;                   // Shader location of lights count (lightsCount)
+    int clustersViewLoc;            // Shader location of clusters view transform (lightsClustersView)
+    unsigned int version;           // Lights buffer version last sent to shader
+    unsigned int clustersVersion;   // Lights clusters version last sent to shader
+    int count;                      // Lights count last sent to shader
+} LightsBinding;
+
 #ifdef __cplusplus
 extern "C" {            // Prevents name mangling of functions
 #endif
@@ -73,8 +135,15 @@ int lightsCount = 0;                     // Current amount of created lights
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
-Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, Shader shader);         // Defines a light and get locations from PBR shader
-void UpdateLightValues(Shader shader, Light light);                                         // Send to PBR shader light values
+Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, float radius);         // Defines a light, radius limits point lights (sent to PBR shader on next lights buffer update)
+void UpdateLightValues(Light light);                                                        // Pack light values and mark light dirty
+
+LightsBinding LoadLightsBinding(Shader shader);                                             // Load lights binding for PBR shader (get lights uniforms locations)
+void UpdateLightsBuffer(LightsBinding *binding);                                            // Send to PBR shader lights changed since last update in one upload
+
+Texture2D LoadLightsClusters(void);                                                         // Load lights clusters texture (lights mask for every view frustum cluster)
+void UnloadLightsClusters(void);                                                            // Unload lights clusters texture
+void UpdateLightsClusters(Camera camera, float aspect);                                     // Assign lights to view frustum clusters (sent on next lights buffer update)
 
 #ifdef __cplusplus
 }
@@ -93,6 +162,10 @@ void UpdateLightValues(Shader shader, Light light);
 
 #include "raylib.h"
 
+#include <stdlib.h>         // Required for: calloc(), free()
+#include <string.h>         // Required for: memset(), memcpy()
+#include <math.h>           // Required for: sqrtf(), tanf(), logf(), floorf()
+
 //----------------------------------------------------------------------------------
 // Defines and Macros
 //----------------------------------------------------------------------------------
@@ -106,21 +179,30 @@ void UpdateLightValues(Shader shader, Light light);
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
-// ...
+static float lightsData[MAX_LIGHTS*LIGHT_DATA_VECTORS*4] = { 0 };   // Packed lights values, uploaded as a vec4 array
+static unsigned int lightsVersions[MAX_LIGHTS] = { 0 };            // Lights buffer version every light was last packed at
+static unsigned int lightsVersion = 0;                              // Lights buffer version, incremented every light packed
+
+static Texture2D lightsClustersTexture = { 0 };     // Lights clusters texture, LIGHTS_CLUSTERS_MASKS texels column for every cluster
+static unsigned char *lightsClusters = NULL;        // Lights clusters texture data, one bit per light
+static float lightsClustersView[16] = { 0 };        // Lights clusters view transform, sent to shaders as a vec4 array
+static unsigned int lightsClustersVersion = 0;      // Lights clusters version, incremented every clusters update
 
 //----------------------------------------------------------------------------------
 // Module specific Functions Declaration
 //----------------------------------------------------------------------------------
-// ...
+static int GetClusterSlice(float depth, float sliceScale, float sliceBias);    // Get clusters depth slice containing a view depth
 
 //----------------------------------------------------------------------------------
 // Module Functions Definition
 //----------------------------------------------------------------------------------
 
-// Defines a light and get locations from PBR shader
-Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, Shader shader)
+// Defines a light, radius limits point lights (sent to PBR shader on next lights buffer update)
+// NOTE: Point lights fade out to zero at their radius, so clusters only get them inside it (0 for unlimited radius)
+Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, float radius)
 {
     Light light = { 0 };
+    light.id = -1;
 
     if (lightsCount < MAX_LIGHTS)
     {
@@ -129,49 +211,259 @@ Light CreateLight(int type, Vector3 pos, Vector3 targ, Color color, Shader shade
         light.position = pos;
         light.target = targ;
         light.color = color;
+        light.radius = radius;
+        light.id = lightsCount;
 
-        char enabledName[32] = "lights[x].enabled\0";
-        char typeName[32] = "lights[x].type\0";
-        char posName[32] = "lights[x].position\0";
-        char targetName[32] = "lights[x].target\0";
-        char colorName[32] = "lights[x].color\0";
-        enabledName[7] = '0' + lightsCount;
-        typeName[7] = '0' + lightsCount;
-        posName[7] = '0' + lightsCount;
-        targetName[7] = '0' + lightsCount;
-        colorName[7] = '0' + lightsCount;
-
-        light.enabledLoc = GetShaderLocation(shader, enabledName);
-        light.typeLoc = GetShaderLocation(shader, typeName);
-        light.posLoc = GetShaderLocation(shader, posName);
-        light.targetLoc = GetShaderLocation(shader, targetName);
-        light.colorLoc = GetShaderLocation(shader, colorName);
-
-        UpdateLightValues(shader, light);
         lightsCount++;
+
+        UpdateLightValues(light);
     }
 
     return light;
 }
 
-// Send to PBR shader light values
-void UpdateLightValues(Shader shader, Light light)
+// Pack light values and mark light dirty
+// NOTE: Nothing is sent to shaders until UpdateLightsBuffer() is called
+void UpdateLightValues(Light light)
 {
-    // Send to shader light enabled state and type
-    SetShaderValue(shader, light.enabledLoc, &light.enabled, UNIFORM_INT);
-    SetShaderValue(shader, light.typeLoc, &light.type, UNIFORM_INT);
+    if ((light.id < 0) || (light.id >= lightsCount)) return;
+
+    float *data = lightsData + light.id*LIGHT_DATA_VECTORS*4;
 
-    // Send to shader light position values
-    float position[3] = { light.position.x, light.position.y, light.position.z };
-    SetShaderValue(shader, light.posLoc, position, UNIFORM_VEC3);
+    // Pack light position (direction towards light for directional lights) and type (negative if disabled)
+    if (light.type == LIGHT_DIRECTIONAL)
+    {
+        data[0] = light.position.x - light.target.x;
+        data[1] = light.position.y - light.target.y;
+        data[2] = light.position.z - light.target.z;
+    }
+    else
+    {
+        data[0] = light.position.x;
+        data[1] = light.position.y;
+        data[2] = light.position.z;
+    }
+
+    data[3] = light.enabled? (float)light.type : -1.0f;
+
+    // Pack light color values
+    data[4] = (float)light.color.r/(float)255;
+    data[5] = (float)light.color.g/(float)255;
+    data[6] = (float)light.color.b/(float)255;
+    data[7] = (float)light.color.a/(float)255;
+
+    // Pack light radius
+    data[8] = (light.radius > 0.0f)? light.radius : 0.0f;
+
+    lightsVersion++;
+    lightsVersions[light.id] = lightsVersion;
+}
+
+// Load lights binding for PBR shader (get lights uniforms locations)
+// NOTE: Shader locations are only retrieved here, load the binding again after reloading the shader
+LightsBinding LoadLightsBinding(Shader shader)
+{
+    LightsBinding binding = { 0 };
+
+    binding.shader = shader;
+    binding.dataLoc = GetShaderLocation(shader, "lightsData");
+    binding.countLoc = GetShaderLocation(shader, "lightsCount");
+    binding.clustersViewLoc = GetShaderLocation(shader, "lightsClustersView");
+    binding.count = -1;     // Nothing sent yet, all lights are sent on first update
+
+    return binding;
+}
+
+// Send to PBR shader lights changed since last update in one upload
+// NOTE: Lights are sent from first light up to the last light changed, lights clusters view only if clusters changed
+void UpdateLightsBuffer(LightsBinding *binding)
+{
+    int count = 0;
+    for (int i = lightsCount - 1; i >= 0; i--)
+    {
+        if (lightsVersions[i] > binding->version)
+        {
+            count = i + 1;
+            break;
+        }
+    }
+
+    if (count > 0) SetShaderValueV(binding->shader, binding->dataLoc, lightsData, UNIFORM_VEC4, count*LIGHT_DATA_VECTORS);
+    binding->version = lightsVersion;
+
+    if (binding->count != lightsCount)
+    {
+        SetShaderValue(binding->shader, binding->countLoc, &lightsCount, UNIFORM_INT);
+        binding->count = lightsCount;
+    }
+
+    if (binding->clustersVersion != lightsClustersVersion)
+    {
+        SetShaderValueV(binding->shader, binding->clustersViewLoc, lightsClustersView, UNIFORM_VEC4, 4);
+        binding->clustersVersion = lightsClustersVersion;
+    }
+}
+
+// Load lights clusters texture (lights mask for every view frustum cluster)
+// NOTE: Texture should be bound to the shader lightsClusters sampler using a spare material map, it is an RGBA8
+// texture (no float textures required) updated in place, so material keeps it bound
+Texture2D LoadLightsClusters(void)
+{
+    if (lightsClustersTexture.id == 0)
+    {
+        Image image = { 0 };
+        image.width = LIGHTS_CLUSTERS_X*LIGHTS_CLUSTERS_Y;
+        image.height = LIGHTS_CLUSTERS_Z*LIGHTS_CLUSTERS_MASKS;
+        image.mipmaps = 1;
+        image.format = UNCOMPRESSED_R8G8B8A8;
+
+        lightsClusters = (unsigned char *)calloc(image.width*image.height*4, sizeof(unsigned char));
+        image.data = lightsClusters;
+
+        lightsClustersTexture = LoadTextureFromImage(image);
+    }
+
+    return lightsClustersTexture;
+}
+
+// Unload lights clusters texture
+void UnloadLightsClusters(void)
+{
+    if (lightsClustersTexture.id > 0) UnloadTexture(lightsClustersTexture);
+
+    free(lightsClusters);
+    lightsClusters = NULL;
+    lightsClustersTexture = (Texture2D){ 0 };
+
+    // Shaders evaluate every light again once they receive an empty clusters view
+    memset(lightsClustersView, 0, sizeof(lightsClustersView));
+    lightsClustersVersion++;
+}
+
+// Assign lights to view frustum clusters (sent to shaders on next lights buffer update)
+// NOTE: Lights values are read from lights buffer, so lights should be updated before (perspective cameras only)
+void UpdateLightsClusters(Camera camera, float aspect)
+{
+    if (lightsClusters == NULL) return;
+
+    // Calculate camera view basis (right, up and forward vectors)
+    Vector3 forward = { camera.target.x - camera.position.x, camera.target.y - camera.position.y, camera.target.z - camera.position.z };
+    float length = sqrtf(forward.x*forward.x + forward.y*forward.y + forward.z*forward.z);
+    if (length > 0.0f) { forward.x /= length; forward.y /= length; forward.z /= length; }
+
+    Vector3 right = { forward.y*camera.up.z - forward.z*camera.up.y, forward.z*camera.up.x - forward.x*camera.up.z, forward.x*camera.up.y - forward.y*camera.up.x };
+    length = sqrtf(right.x*right.x + right.y*right.y + right.z*right.z);
+    if (length > 0.0f) { right.x /= length; right.y /= length; right.z /= length; }
+
+    Vector3 up = { right.y*forward.z - right.z*forward.y, right.z*forward.x - right.x*forward.z, right.x*forward.y - right.y*forward.x };
+
+    // Calculate clusters grid transform: view position over depth to tile coordinates and view depth to slice
+    float tanY = tanf(camera.fovy*0.5f*DEG2RAD);
+    float scaleX = (float)LIGHTS_CLUSTERS_X/(2.0f*tanY*aspect);
+    float scaleY = (float)LIGHTS_CLUSTERS_Y/(2.0f*tanY);
+    float sliceScale = (float)LIGHTS_CLUSTERS_Z/logf(LIGHTS_CLUSTERS_FAR/LIGHTS_CLUSTERS_NEAR);
+    float sliceBias = -logf(LIGHTS_CLUSTERS_NEAR)*sliceScale;
+
+    // Assign lights to clusters
+    // NOTE: Lights are tested against the planes between tiles (grid outer tiles and slices are unbounded),
+    // every cluster inside the tiles and slices range overlapped by the light bounding sphere is marked
+    int width = LIGHTS_CLUSTERS_X*LIGHTS_CLUSTERS_Y;
+    memset(lightsClusters, 0, width*LIGHTS_CLUSTERS_Z*LIGHTS_CLUSTERS_MASKS*4);
+
+    for (int i = 0; i < lightsCount; i++)
+    {
+        const float *data = lightsData + i*LIGHT_DATA_VECTORS*4;
+        if (data[3] < 0.0f) continue;       // Light disabled
+
+        int minX = 0, maxX = LIGHTS_CLUSTERS_X - 1;
+        int minY = 0, maxY = LIGHTS_CLUSTERS_Y - 1;
+        int minZ = 0, maxZ = LIGHTS_CLUSTERS_Z - 1;
+
+        float radius = data[8];
+
+        if (((int)data[3] == LIGHT_POINT) && (radius > 0.0f))
+        {
+            Vector3 delta = { data[0] - camera.position.x, data[1] - camera.position.y, data[2] - camera.position.z };
+            float viewX = delta.x*right.x + delta.y*right.y + delta.z*right.z;
+            float viewY = delta.x*up.x + delta.y*up.y + delta.z*up.z;
+            float viewZ = delta.x*forward.x + delta.y*forward.y + delta.z*forward.z;
+
+            if ((viewZ + radius) <= 0.0f) continue;     // Light behind camera
+
+            minZ = GetClusterSlice(viewZ - radius, sliceScale, sliceBias);
+            maxZ = GetClusterSlice(viewZ + radius, sliceScale, sliceBias);
+
+            minX = LIGHTS_CLUSTERS_X; maxX = -1;
+            for (int x = 0; x < LIGHTS_CLUSTERS_X; x++)
+            {
+                float tileLeft = (x - LIGHTS_CLUSTERS_X*0.5f)/scaleX;
+                float tileRight = (x + 1 - LIGHTS_CLUSTERS_X*0.5f)/scaleX;
+
+                if ((x > 0) && ((viewX - tileLeft*viewZ) < -radius*sqrtf(1.0f + tileLeft*tileLeft))) continue;
+                if ((x < (LIGHTS_CLUSTERS_X - 1)) && ((viewX - tileRight*viewZ) > radius*sqrtf(1.0f + tileRight*tileRight))) continue;
+
+                if (x < minX) minX = x;
+                maxX = x;
+            }
+
+            minY = LIGHTS_CLUSTERS_Y; maxY = -1;
+            for (int y = 0; y < LIGHTS_CLUSTERS_Y; y++)
+            {
+                float tileBottom = (y - LIGHTS_CLUSTERS_Y*0.5f)/scaleY;
+                float tileTop = (y + 1 - LIGHTS_CLUSTERS_Y*0.5f)/scaleY;
+
+                if ((y > 0) && ((viewY - tileBottom*viewZ) < -radius*sqrtf(1.0f + tileBottom*tileBottom))) continue;
+                if ((y < (LIGHTS_CLUSTERS_Y - 1)) && ((viewY - tileTop*viewZ) > radius*sqrtf(1.0f + tileTop*tileTop))) continue;
+
+                if (y < minY) minY = y;
+                maxY = y;
+            }
+        }
+
+        // Set light bit for every cluster in range
+        int offset = (i/32)*width*4 + (i%32)/8;
+        unsigned char bit = (unsigned char)(1 << (i%8));
+
+        for (int z = minZ; z <= maxZ; z++)
+        {
+            for (int y = minY; y <= maxY; y++)
+            {
+                unsigned char *cluster = lightsClusters + offset + (z*LIGHTS_CLUSTERS_MASKS*width + y*LIGHTS_CLUSTERS_X)*4;
+                for (int x = minX; x <= maxX; x++) cluster[x*4] |= bit;
+            }
+        }
+    }
+
+    UpdateTexture(lightsClustersTexture, lightsClusters);
+
+    // Store clusters view transform: scaled right, up and forward rows (with camera offset) and grid center and depth slices mapping
+    float eyeX = -(right.x*camera.position.x + right.y*camera.position.y + right.z*camera.position.z);
+    float eyeY = -(up.x*camera.position.x + up.y*camera.position.y + up.z*camera.position.z);
+    float eyeZ = -(forward.x*camera.position.x + forward.y*camera.position.y + forward.z*camera.position.z);
+
+    float view[16] = {
+        right.x*scaleX, right.y*scaleX, right.z*scaleX, eyeX*scaleX,
+        up.x*scaleY, up.y*scaleY, up.z*scaleY, eyeY*scaleY,
+        forward.x, forward.y, forward.z, eyeZ,
+        LIGHTS_CLUSTERS_X*0.5f, LIGHTS_CLUSTERS_Y*0.5f, sliceScale, sliceBias
+    };
+
+    memcpy(lightsClustersView, view, sizeof(view));
+    lightsClustersVersion++;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get clusters depth slice containing a view depth
+static int GetClusterSlice(float depth, float sliceScale, float sliceBias)
+{
+    if (depth <= LIGHTS_CLUSTERS_NEAR) return 0;
 
-    // Send to shader light target position values
-    float target[3] = { light.target.x, light.target.y, light.target.z };
-    SetShaderValue(shader, light.targetLoc, target, UNIFORM_VEC3);
+    int slice = (int)floorf(logf(depth)*sliceScale + sliceBias);
 
-    // Send to shader light color values
-    float diff[4] = { (float)light.color.r/(float)255, (float)light.color.g/(float)255, (float)light.color.b/(float)255, (float)light.color.a/(float)255 };
-    SetShaderValue(shader, light.colorLoc, diff, UNIFORM_VEC4);
+    return (slice < LIGHTS_CLUSTERS_Z)? slice : LIGHTS_CLUSTERS_Z - 1;
 }
 
 #endif // RLIGHTS_IMPLEMENTATION
\ No newline at end of file
@@ -29,14 +29,92 @@
 *       internally in the library and input management and drawing functions must be provided by
 *       the user (check library implementation for further details).
 *
+*   #define PHYSAC_NO_SIMD
+*       Polygons narrow phase uses scalar code only. Otherwise it uses SSE on x86 and WebAssembly SIMD128
+*       (emscripten -msimd128) when compiler targets them, results match scalar code within floating point precision.
+*
+*   #define PHYSAC_DETERMINISTIC
+*       Same inputs give bit identical results on every platform (native and emscripten builds): trigonometric functions
+*       are computed by physac itself with plain float operations, SIMD narrow phase is disabled, floating point contraction
+*       (fused multiply-add) is disabled in physac code and random seed is not changed. It requires IEEE single precision
+*       evaluation (FLT_EVAL_METHOD 0, SSE2 on 32 bit x86). Step simulations with StepPhysicsWorlds() (one step per call),
+*       RunPhysicsStep() and shatter budget depend on elapsed time.
+*
 *   #define PHYSAC_DEBUG
 *       Traces log messages when creating and destroying physics bodies and detects errors in physics
 *       calculations and reference exceptions; it is useful for debug purposes
 *
 *   #define PHYSAC_MALLOC()
+*   #define PHYSAC_REALLOC()
 *   #define PHYSAC_FREE()
-*       You can define your own malloc/free implementation replacing stdlib.h malloc()/free() functions.
-*       Otherwise it will include stdlib.h and use the C standard library malloc()/free() function.
+*       You can define your own malloc/realloc/free implementation replacing stdlib.h malloc()/realloc()/free() functions.
+*       Otherwise it will include stdlib.h and use the C standard library malloc()/realloc()/free() function.
+*
+*   #define PHYSAC_PROFILE_BEGIN(phase)
+*   #define PHYSAC_PROFILE_END(phase)
+*       Hooks called around every physics step phase (PhysicsPhase: broad, narrow, solve, integrate and correct),
+*       empty by default.
+*
+*   #define PHYSAC_STATS
+*       Times every physics step phase and counts pairs, contacts, solver iterations and pools allocations of last step,
+*       reported by GetPhysicsStats(). Otherwise statistics code is not compiled and only memory and steps are reported.
+*       Check physics_benchmark.c for an example.
+*
+*   NOTE: Contact islands (groups of touching dynamic bodies) are solved independently, SetPhysicsSolverThreads()
+*   spreads them over a worker threads pool. Results are the same with any amount of threads.
+*
+*   NOTE: Physics thread sleeps until next step deadline. Every update publishes a snapshot of bodies transforms (before and
+*   after last step) that render thread reads without locks: call UpdatePhysicsSnapshot() once per frame, then
+*   GetPhysicsBodyTransform() with GetPhysicsSnapshotAlpha() to draw bodies interpolated between the last two steps
+*   (GetPhysicsShapesLines() exports every snapshot body shape at once).
+*   Steps hold the world mutex: functions creating, destroying, shattering or changing bodies, queries and physics states
+*   take it too, so they can be called from other threads while physics thread runs (pools never grow under a step).
+*
+*   NOTE: RunPhysicsStep() runs every pending fixed step by default. After a stall, SetPhysicsMaxSteps() drops the time of steps
+*   over the limit (reported as time dilation by GetPhysicsStats()) and SetPhysicsAdaptiveIterations() lowers contact solver
+*   iterations first, so more pending steps fit the same solver work (only when more steps than usual per call are pending).
+*
+*   NOTE: Contacts are matched between steps by bodies pair and feature id, so solver starts from previous step impulses.
+*   Every contact island stops iterating once impulses change less than solver tolerance (SetPhysicsSolverTolerance()).
+*
+*   NOTE: Bodies with isBullet set use continuous collision detection: they stop at their first time of impact instead of
+*   passing through thin bodies, so fast bodies do not require a small time step (SetPhysicsTimeStep()).
+*
+*   NOTE: Contact islands resting for PHYSAC_SLEEP_TIME are put to sleep (isSleeping) and skip dynamics until a force,
+*   torque or contact with an awake body wakes them up. Moving a sleeping body (position, rotation or velocity) wakes it up too.
+*   Destroying a body wakes up the bodies touching it and changing gravity wakes up all bodies.
+*
+*   NOTE: SavePhysicsState() writes a compact binary copy of bodies, shapes and persistent contacts into a user buffer (no
+*   allocations) and LoadPhysicsState() restores it in place, so next steps give exactly the same results (rollback and replay).
+*   Saved states can be encoded as a delta against a previous state (EncodePhysicsStateDelta()) to be sent over network.
+*   States use native byte order and are saved and loaded between steps (world mutex), also while physics loop thread runs.
+*
+*   NOTE: Spatial queries (PhysicsRaycast(), PhysicsQueryAABB() and PhysicsQueryPoint()) walk a bounding boxes tree. Tree leaves
+*   are enlarged by PHYSAC_TREE_MARGIN and only moving bodies leaving their leaf are reinserted, on first query after a step.
+*   Bodies moved by hand (position changed directly) are updated by next step.
+*
+*   NOTE: Every body caches its world space bounding box (computed again only when it moves) and bounding circle radius, used
+*   by broad-phase, narrow phase early-out, bullets and queries, and exposed by GetPhysicsBodyAABB() and GetPhysicsBodyRadius().
+*
+*   NOTE: CreatePhysicsBodyFromVertices() builds a polygon from the convex hull of any vertices set (simplified to PHYSAC_MAX_VERTICES)
+*   and CreatePhysicsBodyCompound() builds one rigid body from many convex pieces (concave shapes), colliding piece by piece.
+*   Bodies are placed at their shape centroid, so body position is not the given position unless the shape is centered.
+*
+*   NOTE: Bodies pairs collide only if each body categoryBits match the other body maskBits, checked before creating manifolds.
+*   Sensor bodies (isSensor) get no collision response, their overlaps are reported as begin and end contact events
+*   (GetPhysicsContactEvents()), touching pairs of solid bodies too if SetPhysicsContactEvents() is enabled.
+*
+*   NOTE: PhysicsShatter() queues fragments with precomputed mass data and spawns them from bodies pool (grown up front).
+*   SetPhysicsShatterBudget() spreads fragments spawning over next steps, spending at most given milliseconds every step.
+*
+*   NOTE: Every physics function works on the physics world bound to calling thread (default world unless SetPhysicsWorld()
+*   binds one created by CreatePhysicsWorld()). StepPhysicsWorlds() steps many worlds concurrently (SetPhysicsWorldsThreads()),
+*   those worlds must not run their own physics loop thread (InitPhysics()). Create and destroy worlds from one thread at a time.
+*
+*   #define PHYSAC_MAX_BODIES
+*   #define PHYSAC_MAX_MANIFOLDS
+*       Initial capacity of bodies and manifolds pools, reserved by InitPhysics(). Pools grow on demand,
+*       so they only need to be tuned to avoid reallocations on big scenes.
 *
 *
 *   NOTE 1: Physac requires multi-threading, when InitPhysics() a second thread is created to manage physics calculations.
@@ -86,20 +164,42 @@
 //----------------------------------------------------------------------------------
 // Defines and Macros
 //----------------------------------------------------------------------------------
-#define PHYSAC_MAX_BODIES               64
-#define PHYSAC_MAX_MANIFOLDS            4096
+#if !defined(PHYSAC_MAX_BODIES)
+    #define PHYSAC_MAX_BODIES           64      // Initial bodies pool capacity, pool grows on demand
+#endif
+#if !defined(PHYSAC_MAX_MANIFOLDS)
+    #define PHYSAC_MAX_MANIFOLDS        4096    // Initial manifolds pool capacity, pool grows on demand
+#endif
 #define PHYSAC_MAX_VERTICES             24
 #define PHYSAC_CIRCLE_VERTICES          24
 
-#define PHYSAC_COLLISION_ITERATIONS     100
+#define PHYSAC_COLLISION_ITERATIONS     10      // Max contact solver iterations per step (contacts impulses are warm started)
+#define PHYSAC_ADAPTIVE_ITERATIONS      2       // Min contact solver iterations per step when adaptive iterations lower them
+#define PHYSAC_SOLVER_TOLERANCE         0.0001f // Default contact solver tolerance, in pixels per millisecond
+#define PHYSAC_MAX_SOLVER_THREADS       16      // Max worker threads used to solve contact islands
+#define PHYSAC_MAX_WORLDS_THREADS       64      // Max worker threads used to step physics worlds
+#define PHYSAC_STATE_VERSION            3       // Physics state binary format version, states of other versions are rejected
 #define PHYSAC_PENETRATION_ALLOWANCE    0.05f
 #define PHYSAC_PENETRATION_CORRECTION   0.4f
+#define PHYSAC_SLEEP_LINEAR_VELOCITY    0.05f   // Max linear velocity of a resting body, in pixels per millisecond
+#define PHYSAC_SLEEP_ANGULAR_VELOCITY   0.002f  // Max angular velocity of a resting body, in radians per millisecond
+#define PHYSAC_SLEEP_TIME               500.0f  // Time in milliseconds a contact island must rest before going to sleep
+#define PHYSAC_CCD_ITERATIONS           20      // Max conservative advancement iterations to find a bullet body time of impact
+#define PHYSAC_TREE_MARGIN              4.0f    // Query tree bounding boxes margin in pixels, bodies moving less than it keep their tree leaf
+#define PHYSAC_TREE_STACK               256     // Query tree nodes pending to be visited kept in a query local stack, more nodes grow it in heap memory
 
 #define PHYSAC_PI                       3.14159265358979323846
 #define PHYSAC_DEG2RAD                  (PHYSAC_PI/180.0f)
 
-#define PHYSAC_MALLOC(size)             malloc(size)
-#define PHYSAC_FREE(ptr)                free(ptr)
+#if !defined(PHYSAC_MALLOC)
+    #define PHYSAC_MALLOC(size)         malloc(size)
+#endif
+#if !defined(PHYSAC_REALLOC)
+    #define PHYSAC_REALLOC(ptr, size)   realloc(ptr, size)
+#endif
+#if !defined(PHYSAC_FREE)
+    #define PHYSAC_FREE(ptr)            free(ptr)
+#endif
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
@@ -122,9 +222,22 @@
 
 typedef enum PhysicsShapeType { PHYSICS_CIRCLE, PHYSICS_POLYGON } PhysicsShapeType;
 
+// Physics step phases, reported to PHYSAC_PROFILE_BEGIN() and PHYSAC_PROFILE_END() hooks
+typedef enum PhysicsPhase {
+    PHYSICS_PHASE_BROAD,
+    PHYSICS_PHASE_NARROW,
+    PHYSICS_PHASE_SOLVE,
+    PHYSICS_PHASE_INTEGRATE,
+    PHYSICS_PHASE_CORRECT,
+    PHYSICS_PHASE_COUNT
+} PhysicsPhase;
+
 // Previously defined to be used in PhysicsShape struct as circular dependencies
 typedef struct PhysicsBodyData *PhysicsBody;
 
+// Physics world, independent simulation with its own bodies, manifolds and time step (opaque type)
+typedef struct PhysicsWorldData *PhysicsWorld;
+
 // Matrix2x2 type (used for polygon shape rotation matrix)
 typedef struct Matrix2x2 {
     float m00;
@@ -144,11 +257,13 @@ typedef struct PhysicsShape {
     PhysicsBody body;                           // Shape physics body reference
     float radius;                               // Circle shape radius (used for circle shapes)
     Matrix2x2 transform;                        // Vertices transform matrix 2x2
-    PolygonData vertexData;                     // Polygon shape vertices position and normals data (just used for polygon shapes)
+    PolygonData *vertexData;                    // Polygon shape vertices position and normals data (just used for polygon shapes, stored in polygons side table)
+    unsigned int piecesCount;                   // Polygon shape convex pieces, vertexData points to an array of pieces for compound shapes
 } PhysicsShape;
 
 typedef struct PhysicsBodyData {
     unsigned int id;                            // Reference unique identifier
+    unsigned int generation;                    // Body slot generation, incremented when body is destroyed (snapshots detect reused slots)
     bool enabled;                               // Enabled dynamics state (collisions are calculated anyway)
     Vector2 position;                           // Physics body shape pivot
     Vector2 velocity;                           // Current linear velocity applied to position
@@ -165,7 +280,12 @@ typedef struct PhysicsBodyData {
     float restitution;                          // Restitution coefficient of the body (0 to 1)
     bool useGravity;                            // Apply gravity force to dynamics
     bool isGrounded;                            // Physics grounded on other body state
+    bool isSleeping;                            // Physics sleeping state, resting bodies skip dynamics until woken up (read-only)
     bool freezeOrient;                          // Physics rotation constraint
+    bool isBullet;                              // Continuous collision detection state, fast body stops at first impact instead of passing through bodies
+    bool isSensor;                              // Sensor state, overlaps are reported as contact events without collision response
+    unsigned int categoryBits;                  // Collision filter categories the body belongs to
+    unsigned int maskBits;                      // Collision filter categories the body collides with (both bodies must accept each other)
     PhysicsShape shape;                         // Physics body shape information (type, radius, vertices, normals)
 } PhysicsBodyData;
 
@@ -173,15 +293,64 @@ typedef struct PhysicsManifoldData {
     unsigned int id;                            // Reference unique identifier
     PhysicsBody bodyA;                          // Manifold first physics body reference
     PhysicsBody bodyB;                          // Manifold second physics body reference
+    unsigned int pieceA;                        // Manifold first physics body shape piece (compound shapes get a manifold per pieces pair)
+    unsigned int pieceB;                        // Manifold second physics body shape piece
     float penetration;                          // Depth of penetration from collision
     Vector2 normal;                             // Normal direction vector from 'a' to 'b'
     Vector2 contacts[2];                        // Points of contact during collision
+    unsigned int contactsIds[2];                // Points of contact features identifiers (used to match contacts between steps)
     unsigned int contactsCount;                 // Current collision number of contacts
+    float normalImpulses[2];                    // Accumulated normal impulses of every contact (carried over between steps)
+    float tangentImpulses[2];                   // Accumulated tangent impulses of every contact (carried over between steps)
+    float normalMasses[2];                      // Effective mass along normal of every contact
+    float tangentMasses[2];                     // Effective mass along tangent of every contact
+    float velocityBiases[2];                    // Target normal velocity of every contact (restitution)
     float restitution;                          // Mixed restitution during collision
     float dynamicFriction;                      // Mixed dynamic friction during collision
     float staticFriction;                       // Mixed static friction during collision
 } PhysicsManifoldData, *PhysicsManifold;
 
+typedef struct PhysicsTransform {
+    Vector2 position;                           // Physics body position
+    float orient;                               // Physics body rotation in radians
+} PhysicsTransform;
+
+typedef struct PhysicsRaycastHit {
+    PhysicsBody body;                           // Physics body hit by the ray
+    Vector2 position;                           // Hit position in world space
+    Vector2 normal;                             // Physics body shape normal at hit position
+    float distance;                             // Distance from ray origin to hit position
+} PhysicsRaycastHit;
+
+// Physics contact event type, bodies pair starts or stops touching
+typedef enum PhysicsContactEventType { PHYSICS_CONTACT_BEGIN, PHYSICS_CONTACT_END } PhysicsContactEventType;
+
+typedef struct PhysicsContactEvent {
+    PhysicsContactEventType type;               // Contact event type (begin or end)
+    PhysicsBody bodyA;                          // First physics body reference (lower id)
+    PhysicsBody bodyB;                          // Second physics body reference
+    bool isSensor;                              // Bodies overlap reported by a sensor body (no collision response)
+} PhysicsContactEvent;
+
+// Physics statistics of last step (times and counters require PHYSAC_STATS, memory, steps and time dilation are always reported)
+typedef struct PhysicsStats {
+    double phaseTime[PHYSICS_PHASE_COUNT];      // Time spent in every physics step phase, in milliseconds
+    double stepTime;                            // Time spent in last physics step, in milliseconds
+    double updateTime;                          // Time spent in last RunPhysicsStep() call (all its steps), in milliseconds
+    unsigned int updateSteps;                   // Physics steps run by last RunPhysicsStep() call (more than one when catching up)
+    unsigned int pairsCount;                    // Broad-phase overlapping pairs tested by narrow phase
+    unsigned int manifoldsCount;                // Manifolds in contact after narrow phase
+    unsigned int contactsCount;                 // Contact points of manifolds in contact
+    unsigned int islandsCount;                  // Contact islands solved
+    unsigned int solverIterations;              // Contact solver iterations, summed over contact islands
+    unsigned int allocations;                   // Pools allocations (pools growth)
+    unsigned int usedMemory;                    // Total allocated dynamic memory, in bytes
+    unsigned int stepsCount;                    // Total physics steps processed
+    int maxIterations;                          // Contact solver max iterations per step (lowered by adaptive iterations)
+    float timeDilation;                         // Simulated time ratio of last RunPhysicsStep() call elapsed time (under 1 when time was dropped)
+    double droppedTime;                         // Total simulation time dropped by max steps, in milliseconds
+} PhysicsStats;
+
 #if defined(__cplusplus)
 extern "C" {                                    // Prevents name mangling of functions
 #endif
@@ -192,23 +361,57 @@ extern "C" {                                    // Prevents name mangling of fun
 PHYSACDEF void InitPhysics(void);                                                                           // Initializes physics values, pointers and creates physics loop thread
 PHYSACDEF void RunPhysicsStep(void);                                                                        // Run physics step, to be used if PHYSICS_NO_THREADS is set in your main loop
 PHYSACDEF void SetPhysicsTimeStep(double delta);                                                            // Sets physics fixed time step in milliseconds. 1.666666 by default
+PHYSACDEF void SetPhysicsMaxSteps(int steps);                                                               // Sets max physics steps run by a RunPhysicsStep() call, time over them is dropped (0 for no limit)
+PHYSACDEF void SetPhysicsAdaptiveIterations(bool enabled);                                                  // Sets contact solver iterations lowered while RunPhysicsStep() catches up, before dropping time
 PHYSACDEF bool IsPhysicsEnabled(void);                                                                      // Returns true if physics thread is currently enabled
 PHYSACDEF void SetPhysicsGravity(float x, float y);                                                         // Sets physics global gravity force
+PHYSACDEF void SetPhysicsSolverThreads(int count);                                                          // Sets worker threads used to solve contact islands (0 solves them in physics step thread)
+PHYSACDEF void SetPhysicsSolverTolerance(float tolerance);                                                  // Sets contact solver tolerance, islands stop iterating when impulses change less than it
 PHYSACDEF PhysicsBody CreatePhysicsBodyCircle(Vector2 pos, float radius, float density);                    // Creates a new circle physics body with generic parameters
 PHYSACDEF PhysicsBody CreatePhysicsBodyRectangle(Vector2 pos, float width, float height, float density);    // Creates a new rectangle physics body with generic parameters
 PHYSACDEF PhysicsBody CreatePhysicsBodyPolygon(Vector2 pos, float radius, int sides, float density);        // Creates a new polygon physics body with generic parameters
+PHYSACDEF PhysicsBody CreatePhysicsBodyFromVertices(Vector2 pos, const Vector2 *vertices, int count, float density);    // Creates a new polygon physics body from the convex hull of a vertices set (relative to position)
+PHYSACDEF PhysicsBody CreatePhysicsBodyCompound(Vector2 pos, const Vector2 *vertices, const int *piecesVertices, int piecesCount, float density);    // Creates a new compound physics body made of convex pieces (convex hull of every vertices group)
 PHYSACDEF void PhysicsAddForce(PhysicsBody body, Vector2 force);                                            // Adds a force to a physics body
 PHYSACDEF void PhysicsAddTorque(PhysicsBody body, float amount);                                            // Adds an angular force to a physics body
 PHYSACDEF void PhysicsShatter(PhysicsBody body, Vector2 position, float force);                             // Shatters a polygon shape physics body to little physics bodies with explosion force
+PHYSACDEF void SetPhysicsShatterBudget(double budget);                                                      // Sets max time in milliseconds spent spawning shatter fragments every step (0 spawns them when shattering)
+PHYSACDEF int GetPhysicsShatterPending(void);                                                               // Returns the amount of shatter fragments waiting to be spawned by next steps
+PHYSACDEF void SetPhysicsContactEvents(bool enabled);                                                       // Sets contact events reported for touching bodies pairs too (sensor overlaps are always reported)
+PHYSACDEF int GetPhysicsContactEventsCount(void);                                                           // Returns the amount of contact events reported by last RunPhysicsStep() call
+PHYSACDEF int GetPhysicsContactEvents(PhysicsContactEvent *events, int maxEvents);                          // Writes contact events reported by last RunPhysicsStep() call (in steps order) into an array, returns events count
 PHYSACDEF int GetPhysicsBodiesCount(void);                                                                  // Returns the current amount of created physics bodies
 PHYSACDEF PhysicsBody GetPhysicsBody(int index);                                                            // Returns a physics body of the bodies pool at a specific index
 PHYSACDEF int GetPhysicsShapeType(int index);                                                               // Returns the physics body shape type (PHYSICS_CIRCLE or PHYSICS_POLYGON)
 PHYSACDEF int GetPhysicsShapeVerticesCount(int index);                                                      // Returns the amount of vertices of a physics body shape
 PHYSACDEF Vector2 GetPhysicsShapeVertex(PhysicsBody body, int vertex);                                      // Returns transformed position of a body shape (body position + vertex transformed position)
+PHYSACDEF int GetPhysicsShapesLinesCount(void);                                                             // Returns the amount of vertices needed to export acquired snapshot bodies shapes as lines (two vertices per shape edge)
+PHYSACDEF int GetPhysicsShapesLines(Vector2 *lines, int maxVertices, int *bodyVertices, float alpha);        // Writes acquired snapshot bodies shapes edges as lines vertices (grouped per body) into a buffer, returns written vertices
 PHYSACDEF void SetPhysicsBodyRotation(PhysicsBody body, float radians);                                     // Sets physics body shape transform based on radians parameter
+PHYSACDEF void GetPhysicsBodyAABB(PhysicsBody body, Vector2 *min, Vector2 *max);                            // Returns world space bounding box of a physics body shape computed by last step
+PHYSACDEF float GetPhysicsBodyRadius(PhysicsBody body);                                                     // Returns bounding circle radius of a physics body shape around body position
+PHYSACDEF void UpdatePhysicsSnapshot(void);                                                                 // Acquires latest published bodies transforms snapshot (call it once per frame from render thread)
+PHYSACDEF float GetPhysicsSnapshotAlpha(void);                                                              // Returns interpolation factor between the two steps of acquired snapshot, based on elapsed time
+PHYSACDEF PhysicsTransform GetPhysicsBodyTransform(PhysicsBody body, float alpha);                          // Returns physics body transform from acquired snapshot, interpolated between its two steps (alpha 0 to 1)
+PHYSACDEF Vector2 GetPhysicsTransformVertex(PhysicsBody body, PhysicsTransform transform, int vertex);      // Returns position of a body shape vertex placed with a physics body transform
 PHYSACDEF void DestroyPhysicsBody(PhysicsBody body);                                                        // Unitializes and destroy a physics body
 PHYSACDEF void ResetPhysics(void);                                                                          // Destroys created physics bodies and manifolds and resets global values
 PHYSACDEF void ClosePhysics(void);                                                                          // Unitializes physics pointers and closes physics loop thread
+PHYSACDEF PhysicsWorld CreatePhysicsWorld(void);                                                            // Creates a new empty physics world with default values and reserved pools
+PHYSACDEF void DestroyPhysicsWorld(PhysicsWorld world);                                                     // Closes a physics world (bodies, manifolds and threads) and frees it
+PHYSACDEF void SetPhysicsWorld(PhysicsWorld world);                                                         // Binds a physics world to calling thread, next physics functions calls use it (NULL binds default world)
+PHYSACDEF PhysicsWorld GetPhysicsWorld(void);                                                               // Returns the physics world bound to calling thread
+PHYSACDEF void SetPhysicsWorldsThreads(int count);                                                          // Sets worker threads used to step physics worlds (0 steps them in calling thread)
+PHYSACDEF void StepPhysicsWorlds(PhysicsWorld *worlds, int count);                                          // Runs a physics step on every physics world, spreading them over worker threads
+PHYSACDEF int GetPhysicsStateSize(void);                                                                    // Returns the size in bytes required to save current physics state
+PHYSACDEF int SavePhysicsState(unsigned char *buffer, int maxSize);                                         // Saves current physics state (bodies, shapes and contacts) into a buffer, returns written bytes (0 if it does not fit)
+PHYSACDEF bool LoadPhysicsState(const unsigned char *data, int size);                                       // Restores a saved physics state in place (bodies keep their ids and references), returns false if data is not valid
+PHYSACDEF int EncodePhysicsStateDelta(const unsigned char *base, int baseSize, const unsigned char *state, int stateSize, unsigned char *delta, int maxSize);    // Encodes a saved physics state as a delta against a base state, returns written bytes (0 if it does not fit)
+PHYSACDEF int DecodePhysicsStateDelta(const unsigned char *base, int baseSize, const unsigned char *delta, int deltaSize, unsigned char *state, int maxSize);    // Decodes a physics state delta against its base state, returns decoded state bytes (0 if it does not fit or is not valid)
+PHYSACDEF int PhysicsRaycast(Vector2 origin, Vector2 direction, float maxDistance, PhysicsRaycastHit *hits, int maxHits);   // Casts a ray and writes hit bodies sorted by distance (closest first) into an array, returns hits count
+PHYSACDEF int PhysicsQueryAABB(Vector2 min, Vector2 max, PhysicsBody *bodies, int maxBodies);               // Writes bodies which bounding box overlaps an axis aligned box into an array, returns bodies count
+PHYSACDEF int PhysicsQueryPoint(Vector2 point, PhysicsBody *bodies, int maxBodies);                         // Writes bodies which shape contains a point into an array, returns bodies count
+PHYSACDEF PhysicsStats GetPhysicsStats(void);                                                               // Returns physics statistics of last step (times and counters require PHYSAC_STATS)
 
 #if defined(__cplusplus)
 }
@@ -232,20 +435,51 @@ PHYSACDEF void ClosePhysics(void);
     #include <stdio.h>              // Required for: printf()
 #endif
 
-#include <stdlib.h>                 // Required for: malloc(), free(), srand(), rand()
-#include <math.h>                   // Required for: cosf(), sinf(), fabs(), sqrtf()
+#include <stdlib.h>                 // Required for: malloc(), realloc(), free(), srand(), rand(), qsort()
+#include <math.h>                   // Required for: cosf(), sinf(), fabs(), sqrtf(), floorf(), ceil()
 #include <stdint.h>                 // Required for: uint64_t
+#include <string.h>                 // Required for: memcpy()
 
 #if !defined(PHYSAC_STANDALONE)
     #include "raymath.h"            // Required for: Vector2Add(), Vector2Subtract()
 #endif
 
+// Deterministic mode requires plain IEEE single precision operations, evaluated in source order
+#if defined(PHYSAC_DETERMINISTIC)
+    #include <float.h>              // Required for: FLT_EVAL_METHOD
+
+    #if !defined(FLT_EVAL_METHOD) || ((FLT_EVAL_METHOD != 0) && (FLT_EVAL_METHOD != 16))     // 16: only half floats promoted to float
+        #error "PHYSAC_DETERMINISTIC requires single precision float evaluation (FLT_EVAL_METHOD 0)"
+    #endif
+
+    #if defined(_MSC_VER)
+        #pragma fp_contract(off)
+    #elif defined(__GNUC__) && !defined(__clang__)
+        #pragma GCC push_options
+        #pragma GCC optimize("fp-contract=off")     // GCC ignores standard pragma, restored at implementation end
+    #else
+        #pragma STDC FP_CONTRACT OFF
+    #endif
+#endif
+
+// SIMD instruction sets used by polygons narrow phase
+#if !defined(PHYSAC_NO_SIMD) && !defined(PHYSAC_DETERMINISTIC)
+    #if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+        #include <xmmintrin.h>      // Required for: __m128, _mm_loadu_ps(), _mm_min_ps()
+        #define PHYSAC_SIMD_SSE
+    #elif defined(__wasm_simd128__)
+        #include <wasm_simd128.h>   // Required for: v128_t, wasm_v128_load(), wasm_f32x4_min()
+        #define PHYSAC_SIMD_WASM
+    #endif
+#endif
+
 // Time management functionality
-#include <time.h>                   // Required for: time(), clock_gettime()
+#include <time.h>                   // Required for: time(), clock_gettime(), nanosleep()
 #if defined(_WIN32)
     // Functions required to query time on Windows
     int __stdcall QueryPerformanceCounter(unsigned long long int *lpPerformanceCount);
     int __stdcall QueryPerformanceFrequency(unsigned long long int *lpFrequency);
+    void __stdcall Sleep(unsigned long msTimeout);
 #elif defined(__linux__)
     #if _POSIX_C_SOURCE < 199309L
         #undef _POSIX_C_SOURCE
@@ -265,40 +499,383 @@ PHYSACDEF void ClosePhysics(void);
 #define PHYSAC_EPSILON      0.000001f
 #define PHYSAC_K            1.0f/3.0f
 #define PHYSAC_VECTOR_ZERO  (Vector2){ 0.0f, 0.0f }
+#define PHYSAC_MAX_BLOCKS   32          // Max bodies pool blocks, every block doubles pool capacity
+#define PHYSAC_DEFAULT_TIME_STEP    (1.0/60.0/10.0*1000)    // Default physics worlds time step, in milliseconds
+#define PHYSAC_DEFAULT_GRAVITY      9.81f                   // Default physics worlds vertical gravity force
+#define PHYSAC_DEFAULT_CATEGORY_BITS 0x00000001             // Default physics bodies collision filter category
+#define PHYSAC_DEFAULT_MASK_BITS    0xFFFFFFFF              // Default physics bodies collision filter mask (collides with every category)
+
+// Atomic operations used to swap bodies transforms snapshots between physics and render threads
+#if defined(_MSC_VER)
+    #include <intrin.h>             // Required for: _InterlockedExchange(), _InterlockedOr()
+    #define PHYSAC_ATOMIC_EXCHANGE(ptr, value)  _InterlockedExchange((volatile long *)(ptr), (value))
+    #define PHYSAC_ATOMIC_LOAD(ptr)             _InterlockedOr((volatile long *)(ptr), 0)
+#else
+    #define PHYSAC_ATOMIC_EXCHANGE(ptr, value)  __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+    #define PHYSAC_ATOMIC_LOAD(ptr)             __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#endif
+#define PHYSAC_SNAPSHOT_FRESH   4       // Snapshot exchange slot flag, set when physics thread publishes a new snapshot
+
+// Thread local storage, used to bind a physics world to every thread
+#if defined(_MSC_VER)
+    #define PHYSAC_THREAD_LOCAL     __declspec(thread)
+#else
+    #define PHYSAC_THREAD_LOCAL     __thread
+#endif
+#define PHYSAC_SIMD_WIDTH       4       // Floats processed at once by polygons narrow phase, vertex blocks are padded to it
+
+// Physics world mutex, held while stepping and by functions that change or read bodies pools from other threads
+#if !defined(PHYSAC_NO_THREADS)
+    #define PHYSAC_LOCK_WORLD(world)    pthread_mutex_lock(&(world)->worldMutex)
+    #define PHYSAC_UNLOCK_WORLD(world)  pthread_mutex_unlock(&(world)->worldMutex)
+#else
+    #define PHYSAC_LOCK_WORLD(world)    ((void)(world))
+    #define PHYSAC_UNLOCK_WORLD(world)  ((void)(world))
+#endif
+
+// Physics step phases profiling hooks, user can define them before including physac to time every PhysicsPhase
+#if !defined(PHYSAC_PROFILE_BEGIN)
+    #define PHYSAC_PROFILE_BEGIN(phase)
+#endif
+#if !defined(PHYSAC_PROFILE_END)
+    #define PHYSAC_PROFILE_END(phase)
+#endif
+
+// Physics step phases and statistics counters, statistics compile to nothing without PHYSAC_STATS
+#if defined(PHYSAC_STATS)
+    #define PHYSAC_PHASE_BEGIN(phase)       do { PHYSAC_PROFILE_BEGIN(phase); BeginPhysicsStatsPhase(phase); } while (0)
+    #define PHYSAC_PHASE_END(phase)         do { EndPhysicsStatsPhase(phase); PHYSAC_PROFILE_END(phase); } while (0)
+    #define PHYSAC_STATS_ADD(field, value)  (physicsWorld->stats.field += (value))
+#else
+    #define PHYSAC_PHASE_BEGIN(phase)       PHYSAC_PROFILE_BEGIN(phase)
+    #define PHYSAC_PHASE_END(phase)         PHYSAC_PROFILE_END(phase)
+    #define PHYSAC_STATS_ADD(field, value)  ((void)(value))
+#endif
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Broad-phase proxy, caches a physics body world space bounding box for sort and sweep
+typedef struct PhysicsProxy {
+    PhysicsBody body;                       // Physics body reference
+    Vector2 min;                            // Bounding box minimum position in world space
+    Vector2 max;                            // Bounding box maximum position in world space
+} PhysicsProxy;
+
+// Compound shape pieces polygons, stored in a side table indexed by body id (kept while body shape is a compound shape)
+typedef struct PhysicsPiecesData {
+    PolygonData *polygons;                  // Pieces polygons array (NULL for single polygon shapes, stored in polygons side table)
+    unsigned int capacity;                  // Pieces polygons array capacity
+} PhysicsPiecesData;
+
+// Shatter fragment waiting to be spawned, a triangle shape with precomputed mass data
+typedef struct PhysicsFragmentData {
+    Vector2 position;                       // Fragment centroid position in world space
+    Vector2 positions[3];                   // Fragment triangle vertices positions, relative to centroid
+    Vector2 normals[3];                     // Fragment triangle faces normals
+    Matrix2x2 transform;                    // Fragment vertices transform matrix 2x2 (shattered body transform)
+    Vector2 force;                          // Explosion force applied to fragment when spawned
+    float mass;                             // Fragment mass (unit density)
+    float inertia;                          // Fragment moment of inertia around its centroid
+    bool isSensor;                          // Shattered body sensor state
+    unsigned int categoryBits;              // Shattered body collision filter categories
+    unsigned int maskBits;                  // Shattered body collision filter mask
+} PhysicsFragmentData;
+
+// Touching bodies pairs of a physics step, sorted keys with lower body id in high bits (used to report contact events)
+typedef struct PhysicsPairsData {
+    uint64_t *keys;                         // Touching bodies pairs keys
+    unsigned int count;                     // Touching bodies pairs counter
+    unsigned int capacity;                  // Touching bodies pairs keys array capacity
+} PhysicsPairsData;
+
+// Physics body bounds, stored in a side table indexed by body id (bounding box is computed again only when body moves)
+typedef struct PhysicsBoundsData {
+    Vector2 min;                            // Bounding box minimum position in world space
+    Vector2 max;                            // Bounding box maximum position in world space
+    float radius;                           // Bounding circle radius around body position (max distance to shape vertices)
+    Vector2 position;                       // Body position when bounding box was computed
+    Vector2 rotation;                       // Body shape transform rotation (cosine and sine) when bounding box was computed
+} PhysicsBoundsData;
+
+// Physics body sleeping data, stored in a side table indexed by body id
+typedef struct PhysicsSleepData {
+    float restTime;                         // Time in milliseconds the body has been under sleep velocity thresholds
+    Vector2 position;                       // Body position when it was put to sleep (used to detect user moves)
+    float orient;                           // Body rotation when it was put to sleep (used to detect user moves)
+} PhysicsSleepData;
+
+// Bodies transforms snapshot, written by physics thread and read by render thread (triple buffered)
+typedef struct PhysicsSnapshot {
+    PhysicsBody *bodies;                    // Snapshot physics bodies references
+    unsigned int *generations;              // Snapshot physics bodies slots generations
+    PhysicsTransform *previous;             // Physics bodies transforms before last step
+    PhysicsTransform *current;              // Physics bodies transforms after last step
+    unsigned int *index;                    // Snapshot index for every body id
+    unsigned int count;                     // Snapshot physics bodies counter
+    unsigned int capacity;                  // Snapshot arrays capacity
+    double time;                            // Time in milliseconds when current transforms started to be rendered
+} PhysicsSnapshot;
+
+// Clipping vertex, keeps the feature that generated a contact point while clipping incident face
+typedef struct PhysicsClipVertex {
+    Vector2 position;                       // Vertex position in world space
+    unsigned int feature;                   // Incident face vertex index or clipping side plane feature
+} PhysicsClipVertex;
+
+// Query tree node, bounding volume of a body or of two children nodes (node 0 is used as null node)
+typedef struct PhysicsTreeNode {
+    Vector2 min;                            // Bounding box minimum position in world space (leaves are enlarged by tree margin)
+    Vector2 max;                            // Bounding box maximum position in world space
+    PhysicsBody body;                       // Leaf physics body reference (NULL for internal nodes)
+    unsigned int parent;                    // Parent node (0 for root node), next free node for released nodes
+    unsigned int children[2];               // Children nodes (0 for leaves)
+    int height;                             // Node height in tree (0 for leaves)
+} PhysicsTreeNode;
+
+// Query tree traversal stack, nodes pending to be visited (local nodes array, moved to heap memory when full)
+typedef struct PhysicsTreeStack {
+    unsigned int *nodes;                    // Pending nodes array (local nodes or heap memory)
+    int count;                              // Pending nodes count
+    int capacity;                           // Pending nodes array capacity
+    unsigned int local[PHYSAC_TREE_STACK];  // Local pending nodes array
+} PhysicsTreeStack;
+
+// Physics state header, first record of a saved physics state
+// NOTE: State records have no padding bytes, so saved states are fully defined and deltas stay small
+typedef struct PhysicsStateHeader {
+    char magic[4];                          // Physics state identifier ("PHST")
+    unsigned int version;                   // Physics state format version (PHYSAC_STATE_VERSION)
+    double deltaTime;                       // Delta time used for physics steps, in milliseconds
+    unsigned int size;                      // Physics state size in bytes
+    unsigned int bodyStateSize;             // Physics body state record size in bytes (checked to reject states of other builds)
+    unsigned int stepsCount;                // Total physics steps processed
+    Vector2 gravityForce;                   // Physics world gravity force
+    float solverTolerance;                  // Contact solver tolerance
+    unsigned int bodiesCapacity;            // Physics bodies pool capacity (ids range)
+    unsigned int bodiesCount;               // Physics bodies records (in bodies pointers array order)
+    unsigned int freeIdsCount;              // Physics bodies available ids records (in stack order)
+    unsigned int manifoldsCount;            // Physics manifolds records (last step contacts, used to warm start next step)
+    unsigned int proxiesCount;              // Broad-phase proxies records (bodies ids in sweep order)
+    unsigned int proxiesDirty;              // Broad-phase proxies require rebuild
+} PhysicsStateHeader;
+
+// Physics body state record, polygon vertices positions and normals are stored after all bodies records
+typedef struct PhysicsBodyState {
+    unsigned int id;                        // Physics body id
+    unsigned int flags;                     // Physics body states bits (enabled, useGravity, isGrounded, isSleeping, freezeOrient, isBullet, isSensor)
+    unsigned int shapeType;                 // Physics shape type
+    unsigned int piecesCount;               // Polygon shape pieces records, every piece stores its vertices count, positions and normals
+    unsigned int categoryBits;              // Collision filter categories
+    unsigned int maskBits;                  // Collision filter mask
+    Vector2 position;                       // Physics body shape pivot
+    Vector2 velocity;                       // Current linear velocity
+    Vector2 force;                          // Current linear force
+    float angularVelocity;                  // Current angular velocity
+    float torque;                           // Current angular force
+    float orient;                           // Rotation in radians
+    float inertia;                          // Moment of inertia
+    float inverseInertia;                   // Inverse value of inertia
+    float mass;                             // Physics body mass
+    float inverseMass;                      // Inverse value of mass
+    float staticFriction;                   // Friction when the body has not movement
+    float dynamicFriction;                  // Friction when the body has movement
+    float restitution;                      // Restitution coefficient
+    float radius;                           // Circle shape radius
+    Matrix2x2 transform;                    // Vertices transform matrix 2x2
+    PhysicsSleepData sleep;                 // Physics body sleeping data
+} PhysicsBodyState;
+
+// Physics manifold state record, only the contacts information carried over to next step
+typedef struct PhysicsManifoldState {
+    unsigned int bodyA;                     // Manifold first physics body id
+    unsigned int bodyB;                     // Manifold second physics body id
+    unsigned int pieceA;                    // Manifold first physics body shape piece
+    unsigned int pieceB;                    // Manifold second physics body shape piece
+    unsigned int contactsCount;             // Collision number of contacts
+    unsigned int contactsIds[2];            // Points of contact features identifiers
+    float penetration;                      // Depth of penetration from collision
+    Vector2 normal;                         // Normal direction vector from 'a' to 'b'
+    Vector2 contacts[2];                    // Points of contact during collision
+    float normalImpulses[2];                // Accumulated normal impulses of every contact
+    float tangentImpulses[2];               // Accumulated tangent impulses of every contact
+} PhysicsManifoldState;
+
+// Physics state stream, reads or writes physics state records in a bytes buffer
+typedef struct PhysicsStateStream {
+    unsigned char *output;                  // Written bytes buffer (NULL to only measure written size)
+    const unsigned char *input;             // Read bytes buffer
+    int size;                               // Bytes buffer size
+    int offset;                             // Current read or write position in bytes buffer
+} PhysicsStateStream;
+
+// Physics world, all the state of an independent simulation (bodies and manifolds pools, time step and threads)
+// NOTE: Fields with a default value other than zero go first, so default world can be initialized statically
+typedef struct PhysicsWorldData {
+    double deltaTime;                       // Delta time used for physics steps, in milliseconds
+    Vector2 gravityForce;                   // Physics world gravity force
+    float solverTolerance;                  // Contact solver tolerance, max contact velocity change to keep iterating
+    int solverIterations;                   // Contact solver max iterations per step (lowered by adaptive iterations)
+    float timeDilation;                     // Simulated time ratio of last RunPhysicsStep() call elapsed time
+    int snapshotBack;                       // Snapshot buffer written by physics thread
+    int snapshotMiddle;                     // Snapshot buffer waiting to be acquired, with fresh flag (atomic exchange slot)
+    int snapshotFront;                      // Snapshot buffer read by render thread
+    bool proxiesDirty;                      // Broad-phase proxies require rebuild (bodies created or destroyed)
+#if !defined(PHYSAC_NO_THREADS)
+    pthread_mutex_t worldMutex;             // Physics world mutex, pools do not grow or change while it is held
+    pthread_mutex_t solverMutex;            // Contact islands solver jobs mutex
+    pthread_cond_t solverStartCond;         // Signaled when a new solver job is available
+    pthread_cond_t solverDoneCond;          // Signaled when all contact islands are solved
+    pthread_t physicsThreadId;              // Physics thread id
+    pthread_t solverThreads[PHYSAC_MAX_SOLVER_THREADS];     // Contact islands solver worker threads
+    int solverThreadsCount;                 // Contact islands solver worker threads counter
+    unsigned int solverJob;                 // Current solver job, incremented every step with islands to solve
+    unsigned int solverIslandsCount;        // Contact islands to be solved in current job (workers never read islands count directly)
+    unsigned int solverNextIsland;          // Next contact island to be solved in current job
+    unsigned int solverDoneIslands;         // Contact islands solved in current job
+    bool solverExit;                        // Solver worker threads exit request
+#endif
+    unsigned int usedMemory;                // Total allocated dynamic memory
+    bool physicsThreadEnabled;              // Physics thread enabled state
+    double startTime;                       // Start time in milliseconds
+    double currentTime;                     // Current time in milliseconds
+    double accumulator;                     // Physics time step delta time accumulator
+    double averageDelta;                    // Average time between RunPhysicsStep() calls, in milliseconds (0 before first call)
+    int maxSteps;                           // Max physics steps run by a RunPhysicsStep() call (0 for no limit)
+    bool adaptiveIterations;                // Contact solver iterations are lowered while RunPhysicsStep() catches up
+    double droppedTime;                     // Total simulation time dropped by max steps, in milliseconds
+    unsigned int stepsCount;                // Total physics steps processed
+    PhysicsBodyData *bodiesBlocks[PHYSAC_MAX_BLOCKS];   // Physics bodies pool blocks, body id indexes blocks in order (bodies never move, so references stay valid)
+    PolygonData *polygonsBlocks[PHYSAC_MAX_BLOCKS];     // Physics bodies polygon shapes side table blocks, same layout as bodies pool blocks
+    unsigned int bodiesBlocksCount;         // Physics bodies pool current blocks counter
+    unsigned int bodiesCapacity;            // Physics bodies pool capacity (sum of blocks sizes)
+    PhysicsBody *bodies;                    // Physics bodies pointers array (active bodies)
+    unsigned int physicsBodiesCount;        // Physics world current bodies counter
+    unsigned int *bodiesIndex;              // Physics bodies pointers array index for every body id
+    unsigned int *freeIds;                  // Physics bodies available ids stack
+    unsigned int freeIdsCount;              // Physics bodies available ids counter
+    PhysicsSleepData *sleepData;            // Physics bodies sleeping data side table indexed by body id
+    PhysicsBoundsData *bounds;              // Physics bodies bounds side table indexed by body id
+    PhysicsPiecesData *pieces;              // Physics bodies compound shapes pieces side table indexed by body id
+    PhysicsManifoldData *contacts;          // Physics manifolds pool, reset every step
+    PhysicsManifoldData *previousContacts;  // Physics manifolds pool of previous step, swapped with manifolds pool every step
+    unsigned int manifoldsCapacity;         // Physics manifolds pool capacity
+    unsigned int physicsManifoldsCount;     // Physics world current manifolds counter
+    unsigned int previousManifoldsCount;    // Physics manifolds of previous step counter
+    unsigned int *manifoldsTable;           // Previous step manifolds hash table by bodies pair (manifold index + 1, 0 for empty slots)
+    unsigned int manifoldsTableSize;        // Previous step manifolds hash table size (power of two)
+    PhysicsSnapshot snapshots[3];           // Bodies transforms snapshots buffers (physics thread, exchange slot and render thread)
+    bool snapshotStarted;                   // Snapshot previous transforms stored in back buffer, current update can be published
+    PhysicsProxy *proxies;                  // Broad-phase proxies array, sorted by bounding box minimum x
+    unsigned int proxiesCount;              // Broad-phase current proxies counter
+    unsigned int *islandParents;            // Contact islands union-find parent for every body index
+    unsigned int *islandKeys;               // Contact island root body index for every manifold
+    unsigned int *islandManifolds;          // Manifolds indexes sorted by contact island
+    unsigned int *islandStarts;             // Contact islands first index in island manifolds array (used as counters while sorting)
+    unsigned int islandsCount;              // Current step contact islands counter
+    unsigned int islandsCapacity;           // Contact islands arrays capacity (max of bodies and manifolds count)
+    PhysicsTreeNode *treeNodes;             // Query tree nodes pool (node 0 is never used)
+    unsigned int treeNodesCapacity;         // Query tree nodes pool capacity
+    unsigned int treeNodesCount;            // Query tree nodes pool used slots (released nodes included)
+    unsigned int treeFreeNode;              // Query tree first released node (0 if none)
+    unsigned int treeRoot;                  // Query tree root node (0 for empty tree)
+    unsigned int *treeLeaves;               // Query tree leaf node of every body id (0 if body is not in tree)
+    bool treeDirty;                         // Query tree requires update (bodies moved, created or destroyed)
+#if defined(PHYSAC_STATS)
+    PhysicsStats stats;                     // Physics statistics of last step
+    double phasesStart[PHYSICS_PHASE_COUNT];    // Current step phases start time
+#endif
+    PhysicsFragmentData *fragments;         // Shatter fragments queue, spawned in order
+    unsigned int fragmentsCapacity;         // Shatter fragments queue capacity
+    unsigned int fragmentsCount;            // Shatter fragments queue used slots (spawned fragments included)
+    unsigned int fragmentsNext;             // Next shatter fragment to be spawned
+    double shatterBudget;                   // Max time in milliseconds spent spawning shatter fragments every step (0 for no limit)
+    bool contactEvents;                     // Contact events reported for touching pairs of solid bodies too (not only sensor overlaps)
+    PhysicsPairsData touchingPairs;         // Touching bodies pairs of last step
+    PhysicsPairsData previousTouchingPairs; // Touching bodies pairs of previous step, swapped with touching pairs every step
+    PhysicsContactEvent *events;            // Contact events reported by last RunPhysicsStep() call
+    unsigned int eventsCount;               // Contact events counter
+    unsigned int eventsCapacity;            // Contact events array capacity
+} PhysicsWorldData;
 
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
+static PhysicsWorldData defaultWorld = {                    // Default physics world, bound to every thread until SetPhysicsWorld() binds another one
+    PHYSAC_DEFAULT_TIME_STEP, { 0.0f, PHYSAC_DEFAULT_GRAVITY }, PHYSAC_SOLVER_TOLERANCE, PHYSAC_COLLISION_ITERATIONS, 1.0f, 0, 1, 2, true,
 #if !defined(PHYSAC_NO_THREADS)
-static pthread_t physicsThreadId;                           // Physics thread id
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER
 #endif
-static unsigned int usedMemory = 0;                         // Total allocated dynamic memory
-static bool physicsThreadEnabled = false;                   // Physics thread enabled state
-static double baseTime = 0.0;                               // Offset time for MONOTONIC clock
-static double startTime = 0.0;                              // Start time in milliseconds
-static double deltaTime = 1.0/60.0/10.0 * 1000;             // Delta time used for physics steps, in milliseconds
-static double currentTime = 0.0;                            // Current time in milliseconds
+};
+static PHYSAC_THREAD_LOCAL PhysicsWorldData *physicsWorld = &defaultWorld;  // Physics world bound to calling thread
+
+static double baseTime = 0.0;                               // Offset time for MONOTONIC clock (shared by all physics worlds)
 static uint64_t frequency = 0;                              // Hi-res clock frequency
+static Vector2 circleVertices[PHYSAC_CIRCLE_VERTICES] = { 0 };  // Circle shape vertices of unit radius, computed once by InitPhysics()
 
-static double accumulator = 0.0;                            // Physics time step delta time accumulator
-static unsigned int stepsCount = 0;                         // Total physics steps processed
-static Vector2 gravityForce = { 0.0f, 9.81f };              // Physics world gravity force
-static PhysicsBody bodies[PHYSAC_MAX_BODIES];               // Physics bodies pointers array
-static unsigned int physicsBodiesCount = 0;                 // Physics world current bodies counter
-static PhysicsManifold contacts[PHYSAC_MAX_MANIFOLDS];      // Physics bodies pointers array
-static unsigned int physicsManifoldsCount = 0;              // Physics world current manifolds counter
+#if !defined(PHYSAC_NO_THREADS)
+static pthread_t worldsThreads[PHYSAC_MAX_WORLDS_THREADS];  // Physics worlds stepping worker threads
+static int worldsThreadsCount = 0;                          // Physics worlds stepping worker threads counter
+static pthread_mutex_t worldsMutex = PTHREAD_MUTEX_INITIALIZER; // Physics worlds stepping jobs mutex
+static pthread_cond_t worldsStartCond = PTHREAD_COND_INITIALIZER;   // Signaled when a new physics worlds stepping job is available
+static pthread_cond_t worldsDoneCond = PTHREAD_COND_INITIALIZER;    // Signaled when all physics worlds are stepped
+static PhysicsWorld *worldsJob = NULL;                      // Physics worlds to be stepped in current job
+static unsigned int worldsJobId = 0;                        // Current physics worlds stepping job, incremented every call
+static int worldsJobCount = 0;                              // Physics worlds to be stepped in current job
+static int worldsNextIndex = 0;                             // Next physics world to be stepped in current job
+static int worldsDoneCount = 0;                             // Physics worlds stepped in current job
+static bool worldsExit = false;                             // Physics worlds stepping worker threads exit request
+#endif
 
 //----------------------------------------------------------------------------------
 // Module Internal Functions Declaration
 //----------------------------------------------------------------------------------
 static int FindAvailableBodyIndex();                                                                        // Finds a valid index for a new physics body initialization
+static bool GrowPhysicsBodies(void);                                                                        // Adds a new block to bodies pool, doubling bodies capacity
+static bool GrowPhysicsManifolds(void);                                                                     // Reallocates manifolds pool, doubling manifolds capacity
+static void ReleasePhysicsPools(void);                                                                      // Frees bodies and manifolds pools dynamic memory
+static PhysicsBody GetPhysicsBodySlot(unsigned int id);                                                     // Returns physics body slot of a body id in bodies pool blocks
+static PolygonData *GetPolygonSlot(unsigned int id);                                                        // Returns polygon shape slot of a body id in polygons side table blocks
+static PolygonData *ReservePhysicsBodyPieces(unsigned int id, unsigned int count);                          // Reserves compound shape pieces polygons of a body id, returns pieces polygons (NULL if they can not be allocated)
+static void ReleasePhysicsBodyPieces(unsigned int id);                                                      // Frees compound shape pieces polygons of a body id
+static void RemovePhysicsBody(PhysicsBody body);                                                            // Removes a physics body from bodies pool, releasing its id (world mutex must be held)
 static PolygonData CreateRandomPolygon(float radius, int sides);                                            // Creates a random polygon shape with max vertex distance from polygon pivot
 static PolygonData CreateRectanglePolygon(Vector2 pos, Vector2 size);                                       // Creates a rectangle polygon shape based on a min and max positions
+static bool CreateHullPolygon(const Vector2 *vertices, int count, PolygonData *data);                        // Creates a convex polygon shape from the convex hull of a vertices set, returns false if hull has no area
+static int CompareHullVertices(const void *a, const void *b);                                               // Compares two vertices by x and then by y (used by qsort)
+static Vector2 ComputePhysicsBodyMass(PhysicsBody body, float density);                                     // Computes mass and inertia of a physics body polygon shape, returns centroid moved to shape pivot
+static float ComputePhysicsBodyRadius(PhysicsBody body);                                                    // Returns the max distance from body position to its shape vertices
+static void InitPhysicsBodyBounds(PhysicsBody body);                                                        // Computes bounding circle radius and bounding box of a new physics body shape
+static PhysicsBoundsData *UpdatePhysicsBodyBounds(PhysicsBody body);                                        // Computes bounding box of a physics body again if it moved since last update, returns body bounds
+static bool ReservePhysicsFragments(unsigned int count);                                                    // Reserves shatter fragments queue for a fragments count, returns false if it can not grow
+static PhysicsBody CreatePhysicsBodyFragment(const PhysicsFragmentData *fragment);                          // Creates a new triangle physics body from a shatter fragment
+static void SpawnPhysicsFragments(void);                                                                    // Spawns queued shatter fragments until shatter time budget is spent
+static Vector2 GetPolygonVertex(PhysicsShape shape, int vertex);                                            // Returns model space position of a polygon shape vertex (compound shapes vertices are numbered piece after piece)
 static void *PhysicsLoop(void *arg);                                                                        // Physics loop thread function
+#if !defined(PHYSAC_NO_THREADS)
+static void WaitTime(double ms);                                                                            // Sleeps current thread for a time in milliseconds
+#endif
+static bool ReservePhysicsSnapshot(PhysicsSnapshot *snapshot);                                              // Reserves snapshot arrays for current bodies capacity
+static void BeginPhysicsSnapshot(void);                                                                     // Stores bodies transforms before last step of current update in snapshot back buffer
+static void PublishPhysicsSnapshot(void);                                                                   // Stores bodies transforms after last step in snapshot back buffer and publishes it
+static PhysicsTransform InterpolatePhysicsTransform(PhysicsTransform previous, PhysicsTransform current, float alpha);  // Returns a physics body transform between two transforms (alpha 0 to 1)
 static void PhysicsStep(void);                                                                              // Physics steps calculations (dynamics, collisions and position corrections)
-static int FindAvailableManifoldIndex();                                                                    // Finds a valid index for a new manifold initialization
-static PhysicsManifold CreatePhysicsManifold(PhysicsBody a, PhysicsBody b);                                 // Creates a new physics manifold to solve collision
-static void DestroyPhysicsManifold(PhysicsManifold manifold);                                               // Unitializes and destroys a physics manifold
+static void UpdatePhysicsBroadPhase(void);                                                                  // Updates broad-phase proxies bounds and order and creates overlapping pairs manifolds
+static void UpdatePhysicsNarrowPhase(void);                                                                 // Solves broad-phase pairs manifolds and keeps only the ones in contact
+static void ComputePhysicsBodyAABB(PhysicsBody body, Vector2 *min, Vector2 *max);                           // Computes world space bounding box of a physics body shape
+static void ComputePhysicsPieceAABB(PhysicsBody body, unsigned int piece, Vector2 *min, Vector2 *max);      // Computes world space bounding box of a physics body shape piece
+static int CompareProxies(const void *a, const void *b);                                                    // Compares two broad-phase proxies by bounding box minimum x (used by qsort)
+static PhysicsManifold CreatePhysicsManifold(PhysicsBody a, PhysicsBody b, unsigned int pieceA, unsigned int pieceB);  // Creates a new physics manifold from manifolds pool to solve collision
+static void CreatePhysicsPiecesManifolds(PhysicsBody a, PhysicsBody b);                                     // Creates a physics manifold for every pieces pair of two bodies which bounding boxes overlap
+static bool CanPhysicsBodiesCollide(PhysicsBody a, PhysicsBody b);                                          // Returns true if two bodies collision filters accept each other (sensors never detect other sensors)
+static void AddPhysicsTouchingPair(PhysicsBody a, PhysicsBody b);                                           // Adds a touching bodies pair to current step touching pairs (first body has lower id)
+static int CompareTouchingPairs(const void *a, const void *b);                                              // Compares two touching bodies pairs keys (used by qsort)
+static void UpdatePhysicsContactEvents(void);                                                               // Reports touching pairs starting or stopping touching since previous step as contact events
+static void AddPhysicsContactEvent(PhysicsContactEventType type, uint64_t key);                             // Adds a contact event of a touching bodies pair key to contact events array
+static void SwapPhysicsManifolds(void);                                                                     // Swaps manifolds pools and indexes previous step manifolds by bodies pair
+static void ClearPhysicsManifoldsTable(void);                                                               // Clears previous step manifolds from hash table and discards them
+static unsigned int HashPhysicsManifold(PhysicsManifold manifold);                                          // Returns manifolds hash table slot of a manifold bodies and pieces pair
+static void MatchPhysicsManifold(PhysicsManifold manifold);                                                 // Copies accumulated impulses of matching previous step contacts to a new manifold
 static void SolvePhysicsManifold(PhysicsManifold manifold);                                                 // Solves a created physics manifold between two physics bodies
 static void SolveCircleToCircle(PhysicsManifold manifold);                                                  // Solves collision between two circle shape physics bodies
 static void SolveCircleToPolygon(PhysicsManifold manifold);                                                 // Solves collision between a circle to a polygon shape physics bodies
@@ -306,18 +883,68 @@ static void SolvePolygonToCircle(PhysicsManifold manifold);
 static void SolvePolygonToPolygon(PhysicsManifold manifold);                                                // Solves collision between two polygons shape physics bodies
 static void IntegratePhysicsForces(PhysicsBody body);                                                       // Integrates physics forces into velocity
 static void InitializePhysicsManifolds(PhysicsManifold manifold);                                           // Initializes physics manifolds to solve collisions
-static void IntegratePhysicsImpulses(PhysicsManifold manifold);                                             // Integrates physics collisions impulses to solve collisions
+static float IntegratePhysicsImpulses(PhysicsManifold manifold);                                            // Integrates physics collisions impulses to solve collisions, returns max contact velocity change
+static void ApplyPhysicsImpulse(PhysicsBody body, Vector2 impulse, Vector2 radius);                        // Applies an impulse to a dynamic physics body at a contact radius
 static void IntegratePhysicsVelocity(PhysicsBody body);                                                     // Integrates physics velocity into position and forces
+static void IntegratePhysicsBullet(PhysicsBody body);                                                       // Integrates bullet physics body velocity, stopping it at first time of impact with other bodies
+static float FindPhysicsTimeOfImpact(PhysicsBody bullet, PhysicsBody body, PhysicsTransform start, PhysicsTransform end, float maxTime);   // Finds bullet body time of impact with a body in a step motion (maxTime if none before)
+static void SetPhysicsBodyPose(PhysicsBody body, PhysicsTransform start, PhysicsTransform end, float time);  // Places a physics body between two transforms
+static float GetPhysicsBodiesSeparation(PhysicsBody bodyA, PhysicsBody bodyB);                             // Returns a lower bound of the distance between two bodies shapes (negative when overlapping)
 static void CorrectPhysicsPositions(PhysicsManifold manifold);                                              // Corrects physics bodies positions based on manifolds collision information
+static bool IsPhysicsBodyAwake(PhysicsBody body);                                                           // Returns true if a physics body is dynamic (enabled with finite mass) and not sleeping
+static void WakeUpPhysicsBody(PhysicsBody body);                                                            // Wakes up a sleeping physics body and resets its resting time
+static void WakeUpPhysicsBodiesAround(PhysicsBody body);                                                    // Wakes up sleeping bodies which bounding box overlaps a physics body bounding box
+static void UpdatePhysicsSleeping(void);                                                                    // Updates bodies resting time and puts to sleep contact islands resting for long enough
+static bool ReservePhysicsIslands(void);                                                                    // Reserves contact islands arrays for current bodies and manifolds count
+static bool BuildPhysicsIslands(void);                                                                      // Groups manifolds in contact islands (connected dynamic bodies)
+static unsigned int FindIslandRoot(unsigned int index);                                                     // Finds contact island root body index of a body index
+static int SolvePhysicsIsland(unsigned int island);                                                         // Integrates collisions impulses of a contact island manifolds until they converge, returns iterations run
+static void SolvePhysicsIslands(void);                                                                      // Solves all contact islands, spreading them over solver worker threads
+#if !defined(PHYSAC_NO_THREADS)
+static void *PhysicsSolverLoop(void *arg);                                                                  // Contact islands solver worker thread function
+#endif
+static void StepPhysicsWorld(PhysicsWorld world);                                                           // Binds a physics world to calling thread and runs a physics step on it
+#if !defined(PHYSAC_NO_THREADS)
+static void *PhysicsWorldsLoop(void *arg);                                                                  // Physics worlds stepping worker thread function
+#endif
+static int WritePhysicsState(unsigned char *buffer, int maxSize);                                           // Writes current physics state records into a buffer, returns state size (written only if it fits)
+static bool ReadPhysicsState(const unsigned char *data, int size);                                          // Restores physics state records from a buffer, returns false if data is not valid (world mutex must be held)
+static void WriteStateData(PhysicsStateStream *stream, const void *data, int size);                         // Writes bytes to a physics state stream (only measured if they do not fit)
+static bool ReadStateData(PhysicsStateStream *stream, void *data, int size);                                // Reads bytes from a physics state stream, returns false if there are not enough bytes
+static void WriteStateVarint(PhysicsStateStream *stream, unsigned int value);                               // Writes a variable length unsigned integer (7 bits per byte) to a physics state stream
+static bool ReadStateVarint(PhysicsStateStream *stream, unsigned int *value);                               // Reads a variable length unsigned integer from a physics state stream
+static void UpdatePhysicsTree(void);                                                                        // Updates query tree leaves of bodies moved out of them and inserts new bodies
+static void UpdatePhysicsTreeBody(PhysicsBody body);                                                        // Updates query tree leaf of a physics body moved out of it (inserts new bodies)
+static void ResetPhysicsTree(void);                                                                         // Removes all bodies from query tree
+static unsigned int AllocatePhysicsTreeNode(void);                                                          // Returns a new query tree node from nodes pool (0 if pool can not grow)
+static void ReleasePhysicsTreeNode(unsigned int node);                                                      // Returns a query tree node to nodes pool
+static bool InsertPhysicsTreeLeaf(unsigned int leaf);                                                       // Inserts a leaf in query tree next to the node which bounding box grows less, returns false if it fails
+static void RemovePhysicsTreeLeaf(unsigned int leaf);                                                       // Removes a leaf from query tree (leaf node is not released)
+static unsigned int BalancePhysicsTreeNode(unsigned int node);                                              // Rotates a query tree node if its children heights differ more than one, returns node in its place
+static void UpdatePhysicsTreeNode(unsigned int node);                                                       // Updates a query tree internal node bounding box and height from its children
+static void InitPhysicsTreeStack(PhysicsTreeStack *stack);                                                  // Initializes a query tree traversal stack with its local nodes array
+static bool PushPhysicsTreeStack(PhysicsTreeStack *stack, unsigned int node);                               // Pushes a node to a query tree traversal stack, returns false if it can not grow
+static void UnloadPhysicsTreeStack(PhysicsTreeStack *stack);                                                // Releases query tree traversal stack heap memory (if it grew)
+static bool IsPhysicsBodyPoint(PhysicsBody body, Vector2 point);                                            // Returns true if a point is inside a physics body shape
+static bool RaycastPhysicsBody(PhysicsBody body, Vector2 origin, Vector2 direction, float maxDistance, float *distance, Vector2 *normal);  // Returns true if a ray hits a physics body shape from outside before max distance
+static bool RaycastBounds(Vector2 origin, Vector2 direction, float maxDistance, Vector2 min, Vector2 max);  // Returns true if a ray hits a bounding box before max distance
+static float BoundsPerimeter(Vector2 min, Vector2 max);                                                     // Returns the perimeter of a bounding box
 static float FindAxisLeastPenetration(int *faceIndex, PhysicsShape shapeA, PhysicsShape shapeB);            // Finds polygon shapes axis least penetration
-static void FindIncidentFace(Vector2 *v0, Vector2 *v1, PhysicsShape ref, PhysicsShape inc, int index);      // Finds two polygon shapes incident face
-static int Clip(Vector2 normal, float clip, Vector2 *faceA, Vector2 *faceB);                                // Calculates clipping based on a normal and two faces
+static float FindMinProjection(const float *x, const float *y, int count, Vector2 direction);               // Returns minimum projection over a direction of a SoA vertex block (count multiple of SIMD width)
+static void FindIncidentFace(PhysicsClipVertex *v0, PhysicsClipVertex *v1, PhysicsShape ref, PhysicsShape inc, int index);   // Finds two polygon shapes incident face
+static int Clip(Vector2 normal, float clip, PhysicsClipVertex *faceA, PhysicsClipVertex *faceB, unsigned int feature);    // Calculates clipping based on a normal and two faces
 static bool BiasGreaterThan(float valueA, float valueB);                                                    // Check if values are between bias range
 static Vector2 TriangleBarycenter(Vector2 v1, Vector2 v2, Vector2 v3);                                      // Returns the barycenter of a triangle given by 3 points
 
+static void InitPhysicsGlobals(void);                                                                       // Initializes data shared by all physics worlds (timer, random seed and circle vertices), only once
 static void InitTimer(void);                                                                                // Initializes hi-resolution MONOTONIC timer
+static void InitCircleVertices(void);                                                                       // Initializes circle shape vertices table of unit radius
 static uint64_t GetTimeCount(void);                                                                         // Get hi-res MONOTONIC time measure in mseconds
 static double GetCurrentTime(void);                                                                         // Get current time measure in milliseconds
+#if defined(PHYSAC_STATS)
+static void BeginPhysicsStatsPhase(int phase);                                                              // Stores current time as physics step phase start time
+static void EndPhysicsStatsPhase(int phase);                                                                // Accumulates elapsed time since physics step phase start time
+#endif
 
 // Math functions
 static Vector2 MathCross(float value, Vector2 vector);                                                      // Returns the cross product of a vector and a value
@@ -326,6 +953,7 @@ static float MathLenSqr(Vector2 vector);
 static float MathDot(Vector2 v1, Vector2 v2);                                                               // Returns the dot product of two vectors
 static inline float DistSqr(Vector2 v1, Vector2 v2);                                                        // Returns the square root of distance between two vectors
 static void MathNormalize(Vector2 *vector);                                                                 // Returns the normalized values of a vector
+static void MathSinCos(float radians, float *sine, float *cosine);                                          // Computes sine and cosine of an angle in radians
 #if defined(PHYSAC_STANDALONE)
 static Vector2 Vector2Add(Vector2 v1, Vector2 v2);                                                          // Returns the sum of two given vectors
 static Vector2 Vector2Subtract(Vector2 v1, Vector2 v2);                                                     // Returns the subtract of two given vectors
@@ -342,33 +970,98 @@ static inline Vector2 Mat2MultiplyVector2(Matrix2x2 matrix, Vector2 vector);
 // Initializes physics values, pointers and creates physics loop thread
 PHYSACDEF void InitPhysics(void)
 {
+    PhysicsWorldData *world = physicsWorld;
+
+    // Reserve bodies and manifolds pools initial capacity
+    if (world->bodiesCapacity == 0) GrowPhysicsBodies();
+    if (world->manifoldsCapacity == 0) GrowPhysicsManifolds();
+
+    // Initialize high resolution timer (before physics thread starts stepping)
+    InitPhysicsGlobals();
+    world->startTime = GetCurrentTime();
+    world->accumulator = 0.0;
+    world->averageDelta = 0.0;
+
     #if !defined(PHYSAC_NO_THREADS)
         // NOTE: if defined, user will need to create a thread for PhysicsThread function manually
-        // Create physics thread using POSIXS thread libraries
-        pthread_create(&physicsThreadId, NULL, &PhysicsLoop, NULL);
+        // Create physics thread using POSIXS thread libraries, it steps the physics world bound to calling thread
+        // NOTE: Enabled state is set before thread starts, so ClosePhysics() always stops it
+        world->physicsThreadEnabled = true;
+        pthread_create(&world->physicsThreadId, NULL, &PhysicsLoop, world);
     #endif
 
-    // Initialize high resolution timer
-    InitTimer();
-
     #if defined(PHYSAC_DEBUG)
         printf("[PHYSAC] physics module initialized successfully\n");
     #endif
-
-    accumulator = 0.0;
 }
 
 // Returns true if physics thread is currently enabled
 PHYSACDEF bool IsPhysicsEnabled(void)
 {
-    return physicsThreadEnabled;
+    PhysicsWorldData *world = physicsWorld;
+
+    return world->physicsThreadEnabled;
 }
 
 // Sets physics global gravity force
+// NOTE: Sleeping bodies are woken up, so they fall with new gravity
 PHYSACDEF void SetPhysicsGravity(float x, float y)
 {
-    gravityForce.x = x;
-    gravityForce.y = y;
+    PhysicsWorldData *world = physicsWorld;
+
+    PHYSAC_LOCK_WORLD(world);
+
+    world->gravityForce.x = x;
+    world->gravityForce.y = y;
+
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        if (world->bodies[i]->isSleeping) WakeUpPhysicsBody(world->bodies[i]);
+    }
+
+    PHYSAC_UNLOCK_WORLD(world);
+}
+
+// Sets contact solver tolerance, islands stop iterating when impulses change less than it
+// NOTE: Tolerance is measured as contact velocity change, in pixels per millisecond
+PHYSACDEF void SetPhysicsSolverTolerance(float tolerance)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    world->solverTolerance = tolerance;
+}
+
+// Sets worker threads used to solve contact islands (0 solves them in physics step thread)
+// NOTE: Physics step thread also solves islands while workers are running
+PHYSACDEF void SetPhysicsSolverThreads(int count)
+{
+#if !defined(PHYSAC_NO_THREADS)
+    PhysicsWorldData *world = physicsWorld;
+
+    if (count < 0) count = 0;
+    if (count > PHYSAC_MAX_SOLVER_THREADS) count = PHYSAC_MAX_SOLVER_THREADS;
+
+    // Stop current worker threads
+    pthread_mutex_lock(&world->solverMutex);
+    world->solverExit = true;
+    pthread_cond_broadcast(&world->solverStartCond);
+    pthread_mutex_unlock(&world->solverMutex);
+
+    for (int i = 0; i < world->solverThreadsCount; i++) pthread_join(world->solverThreads[i], NULL);
+
+    world->solverThreadsCount = 0;
+    world->solverExit = false;
+
+    // Create new worker threads
+    for (int i = 0; i < count; i++)
+    {
+        if (pthread_create(&world->solverThreads[world->solverThreadsCount], NULL, &PhysicsSolverLoop, world) == 0) world->solverThreadsCount++;
+    }
+
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] contact islands solver running on %i worker threads\n", world->solverThreadsCount);
+    #endif
+#endif
 }
 
 // Creates a new circle physics body with generic parameters
@@ -381,13 +1074,17 @@ PHYSACDEF PhysicsBody CreatePhysicsBodyCircle(Vector2 pos, float radius, float d
 // Creates a new rectangle physics body with generic parameters
 PHYSACDEF PhysicsBody CreatePhysicsBodyRectangle(Vector2 pos, float width, float height, float density)
 {
-    PhysicsBody newBody = (PhysicsBody)PHYSAC_MALLOC(sizeof(PhysicsBodyData));
-    usedMemory += sizeof(PhysicsBodyData);
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsBody newBody = NULL;
+
+    PHYSAC_LOCK_WORLD(world);
 
     int newId = FindAvailableBodyIndex();
     if (newId != -1)
     {
-        // Initialize new body with generic values
+        // Initialize new body from bodies pool with generic values
+        newBody = GetPhysicsBodySlot(newId);
         newBody->id = newId;
         newBody->enabled = true;
         newBody->position = pos;
@@ -400,59 +1097,33 @@ PHYSACDEF PhysicsBody CreatePhysicsBodyRectangle(Vector2 pos, float width, float
         newBody->shape.body = newBody;
         newBody->shape.radius = 0.0f;
         newBody->shape.transform = Mat2Radians(0.0f);
-        newBody->shape.vertexData = CreateRectanglePolygon(pos, (Vector2){ width, height });
-
-        // Calculate centroid and moment of inertia
-        Vector2 center = { 0.0f, 0.0f };
-        float area = 0.0f;
-        float inertia = 0.0f;
-
-        for (int i = 0; i < newBody->shape.vertexData.vertexCount; i++)
-        {
-            // Triangle vertices, third vertex implied as (0, 0)
-            Vector2 p1 = newBody->shape.vertexData.positions[i];
-            int nextIndex = (((i + 1) < newBody->shape.vertexData.vertexCount) ? (i + 1) : 0);
-            Vector2 p2 = newBody->shape.vertexData.positions[nextIndex];
-
-            float D = MathCrossVector2(p1, p2);
-            float triangleArea = D/2;
-
-            area += triangleArea;
-
-            // Use area to weight the centroid average, not just vertex position
-            center.x += triangleArea*PHYSAC_K*(p1.x + p2.x);
-            center.y += triangleArea*PHYSAC_K*(p1.y + p2.y);
-
-            float intx2 = p1.x*p1.x + p2.x*p1.x + p2.x*p2.x;
-            float inty2 = p1.y*p1.y + p2.y*p1.y + p2.y*p2.y;
-            inertia += (0.25f*PHYSAC_K*D)*(intx2 + inty2);
-        }
-
-        center.x *= 1.0f/area;
-        center.y *= 1.0f/area;
+        newBody->shape.vertexData = GetPolygonSlot(newId);
+        *newBody->shape.vertexData = CreateRectanglePolygon(pos, (Vector2){ width, height });
+        newBody->shape.piecesCount = 1;
 
-        // Translate vertices to centroid (make the centroid (0, 0) for the polygon in model space)
-        // Note: this is not really necessary
-        for (int i = 0; i < newBody->shape.vertexData.vertexCount; i++)
-        {
-            newBody->shape.vertexData.positions[i].x -= center.x;
-            newBody->shape.vertexData.positions[i].y -= center.y;
-        }
+        // Calculate centroid, mass and moment of inertia
+        ComputePhysicsBodyMass(newBody, density);
 
-        newBody->mass = density*area;
-        newBody->inverseMass = ((newBody->mass != 0.0f) ? 1.0f/newBody->mass : 0.0f);
-        newBody->inertia = density*inertia;
-        newBody->inverseInertia = ((newBody->inertia != 0.0f) ? 1.0f/newBody->inertia : 0.0f);
         newBody->staticFriction = 0.4f;
         newBody->dynamicFriction = 0.2f;
         newBody->restitution = 0.0f;
         newBody->useGravity = true;
         newBody->isGrounded = false;
+        newBody->isSleeping = false;
         newBody->freezeOrient = false;
+        newBody->isBullet = false;
+        newBody->isSensor = false;
+        newBody->categoryBits = PHYSAC_DEFAULT_CATEGORY_BITS;
+        newBody->maskBits = PHYSAC_DEFAULT_MASK_BITS;
+        world->sleepData[newId].restTime = 0.0f;
+        InitPhysicsBodyBounds(newBody);
 
         // Add new body to bodies pointers array and update bodies count
-        bodies[physicsBodiesCount] = newBody;
-        physicsBodiesCount++;
+        world->bodies[world->physicsBodiesCount] = newBody;
+        world->bodiesIndex[newId] = world->physicsBodiesCount;
+        world->physicsBodiesCount++;
+        world->proxiesDirty = true;
+        world->treeDirty = true;
 
         #if defined(PHYSAC_DEBUG)
             printf("[PHYSAC] created polygon physics body id %i\n", newBody->id);
@@ -462,19 +1133,25 @@ PHYSACDEF PhysicsBody CreatePhysicsBodyRectangle(Vector2 pos, float width, float
         else printf("[PHYSAC] new physics body creation failed because there is any available id to use\n");
     #endif
 
+    PHYSAC_UNLOCK_WORLD(world);
+
     return newBody;
 }
 
 // Creates a new polygon physics body with generic parameters
 PHYSACDEF PhysicsBody CreatePhysicsBodyPolygon(Vector2 pos, float radius, int sides, float density)
 {
-    PhysicsBody newBody = (PhysicsBody)PHYSAC_MALLOC(sizeof(PhysicsBodyData));
-    usedMemory += sizeof(PhysicsBodyData);
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsBody newBody = NULL;
+
+    PHYSAC_LOCK_WORLD(world);
 
     int newId = FindAvailableBodyIndex();
     if (newId != -1)
     {
-        // Initialize new body with generic values
+        // Initialize new body from bodies pool with generic values
+        newBody = GetPhysicsBodySlot(newId);
         newBody->id = newId;
         newBody->enabled = true;
         newBody->position = pos;
@@ -485,100 +1162,208 @@ PHYSACDEF PhysicsBody CreatePhysicsBodyPolygon(Vector2 pos, float radius, int si
         newBody->orient = 0.0f;
         newBody->shape.type = PHYSICS_POLYGON;
         newBody->shape.body = newBody;
+        newBody->shape.radius = 0.0f;
         newBody->shape.transform = Mat2Radians(0.0f);
-        newBody->shape.vertexData = CreateRandomPolygon(radius, sides);
+        newBody->shape.vertexData = GetPolygonSlot(newId);
+        *newBody->shape.vertexData = CreateRandomPolygon(radius, sides);
+        newBody->shape.piecesCount = 1;
 
-        // Calculate centroid and moment of inertia
-        Vector2 center = { 0.0f, 0.0f };
-        float area = 0.0f;
-        float inertia = 0.0f;
+        // Calculate centroid, mass and moment of inertia
+        ComputePhysicsBodyMass(newBody, density);
 
-        for (int i = 0; i < newBody->shape.vertexData.vertexCount; i++)
-        {
-            // Triangle vertices, third vertex implied as (0, 0)
-            Vector2 position1 = newBody->shape.vertexData.positions[i];
-            int nextIndex = (((i + 1) < newBody->shape.vertexData.vertexCount) ? (i + 1) : 0);
-            Vector2 position2 = newBody->shape.vertexData.positions[nextIndex];
+        newBody->staticFriction = 0.4f;
+        newBody->dynamicFriction = 0.2f;
+        newBody->restitution = 0.0f;
+        newBody->useGravity = true;
+        newBody->isGrounded = false;
+        newBody->isSleeping = false;
+        newBody->freezeOrient = false;
+        newBody->isBullet = false;
+        newBody->isSensor = false;
+        newBody->categoryBits = PHYSAC_DEFAULT_CATEGORY_BITS;
+        newBody->maskBits = PHYSAC_DEFAULT_MASK_BITS;
+        world->sleepData[newId].restTime = 0.0f;
+        InitPhysicsBodyBounds(newBody);
 
-            float cross = MathCrossVector2(position1, position2);
-            float triangleArea = cross/2;
+        // Add new body to bodies pointers array and update bodies count
+        world->bodies[world->physicsBodiesCount] = newBody;
+        world->bodiesIndex[newId] = world->physicsBodiesCount;
+        world->physicsBodiesCount++;
+        world->proxiesDirty = true;
+        world->treeDirty = true;
 
-            area += triangleArea;
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] created polygon physics body id %i\n", newBody->id);
+        #endif
+    }
+    #if defined(PHYSAC_DEBUG)
+        else printf("[PHYSAC] new physics body creation failed because there is any available id to use\n");
+    #endif
 
-            // Use area to weight the centroid average, not just vertex position
-            center.x += triangleArea*PHYSAC_K*(position1.x + position2.x);
-            center.y += triangleArea*PHYSAC_K*(position1.y + position2.y);
+    PHYSAC_UNLOCK_WORLD(world);
 
-            float intx2 = position1.x*position1.x + position2.x*position1.x + position2.x*position2.x;
-            float inty2 = position1.y*position1.y + position2.y*position1.y + position2.y*position2.y;
-            inertia += (0.25f*PHYSAC_K*cross)*(intx2 + inty2);
-        }
+    return newBody;
+}
+
+// Creates a new polygon physics body from the convex hull of a vertices set (relative to position)
+PHYSACDEF PhysicsBody CreatePhysicsBodyFromVertices(Vector2 pos, const Vector2 *vertices, int count, float density)
+{
+    PhysicsBody newBody = CreatePhysicsBodyCompound(pos, vertices, &count, 1, density);
+    return newBody;
+}
+
+// Creates a new compound physics body made of convex pieces (convex hull of every vertices group)
+// NOTE: Vertices groups are stored one after other, piecesVertices gives every group vertices count. Body position is
+// moved to pieces centroid, so shape keeps vertices positions. Compound bodies only need one broad-phase pair per body
+PHYSACDEF PhysicsBody CreatePhysicsBodyCompound(Vector2 pos, const Vector2 *vertices, const int *piecesVertices, int piecesCount, float density)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsBody newBody = NULL;
+
+    if ((vertices == NULL) || (piecesVertices == NULL) || (piecesCount <= 0))
+    {
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] new physics body creation failed because there are no vertices to build its shape\n");
+        #endif
 
-        center.x *= 1.0f/area;
-        center.y *= 1.0f/area;
+        return NULL;
+    }
+
+    PHYSAC_LOCK_WORLD(world);
+
+    int newId = FindAvailableBodyIndex();
+    if (newId != -1)
+    {
+        // Build every piece convex hull, compound shapes pieces are stored in pieces side table
+        PolygonData *pieces = ((piecesCount > 1) ? ReservePhysicsBodyPieces(newId, piecesCount) : GetPolygonSlot(newId));
+        bool valid = (pieces != NULL);
 
-        // Translate vertices to centroid (make the centroid (0, 0) for the polygon in model space)
-        // Note: this is not really necessary
-        for (int i = 0; i < newBody->shape.vertexData.vertexCount; i++)
+        for (int i = 0, offset = 0; (i < piecesCount) && valid; i++)
         {
-            newBody->shape.vertexData.positions[i].x -= center.x;
-            newBody->shape.vertexData.positions[i].y -= center.y;
+            valid = CreateHullPolygon(&vertices[offset], piecesVertices[i], &pieces[i]);
+            offset += piecesVertices[i];
         }
 
-        newBody->mass = density*area;
-        newBody->inverseMass = ((newBody->mass != 0.0f) ? 1.0f/newBody->mass : 0.0f);
-        newBody->inertia = density*inertia;
-        newBody->inverseInertia = ((newBody->inertia != 0.0f) ? 1.0f/newBody->inertia : 0.0f);
+        if (!valid)
+        {
+            // Release unused body id to bodies pool
+            ReleasePhysicsBodyPieces(newId);
+            world->freeIds[world->freeIdsCount] = newId;
+            world->freeIdsCount++;
+
+            #if defined(PHYSAC_DEBUG)
+                printf("[PHYSAC] new physics body creation failed because its vertices do not enclose any area\n");
+            #endif
+
+            PHYSAC_UNLOCK_WORLD(world);
+
+            return NULL;
+        }
+
+        // Initialize new body from bodies pool with generic values
+        newBody = GetPhysicsBodySlot(newId);
+        newBody->id = newId;
+        newBody->enabled = true;
+        newBody->velocity = PHYSAC_VECTOR_ZERO;
+        newBody->force = PHYSAC_VECTOR_ZERO;
+        newBody->angularVelocity = 0.0f;
+        newBody->torque = 0.0f;
+        newBody->orient = 0.0f;
+        newBody->shape.type = PHYSICS_POLYGON;
+        newBody->shape.body = newBody;
+        newBody->shape.radius = 0.0f;
+        newBody->shape.transform = Mat2Radians(0.0f);
+        newBody->shape.vertexData = pieces;
+        newBody->shape.piecesCount = piecesCount;
+
+        // Calculate centroid, mass and moment of inertia, body is placed at its centroid
+        newBody->position = Vector2Add(pos, ComputePhysicsBodyMass(newBody, density));
+
         newBody->staticFriction = 0.4f;
         newBody->dynamicFriction = 0.2f;
         newBody->restitution = 0.0f;
         newBody->useGravity = true;
         newBody->isGrounded = false;
+        newBody->isSleeping = false;
         newBody->freezeOrient = false;
+        newBody->isBullet = false;
+        newBody->isSensor = false;
+        newBody->categoryBits = PHYSAC_DEFAULT_CATEGORY_BITS;
+        newBody->maskBits = PHYSAC_DEFAULT_MASK_BITS;
+        world->sleepData[newId].restTime = 0.0f;
+        InitPhysicsBodyBounds(newBody);
 
         // Add new body to bodies pointers array and update bodies count
-        bodies[physicsBodiesCount] = newBody;
-        physicsBodiesCount++;
+        world->bodies[world->physicsBodiesCount] = newBody;
+        world->bodiesIndex[newId] = world->physicsBodiesCount;
+        world->physicsBodiesCount++;
+        world->proxiesDirty = true;
+        world->treeDirty = true;
 
         #if defined(PHYSAC_DEBUG)
-            printf("[PHYSAC] created polygon physics body id %i\n", newBody->id);
+            printf("[PHYSAC] created polygon physics body id %i (%i pieces)\n", newBody->id, piecesCount);
         #endif
     }
     #if defined(PHYSAC_DEBUG)
         else printf("[PHYSAC] new physics body creation failed because there is any available id to use\n");
     #endif
 
+    PHYSAC_UNLOCK_WORLD(world);
+
     return newBody;
 }
 
 // Adds a force to a physics body
 PHYSACDEF void PhysicsAddForce(PhysicsBody body, Vector2 force)
 {
-    if (body != NULL) body->force = Vector2Add(body->force, force);
+    if (body != NULL)
+    {
+        PhysicsWorldData *world = physicsWorld;
+
+        PHYSAC_LOCK_WORLD(world);
+        body->force = Vector2Add(body->force, force);
+        WakeUpPhysicsBody(body);
+        PHYSAC_UNLOCK_WORLD(world);
+    }
 }
 
 // Adds an angular force to a physics body
 PHYSACDEF void PhysicsAddTorque(PhysicsBody body, float amount)
 {
-    if (body != NULL) body->torque += amount;
+    if (body != NULL)
+    {
+        PhysicsWorldData *world = physicsWorld;
+
+        PHYSAC_LOCK_WORLD(world);
+        body->torque += amount;
+        WakeUpPhysicsBody(body);
+        PHYSAC_UNLOCK_WORLD(world);
+    }
 }
 
 // Shatters a polygon shape physics body to little physics bodies with explosion force
+// NOTE: Compound shapes are not shattered. Fragments are queued and spawned right away, or by next steps if a shatter
+// time budget is set (shattered body is destroyed right away)
 PHYSACDEF void PhysicsShatter(PhysicsBody body, Vector2 position, float force)
 {
     if (body != NULL)
     {
-        if (body->shape.type == PHYSICS_POLYGON)
+        PhysicsWorldData *world = physicsWorld;
+
+        PHYSAC_LOCK_WORLD(world);
+
+        if ((body->shape.type == PHYSICS_POLYGON) && (body->shape.piecesCount == 1))
         {
-            PolygonData vertexData = body->shape.vertexData;
+            PolygonData *vertexData = body->shape.vertexData;
             bool collision = false;
 
-            for (int i = 0; i < vertexData.vertexCount; i++)
+            for (int i = 0; i < vertexData->vertexCount; i++)
             {
                 Vector2 positionA = body->position;
-                Vector2 positionB = Mat2MultiplyVector2(body->shape.transform, Vector2Add(body->position, vertexData.positions[i]));
-                int nextIndex = (((i + 1) < vertexData.vertexCount) ? (i + 1) : 0);
-                Vector2 positionC = Mat2MultiplyVector2(body->shape.transform, Vector2Add(body->position, vertexData.positions[nextIndex]));
+                Vector2 positionB = Mat2MultiplyVector2(body->shape.transform, Vector2Add(body->position, vertexData->positions[i]));
+                int nextIndex = (((i + 1) < vertexData->vertexCount) ? (i + 1) : 0);
+                Vector2 positionC = Mat2MultiplyVector2(body->shape.transform, Vector2Add(body->position, vertexData->positions[nextIndex]));
 
                 // Check collision between each triangle
                 float alpha = ((positionB.y - positionC.y)*(position.x - positionC.x) + (positionC.x - positionB.x)*(position.y - positionC.y))/
@@ -598,124 +1383,168 @@ PHYSACDEF void PhysicsShatter(PhysicsBody body, Vector2 position, float force)
 
             if (collision)
             {
-                int count = vertexData.vertexCount;
+                int count = vertexData->vertexCount;
                 Vector2 bodyPos = body->position;
-                Vector2 *vertices = (Vector2*)malloc(sizeof(Vector2) * count);
                 Matrix2x2 trans = body->shape.transform;
-                for (int i = 0; i < count; i++) vertices[i] = vertexData.positions[i];
+                PolygonData vertices = *vertexData;
+                bool isSensor = body->isSensor;
+                unsigned int categoryBits = body->categoryBits;
+                unsigned int maskBits = body->maskBits;
+
+                if (!ReservePhysicsFragments(world->fragmentsCount + count))
+                {
+                    PHYSAC_UNLOCK_WORLD(world);
+                    return;
+                }
 
-                // Destroy shattered physics body
-                DestroyPhysicsBody(body);
+                // Destroy shattered physics body (first spawned fragment reuses its id)
+                RemovePhysicsBody(body);
 
                 for (int i = 0; i < count; i++)
                 {
                     int nextIndex = (((i + 1) < count) ? (i + 1) : 0);
-                    Vector2 center = TriangleBarycenter(vertices[i], vertices[nextIndex], PHYSAC_VECTOR_ZERO);
-                    center = Vector2Add(bodyPos, center);
-                    Vector2 offset = Vector2Subtract(center, bodyPos);
+                    Vector2 offset = TriangleBarycenter(vertices.positions[i], vertices.positions[nextIndex], PHYSAC_VECTOR_ZERO);
+                    Vector2 center = Vector2Add(bodyPos, offset);
 
-                    PhysicsBody newBody = CreatePhysicsBodyPolygon(center, 10, 3, 10);     // Create polygon physics body with relevant values
-
-                    PolygonData newData = { 0 };
-                    newData.vertexCount = 3;
-
-                    newData.positions[0] = Vector2Subtract(vertices[i], offset);
-                    newData.positions[1] = Vector2Subtract(vertices[nextIndex], offset);
-                    newData.positions[2] = Vector2Subtract(position, center);
+                    Vector2 positions[3] = { Vector2Subtract(vertices.positions[i], offset), Vector2Subtract(vertices.positions[nextIndex], offset), Vector2Subtract(position, center) };
 
                     // Separate vertices to avoid unnecessary physics collisions
-                    newData.positions[0].x *= 0.95f;
-                    newData.positions[0].y *= 0.95f;
-                    newData.positions[1].x *= 0.95f;
-                    newData.positions[1].y *= 0.95f;
-                    newData.positions[2].x *= 0.95f;
-                    newData.positions[2].y *= 0.95f;
-
-                    // Calculate polygon faces normals
-                    for (int j = 0; j < newData.vertexCount; j++)
+                    for (int j = 0; j < 3; j++)
                     {
-                        int nextVertex = (((j + 1) < newData.vertexCount) ? (j + 1) : 0);
-                        Vector2 face = Vector2Subtract(newData.positions[nextVertex], newData.positions[j]);
-
-                        newData.normals[j] = (Vector2){ face.y, -face.x };
-                        MathNormalize(&newData.normals[j]);
+                        positions[j].x *= 0.95f;
+                        positions[j].y *= 0.95f;
                     }
 
-                    // Apply computed vertex data to new physics body shape
-                    newBody->shape.vertexData = newData;
-                    newBody->shape.transform = trans;
-
-                    // Calculate centroid and moment of inertia
-                    center = PHYSAC_VECTOR_ZERO;
-                    float area = 0.0f;
-                    float inertia = 0.0f;
+                    // Calculate fragment centroid, mass and moment of inertia (unit density), fragment is placed at its centroid
+                    PhysicsFragmentData *fragment = &world->fragments[world->fragmentsCount];
+                    Vector2 centroid = { PHYSAC_K*(positions[0].x + positions[1].x + positions[2].x), PHYSAC_K*(positions[0].y + positions[1].y + positions[2].y) };
+                    float area = MathCrossVector2(Vector2Subtract(positions[1], positions[0]), Vector2Subtract(positions[2], positions[0]))/2;
+                    float distances = 0.0f;
 
-                    for (int j = 0; j < newBody->shape.vertexData.vertexCount; j++)
+                    for (int j = 0; j < 3; j++)
                     {
-                        // Triangle vertices, third vertex implied as (0, 0)
-                        Vector2 p1 = newBody->shape.vertexData.positions[j];
-                        int nextVertex = (((j + 1) < newBody->shape.vertexData.vertexCount) ? (j + 1) : 0);
-                        Vector2 p2 = newBody->shape.vertexData.positions[nextVertex];
-
-                        float D = MathCrossVector2(p1, p2);
-                        float triangleArea = D/2;
-
-                        area += triangleArea;
+                        fragment->positions[j] = Vector2Subtract(positions[j], centroid);
+                        distances += MathLenSqr(fragment->positions[j]);
+                    }
 
-                        // Use area to weight the centroid average, not just vertex position
-                        center.x += triangleArea*PHYSAC_K*(p1.x + p2.x);
-                        center.y += triangleArea*PHYSAC_K*(p1.y + p2.y);
+                    // Calculate fragment faces normals
+                    for (int j = 0; j < 3; j++)
+                    {
+                        int nextVertex = (((j + 1) < 3) ? (j + 1) : 0);
+                        Vector2 face = Vector2Subtract(fragment->positions[nextVertex], fragment->positions[j]);
 
-                        float intx2 = p1.x*p1.x + p2.x*p1.x + p2.x*p2.x;
-                        float inty2 = p1.y*p1.y + p2.y*p1.y + p2.y*p2.y;
-                        inertia += (0.25f*PHYSAC_K*D)*(intx2 + inty2);
+                        fragment->normals[j] = (Vector2){ face.y, -face.x };
+                        MathNormalize(&fragment->normals[j]);
                     }
 
-                    center.x *= 1.0f/area;
-                    center.y *= 1.0f/area;
+                    fragment->position = Vector2Add(center, Mat2MultiplyVector2(trans, centroid));
+                    fragment->transform = trans;
+                    fragment->mass = area;
+                    fragment->inertia = area*distances/12.0f;
+                    fragment->isSensor = isSensor;
+                    fragment->categoryBits = categoryBits;
+                    fragment->maskBits = maskBits;
 
-                    newBody->mass = area;
-                    newBody->inverseMass = ((newBody->mass != 0.0f) ? 1.0f/newBody->mass : 0.0f);
-                    newBody->inertia = inertia;
-                    newBody->inverseInertia = ((newBody->inertia != 0.0f) ? 1.0f/newBody->inertia : 0.0f);
-
-                    // Calculate explosion force direction
-                    Vector2 pointA = newBody->position;
-                    Vector2 pointB = Vector2Subtract(newData.positions[1], newData.positions[0]);
-                    pointB.x /= 2.0f;
-                    pointB.y /= 2.0f;
-                    Vector2 forceDirection = Vector2Subtract(Vector2Add(pointA, Vector2Add(newData.positions[0], pointB)), newBody->position);
+                    // Calculate explosion force direction, towards fragment outer face center
+                    Vector2 forceDirection = Vector2Add(positions[0], (Vector2){ (positions[1].x - positions[0].x)/2.0f, (positions[1].y - positions[0].y)/2.0f });
                     MathNormalize(&forceDirection);
-                    forceDirection.x *= force;
-                    forceDirection.y *= force;
+                    fragment->force = (Vector2){ forceDirection.x*force, forceDirection.y*force };
+
+                    world->fragmentsCount++;
+                }
 
-                    // Apply force to new physics body
-                    PhysicsAddForce(newBody, forceDirection);
+                // Grow bodies pool for queued fragments up front, so spawning them only takes pooled bodies
+                while (world->freeIdsCount < (world->fragmentsCount - world->fragmentsNext))
+                {
+                    if (!GrowPhysicsBodies()) break;
                 }
 
-                free(vertices);
+                if (world->shatterBudget <= 0.0) SpawnPhysicsFragments();
             }
         }
+
+        PHYSAC_UNLOCK_WORLD(world);
     }
     #if defined(PHYSAC_DEBUG)
         else printf("[PHYSAC] error when trying to shatter a null reference physics body");
     #endif
 }
 
+// Sets max time in milliseconds spent spawning shatter fragments every step (0 spawns them when shattering)
+// NOTE: At least one queued fragment is spawned every step. Fragments spawned by a budget depend on elapsed time, so
+// rollback and replay require no budget (queued fragments are not saved in physics states)
+PHYSACDEF void SetPhysicsShatterBudget(double budget)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    InitPhysicsGlobals();
+
+    world->shatterBudget = ((budget > 0.0) ? budget : 0.0);
+}
+
+// Returns the amount of shatter fragments waiting to be spawned by next steps
+PHYSACDEF int GetPhysicsShatterPending(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    return (world->fragmentsCount - world->fragmentsNext);
+}
+
+// Sets contact events reported for touching bodies pairs too (sensor overlaps are always reported)
+// NOTE: Solid bodies pairs stopping touching while disabled are reported as ending contacts once
+PHYSACDEF void SetPhysicsContactEvents(bool enabled)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    world->contactEvents = enabled;
+}
+
+// Returns the amount of contact events reported by last RunPhysicsStep() call
+PHYSACDEF int GetPhysicsContactEventsCount(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    return world->eventsCount;
+}
+
+// Writes contact events reported by last RunPhysicsStep() call (in steps order) into an array, returns events count
+// NOTE: Events must be read from the thread stepping physics world. Destroyed bodies report no ending contacts and touching
+// pairs are not part of saved physics states (loaded states report them as beginning contacts again)
+PHYSACDEF int GetPhysicsContactEvents(PhysicsContactEvent *events, int maxEvents)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    int count = 0;
+
+    if (events != NULL)
+    {
+        count = min((int)world->eventsCount, maxEvents);
+        for (int i = 0; i < count; i++) events[i] = world->events[i];
+    }
+
+    return count;
+}
+
 // Returns the current amount of created physics bodies
 PHYSACDEF int GetPhysicsBodiesCount(void)
 {
-    return physicsBodiesCount;
+    PhysicsWorldData *world = physicsWorld;
+
+    return world->physicsBodiesCount;
 }
 
 // Returns a physics body of the bodies pool at a specific index
 PHYSACDEF PhysicsBody GetPhysicsBody(int index)
 {
+    PhysicsWorldData *world = physicsWorld;
+
+    PHYSAC_LOCK_WORLD(world);
+
     PhysicsBody body = NULL;
 
-    if (index < physicsBodiesCount)
+    if (index < world->physicsBodiesCount)
     {
-        body = bodies[index];
+        body = world->bodies[index];
 
         if (body == NULL)
         {
@@ -728,17 +1557,23 @@ PHYSACDEF PhysicsBody GetPhysicsBody(int index)
     else printf("[PHYSAC] physics body index is out of bounds");
     #endif
 
+    PHYSAC_UNLOCK_WORLD(world);
+
     return body;
 }
 
 // Returns the physics body shape type (PHYSICS_CIRCLE or PHYSICS_POLYGON)
 PHYSACDEF int GetPhysicsShapeType(int index)
 {
+    PhysicsWorldData *world = physicsWorld;
+
+    PHYSAC_LOCK_WORLD(world);
+
     int result = -1;
 
-    if (index < physicsBodiesCount)
+    if (index < world->physicsBodiesCount)
     {
-        PhysicsBody body = bodies[index];
+        PhysicsBody body = world->bodies[index];
 
         if (body != NULL) result = body->shape.type;
         #if defined(PHYSAC_DEBUG)
@@ -749,24 +1584,33 @@ PHYSACDEF int GetPhysicsShapeType(int index)
     else printf("[PHYSAC] physics body index is out of bounds");
     #endif
 
+    PHYSAC_UNLOCK_WORLD(world);
+
     return result;
 }
 
 // Returns the amount of vertices of a physics body shape
 PHYSACDEF int GetPhysicsShapeVerticesCount(int index)
 {
+    PhysicsWorldData *world = physicsWorld;
+
+    PHYSAC_LOCK_WORLD(world);
+
     int result = 0;
 
-    if (index < physicsBodiesCount)
+    if (index < world->physicsBodiesCount)
     {
-        PhysicsBody body = bodies[index];
+        PhysicsBody body = world->bodies[index];
 
         if (body != NULL)
         {
             switch (body->shape.type)
             {
                 case PHYSICS_CIRCLE: result = PHYSAC_CIRCLE_VERTICES; break;
-                case PHYSICS_POLYGON: result = body->shape.vertexData.vertexCount; break;
+                case PHYSICS_POLYGON:
+                {
+                    for (int i = 0; i < body->shape.piecesCount; i++) result += body->shape.vertexData[i].vertexCount;
+                } break;
                 default: break;
             }
         }
@@ -778,10 +1622,13 @@ PHYSACDEF int GetPhysicsShapeVerticesCount(int index)
     else printf("[PHYSAC] physics body index is out of bounds");
     #endif
 
+    PHYSAC_UNLOCK_WORLD(world);
+
     return result;
 }
 
 // Returns transformed position of a body shape (body position + vertex transformed position)
+// NOTE: Compound shapes vertices are numbered piece after piece
 PHYSACDEF Vector2 GetPhysicsShapeVertex(PhysicsBody body, int vertex)
 {
     Vector2 position = { 0.0f, 0.0f };
@@ -792,14 +1639,10 @@ PHYSACDEF Vector2 GetPhysicsShapeVertex(PhysicsBody body, int vertex)
         {
             case PHYSICS_CIRCLE:
             {
-                position.x = body->position.x + cosf(360.0f/PHYSAC_CIRCLE_VERTICES*vertex*PHYSAC_DEG2RAD)*body->shape.radius;
-                position.y = body->position.y + sinf(360.0f/PHYSAC_CIRCLE_VERTICES*vertex*PHYSAC_DEG2RAD)*body->shape.radius;
-            } break;
-            case PHYSICS_POLYGON:
-            {
-                PolygonData vertexData = body->shape.vertexData;
-                position = Vector2Add(body->position, Mat2MultiplyVector2(body->shape.transform, vertexData.positions[vertex]));
+                position.x = body->position.x + circleVertices[vertex].x*body->shape.radius;
+                position.y = body->position.y + circleVertices[vertex].y*body->shape.radius;
             } break;
+            case PHYSICS_POLYGON: position = Vector2Add(body->position, Mat2MultiplyVector2(body->shape.transform, GetPolygonVertex(body->shape, vertex))); break;
             default: break;
         }
     }
@@ -810,995 +1653,4482 @@ PHYSACDEF Vector2 GetPhysicsShapeVertex(PhysicsBody body, int vertex)
     return position;
 }
 
-// Sets physics body shape transform based on radians parameter
-PHYSACDEF void SetPhysicsBodyRotation(PhysicsBody body, float radians)
+// Returns the amount of vertices needed to export acquired snapshot bodies shapes as lines (two vertices per shape edge)
+PHYSACDEF int GetPhysicsShapesLinesCount(void)
 {
-    if (body != NULL)
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsSnapshot *snapshot = &world->snapshots[world->snapshotFront];
+    int count = 0;
+
+    for (int i = 0; i < snapshot->count; i++)
     {
-        body->orient = radians;
+        PhysicsBody body = snapshot->bodies[i];
 
-        if (body->shape.type == PHYSICS_POLYGON) body->shape.transform = Mat2Radians(radians);
+        if (snapshot->generations[i] != body->generation) continue;
+
+        if (body->shape.type == PHYSICS_CIRCLE) count += 2*PHYSAC_CIRCLE_VERTICES;
+        else
+        {
+            for (int j = 0; j < body->shape.piecesCount; j++) count += 2*body->shape.vertexData[j].vertexCount;
+        }
     }
+
+    return count;
 }
 
-// Unitializes and destroys a physics body
-PHYSACDEF void DestroyPhysicsBody(PhysicsBody body)
+// Writes acquired snapshot bodies shapes edges as lines vertices (grouped per body) into a buffer, returns written vertices
+// NOTE: Every shape edge writes its two vertices placed with body transform interpolated between snapshot steps (alpha 0 to 1),
+// ready to be drawn as a lines batch from render thread without locks. Bodies are written in snapshot order (bodies pool
+// order of last published step) and only when all their edges fit into the buffer, bodyVertices (optional, one value per
+// snapshot body) receives the amount of vertices written for every body. Bodies destroyed after the snapshot was acquired
+// write no vertices, bodies created after it are written once a step includes them
+PHYSACDEF int GetPhysicsShapesLines(Vector2 *lines, int maxVertices, int *bodyVertices, float alpha)
 {
-    if (body != NULL)
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsSnapshot *snapshot = &world->snapshots[world->snapshotFront];
+    int count = 0;
+
+    for (int i = 0; i < snapshot->count; i++)
     {
-        int id = body->id;
-        int index = -1;
+        PhysicsBody body = snapshot->bodies[i];
+        int vertexCount = 0;
 
-        for (int i = 0; i < physicsBodiesCount; i++)
+        if (snapshot->generations[i] == body->generation)
         {
-            if (bodies[i]->id == id)
+            PhysicsTransform transform = InterpolatePhysicsTransform(snapshot->previous[i], snapshot->current[i], alpha);
+
+            // Compound shapes write every piece edges, body is skipped if all of them do not fit
+            int piecesCount = ((body->shape.type == PHYSICS_POLYGON) ? body->shape.piecesCount : 1);
+
+            for (int j = 0; j < piecesCount; j++) vertexCount += ((body->shape.type == PHYSICS_POLYGON) ? body->shape.vertexData[j].vertexCount : PHYSAC_CIRCLE_VERTICES);
+
+            if (count + 2*vertexCount > maxVertices) vertexCount = piecesCount = 0;
+
+            for (int piece = 0; piece < piecesCount; piece++)
             {
-                index = i;
-                break;
+                Vector2 vertices[PHYSAC_MAX_VERTICES];
+                int pieceVertices = 0;
+
+                if (body->shape.type == PHYSICS_CIRCLE)
+                {
+                    pieceVertices = PHYSAC_CIRCLE_VERTICES;
+
+                    for (int j = 0; j < pieceVertices; j++)
+                    {
+                        vertices[j].x = transform.position.x + circleVertices[j].x*body->shape.radius;
+                        vertices[j].y = transform.position.y + circleVertices[j].y*body->shape.radius;
+                    }
+                }
+                else
+                {
+                    PolygonData *vertexData = &body->shape.vertexData[piece];
+                    Matrix2x2 rotation = Mat2Radians(transform.orient);
+                    pieceVertices = vertexData->vertexCount;
+
+                    for (int j = 0; j < pieceVertices; j++) vertices[j] = Vector2Add(transform.position, Mat2MultiplyVector2(rotation, vertexData->positions[j]));
+                }
+
+                for (int j = 0; j < pieceVertices; j++)
+                {
+                    lines[count++] = vertices[j];
+                    lines[count++] = vertices[((j + 1) < pieceVertices) ? (j + 1) : 0];
+                }
             }
         }
 
-        if (index == -1)
-        {
-        #if defined(PHYSAC_DEBUG)
-            printf("[PHYSAC] Not possible to find body id %i in pointers array\n", id);
-        #endif
-            return;     // Prevent access to index -1
-        }
+        if (bodyVertices != NULL) bodyVertices[i] = 2*vertexCount;
+    }
 
-        // Free body allocated memory
-        PHYSAC_FREE(body);
-        usedMemory -= sizeof(PhysicsBodyData);
-        bodies[index] = NULL;
+    return count;
+}
 
-        // Reorder physics bodies pointers array and its catched index
-        for (int i = index; i < physicsBodiesCount; i++)
-        {
-            if ((i + 1) < physicsBodiesCount) bodies[i] = bodies[i + 1];
-        }
+// Sets physics body shape transform based on radians parameter
+// NOTE: Rotated body is woken up, like bodies receiving a force or torque
+PHYSACDEF void SetPhysicsBodyRotation(PhysicsBody body, float radians)
+{
+    if (body != NULL)
+    {
+        PhysicsWorldData *world = physicsWorld;
 
-        // Update physics bodies count
-        physicsBodiesCount--;
+        PHYSAC_LOCK_WORLD(world);
 
-        #if defined(PHYSAC_DEBUG)
-            printf("[PHYSAC] destroyed physics body id %i\n", id);
-        #endif
+        body->orient = radians;
+
+        if (body->shape.type == PHYSICS_POLYGON) body->shape.transform = Mat2Radians(radians);
+
+        WakeUpPhysicsBody(body);
+        world->treeDirty = true;
+
+        PHYSAC_UNLOCK_WORLD(world);
     }
-    #if defined(PHYSAC_DEBUG)
-        else printf("[PHYSAC] error trying to destroy a null referenced body\n");
-    #endif
 }
 
-// Destroys created physics bodies and manifolds and resets global values
-PHYSACDEF void ResetPhysics(void)
+// Returns world space bounding box of a physics body shape computed by last step
+// NOTE: Bounding box is read under world mutex (it can be used for culling while physics thread runs), bodies moved by hand are updated by next step
+PHYSACDEF void GetPhysicsBodyAABB(PhysicsBody body, Vector2 *min, Vector2 *max)
 {
-    // Unitialize physics bodies dynamic memory allocations
-    for (int i = physicsBodiesCount - 1; i >= 0; i--)
+    if (body != NULL)
     {
-        PhysicsBody body = bodies[i];
+        PhysicsWorldData *world = physicsWorld;
 
-        if (body != NULL)
-        {
-            PHYSAC_FREE(body);
-            bodies[i] = NULL;
-            usedMemory -= sizeof(PhysicsBodyData);
-        }
-    }
+        PHYSAC_LOCK_WORLD(world);
 
-    physicsBodiesCount = 0;
+        PhysicsBoundsData *bounds = &world->bounds[body->id];
 
-    // Unitialize physics manifolds dynamic memory allocations
-    for (int i = physicsManifoldsCount - 1; i >= 0; i--)
-    {
-        PhysicsManifold manifold = contacts[i];
+        if (min != NULL) *min = bounds->min;
+        if (max != NULL) *max = bounds->max;
 
-        if (manifold != NULL)
-        {
-            PHYSAC_FREE(manifold);
-            contacts[i] = NULL;
-            usedMemory -= sizeof(PhysicsManifoldData);
-        }
+        PHYSAC_UNLOCK_WORLD(world);
     }
+}
+
+// Returns bounding circle radius of a physics body shape around body position
+PHYSACDEF float GetPhysicsBodyRadius(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
 
-    physicsManifoldsCount = 0;
+    float radius = 0.0f;
 
-    #if defined(PHYSAC_DEBUG)
-        printf("[PHYSAC] physics module reset successfully\n");
-    #endif
+    PHYSAC_LOCK_WORLD(world);
+    if (body != NULL) radius = world->bounds[body->id].radius;
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return radius;
 }
 
-// Unitializes physics pointers and exits physics loop thread
-PHYSACDEF void ClosePhysics(void)
+// Acquires latest published bodies transforms snapshot (call it once per frame from render thread)
+// NOTE: Acquired snapshot is not modified by physics thread until next call, so it can be read without locks
+PHYSACDEF void UpdatePhysicsSnapshot(void)
 {
-    // Exit physics loop thread
-    physicsThreadEnabled = false;
+    PhysicsWorldData *world = physicsWorld;
 
-    #if !defined(PHYSAC_NO_THREADS)
-        pthread_join(physicsThreadId, NULL);
-    #endif
+    if (PHYSAC_ATOMIC_LOAD(&world->snapshotMiddle) & PHYSAC_SNAPSHOT_FRESH) world->snapshotFront = PHYSAC_ATOMIC_EXCHANGE(&world->snapshotMiddle, world->snapshotFront) & ~PHYSAC_SNAPSHOT_FRESH;
+}
 
-    // Unitialize physics manifolds dynamic memory allocations
-    for (int i = physicsManifoldsCount - 1; i >= 0; i--) DestroyPhysicsManifold(contacts[i]);
+// Returns interpolation factor between the two steps of acquired snapshot, based on elapsed time
+PHYSACDEF float GetPhysicsSnapshotAlpha(void)
+{
+    PhysicsWorldData *world = physicsWorld;
 
-    // Unitialize physics bodies dynamic memory allocations
-    for (int i = physicsBodiesCount - 1; i >= 0; i--) DestroyPhysicsBody(bodies[i]);
+    float alpha = 1.0f;
 
-    #if defined(PHYSAC_DEBUG)
-        if (physicsBodiesCount > 0 || usedMemory != 0) printf("[PHYSAC] physics module closed with %i still allocated bodies [MEMORY: %i bytes]\n", physicsBodiesCount, usedMemory);
-        else if (physicsManifoldsCount > 0 || usedMemory != 0) printf("[PHYSAC] physics module closed with %i still allocated manifolds [MEMORY: %i bytes]\n", physicsManifoldsCount, usedMemory);
-        else printf("[PHYSAC] physics module closed successfully\n");
-    #endif
+    if (world->snapshots[world->snapshotFront].count > 0) alpha = (float)((GetCurrentTime() - world->snapshots[world->snapshotFront].time)/world->deltaTime);
+
+    return ((alpha < 0.0f) ? 0.0f : ((alpha > 1.0f) ? 1.0f : alpha));
 }
 
-//----------------------------------------------------------------------------------
-// Module Internal Functions Definition
-//----------------------------------------------------------------------------------
-// Finds a valid index for a new physics body initialization
-static int FindAvailableBodyIndex()
+// Returns physics body transform from acquired snapshot, interpolated between its two steps (alpha 0 to 1)
+// NOTE: Bodies not included in acquired snapshot (just created, also in a destroyed body slot) return their current transform
+PHYSACDEF PhysicsTransform GetPhysicsBodyTransform(PhysicsBody body, float alpha)
 {
-    int index = -1;
-    for (int i = 0; i < PHYSAC_MAX_BODIES; i++)
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsTransform transform = { 0 };
+
+    if (body != NULL)
     {
-        int currentId = i;
+        PhysicsSnapshot *snapshot = &world->snapshots[world->snapshotFront];
+        unsigned int index = ((body->id < snapshot->capacity) ? snapshot->index[body->id] : snapshot->count);
 
-        // Check if current id already exist in other physics body
-        for (int k = 0; k < physicsBodiesCount; k++)
+        if ((index < snapshot->count) && (snapshot->bodies[index] == body) && (snapshot->generations[index] == body->generation))
         {
-            if (bodies[k]->id == currentId)
-            {
-                currentId++;
-                break;
-            }
+            transform = InterpolatePhysicsTransform(snapshot->previous[index], snapshot->current[index], alpha);
         }
-
-        // If it is not used, use it as new physics body id
-        if (currentId == i)
+        else
         {
-            index = i;
-            break;
+            transform.position = body->position;
+            transform.orient = body->orient;
         }
     }
+    #if defined(PHYSAC_DEBUG)
+    else printf("[PHYSAC] error when trying to get a null reference physics body");
+    #endif
 
-    return index;
+    return transform;
 }
 
-// Creates a random polygon shape with max vertex distance from polygon pivot
-static PolygonData CreateRandomPolygon(float radius, int sides)
+// Returns position of a body shape vertex placed with a physics body transform
+PHYSACDEF Vector2 GetPhysicsTransformVertex(PhysicsBody body, PhysicsTransform transform, int vertex)
 {
-    PolygonData data = { 0 };
-    data.vertexCount = sides;
+    Vector2 position = { 0.0f, 0.0f };
 
-    // Calculate polygon vertices positions
-    for (int i = 0; i < data.vertexCount; i++)
+    if (body != NULL)
     {
-        data.positions[i].x = cosf(360.0f/sides*i*PHYSAC_DEG2RAD)*radius;
-        data.positions[i].y = sinf(360.0f/sides*i*PHYSAC_DEG2RAD)*radius;
+        switch (body->shape.type)
+        {
+            case PHYSICS_CIRCLE:
+            {
+                position.x = transform.position.x + circleVertices[vertex].x*body->shape.radius;
+                position.y = transform.position.y + circleVertices[vertex].y*body->shape.radius;
+            } break;
+            case PHYSICS_POLYGON: position = Vector2Add(transform.position, Mat2MultiplyVector2(Mat2Radians(transform.orient), GetPolygonVertex(body->shape, vertex))); break;
+            default: break;
+        }
     }
+    #if defined(PHYSAC_DEBUG)
+    else printf("[PHYSAC] error when trying to get a null reference physics body");
+    #endif
 
-    // Calculate polygon faces normals
-    for (int i = 0; i < data.vertexCount; i++)
-    {
-        int nextIndex = (((i + 1) < sides) ? (i + 1) : 0);
-        Vector2 face = Vector2Subtract(data.positions[nextIndex], data.positions[i]);
+    return position;
+}
 
-        data.normals[i] = (Vector2){ face.y, -face.x };
-        MathNormalize(&data.normals[i]);
-    }
+// Unitializes and destroys a physics body
+PHYSACDEF void DestroyPhysicsBody(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
 
-    return data;
+    PHYSAC_LOCK_WORLD(world);
+    RemovePhysicsBody(body);
+    PHYSAC_UNLOCK_WORLD(world);
 }
 
-// Creates a rectangle polygon shape based on a min and max positions
-static PolygonData CreateRectanglePolygon(Vector2 pos, Vector2 size)
+// Destroys created physics bodies and manifolds and resets global values
+PHYSACDEF void ResetPhysics(void)
 {
-    PolygonData data = { 0 };
-    data.vertexCount = 4;
+    PhysicsWorldData *world = physicsWorld;
 
-    // Calculate polygon vertices positions
-    data.positions[0] = (Vector2){ pos.x + size.x/2, pos.y - size.y/2 };
-    data.positions[1] = (Vector2){ pos.x + size.x/2, pos.y + size.y/2 };
-    data.positions[2] = (Vector2){ pos.x - size.x/2, pos.y + size.y/2 };
-    data.positions[3] = (Vector2){ pos.x - size.x/2, pos.y - size.y/2 };
+    PHYSAC_LOCK_WORLD(world);
 
-    // Calculate polygon faces normals
-    for (int i = 0; i < data.vertexCount; i++)
+    // Release physics bodies pool, ids are stacked to be reused in ascending order
+    for (int i = world->physicsBodiesCount - 1; i >= 0; i--)
     {
-        int nextIndex = (((i + 1) < data.vertexCount) ? (i + 1) : 0);
-        Vector2 face = Vector2Subtract(data.positions[nextIndex], data.positions[i]);
-
-        data.normals[i] = (Vector2){ face.y, -face.x };
-        MathNormalize(&data.normals[i]);
+        world->bodies[i]->generation++;
+        world->bodies[i] = NULL;
     }
+    for (int i = 0; i < world->bodiesCapacity; i++) world->freeIds[i] = world->bodiesCapacity - 1 - i;
+    for (int i = 0; i < world->bodiesCapacity; i++) ReleasePhysicsBodyPieces(i);
 
-    return data;
+    world->freeIdsCount = world->bodiesCapacity;
+    world->physicsBodiesCount = 0;
+    world->proxiesDirty = true;
+    ResetPhysicsTree();
+
+    // Discard queued shatter fragments
+    world->fragmentsCount = 0;
+    world->fragmentsNext = 0;
+
+    // Release physics manifolds pools, previous step manifolds are cleared from hash table so reused bodies slots
+    // do not match them
+    world->physicsManifoldsCount = 0;
+    ClearPhysicsManifoldsTable();
+
+    // Discard touching pairs and contact events
+    world->touchingPairs.count = 0;
+    world->previousTouchingPairs.count = 0;
+    world->eventsCount = 0;
+
+    PHYSAC_UNLOCK_WORLD(world);
+
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] physics module reset successfully\n");
+    #endif
 }
 
-// Physics loop thread function
-static void *PhysicsLoop(void *arg)
+// Unitializes physics pointers and exits physics loop thread
+PHYSACDEF void ClosePhysics(void)
 {
-#if !defined(PHYSAC_NO_THREADS)
-    #if defined(PHYSAC_DEBUG)
-        printf("[PHYSAC] physics thread created successfully\n");
+    PhysicsWorldData *world = physicsWorld;
+
+    // Exit physics loop thread (only created by InitPhysics())
+    #if !defined(PHYSAC_NO_THREADS)
+        if (world->physicsThreadEnabled)
+        {
+            world->physicsThreadEnabled = false;
+            pthread_join(world->physicsThreadId, NULL);
+        }
     #endif
+    world->physicsThreadEnabled = false;
 
-    // Initialize physics loop thread values
-    physicsThreadEnabled = true;
+    // Exit contact islands solver worker threads
+    SetPhysicsSolverThreads(0);
 
-    // Physics update loop
-    while (physicsThreadEnabled)
-    {
-        RunPhysicsStep();
-    }
-#endif
+    // Unitialize physics bodies and manifolds pools dynamic memory allocations
+    ReleasePhysicsPools();
 
-    return NULL;
+    #if defined(PHYSAC_DEBUG)
+        if (world->physicsBodiesCount > 0 || world->usedMemory != 0) printf("[PHYSAC] physics module closed with %i still allocated bodies [MEMORY: %i bytes]\n", world->physicsBodiesCount, world->usedMemory);
+        else printf("[PHYSAC] physics module closed successfully\n");
+    #endif
 }
 
-// Physics steps calculations (dynamics, collisions and position corrections)
-static void PhysicsStep(void)
+// Creates a new empty physics world with default values and reserved pools
+// NOTE: Physics loop thread is not created, world is stepped by StepPhysicsWorlds() or RunPhysicsStep() (bind it
+// first), calling InitPhysics() with the world bound creates its physics loop thread
+PHYSACDEF PhysicsWorld CreatePhysicsWorld(void)
 {
-    // Update current steps count
-    stepsCount++;
+    PhysicsWorldData *newWorld = (PhysicsWorldData *)PHYSAC_MALLOC(sizeof(PhysicsWorldData));
 
-    // Clear previous generated collisions information
-    for (int i = physicsManifoldsCount - 1; i >= 0; i--)
+    if (newWorld != NULL)
     {
-        PhysicsManifold manifold = contacts[i];
-        if (manifold != NULL) DestroyPhysicsManifold(manifold);
-    }
+        *newWorld = (PhysicsWorldData){ 0 };
+        newWorld->deltaTime = PHYSAC_DEFAULT_TIME_STEP;
+        newWorld->gravityForce = (Vector2){ 0.0f, PHYSAC_DEFAULT_GRAVITY };
+        newWorld->solverTolerance = PHYSAC_SOLVER_TOLERANCE;
+        newWorld->solverIterations = PHYSAC_COLLISION_ITERATIONS;
+        newWorld->timeDilation = 1.0f;
+        newWorld->snapshotBack = 0;
+        newWorld->snapshotMiddle = 1;
+        newWorld->snapshotFront = 2;
+        newWorld->proxiesDirty = true;
 
-    // Reset physics bodies grounded state
-    for (int i = 0; i < physicsBodiesCount; i++)
-    {
-        PhysicsBody body = bodies[i];
-        body->isGrounded = false;
-    }
+    #if !defined(PHYSAC_NO_THREADS)
+        pthread_mutex_init(&newWorld->worldMutex, NULL);
+        pthread_mutex_init(&newWorld->solverMutex, NULL);
+        pthread_cond_init(&newWorld->solverStartCond, NULL);
+        pthread_cond_init(&newWorld->solverDoneCond, NULL);
+    #endif
 
-    // Generate new collision information
-    for (int i = 0; i < physicsBodiesCount; i++)
-    {
-        PhysicsBody bodyA = bodies[i];
+        InitPhysicsGlobals();
 
-        if (bodyA != NULL)
-        {
-            for (int j = i + 1; j < physicsBodiesCount; j++)
-            {
-                PhysicsBody bodyB = bodies[j];
+        // Reserve bodies and manifolds pools initial capacity (pools are grown with new world bound)
+        PhysicsWorldData *previousWorld = physicsWorld;
+        physicsWorld = newWorld;
 
-                if (bodyB != NULL)
-                {
-                    if ((bodyA->inverseMass == 0) && (bodyB->inverseMass == 0)) continue;
+        GrowPhysicsBodies();
+        GrowPhysicsManifolds();
+        newWorld->startTime = GetCurrentTime();
 
-                    PhysicsManifold manifold = CreatePhysicsManifold(bodyA, bodyB);
-                    SolvePhysicsManifold(manifold);
+        physicsWorld = previousWorld;
 
-                    if (manifold->contactsCount > 0)
-                    {
-                        // Create a new manifold with same information as previously solved manifold and add it to the manifolds pool last slot
-                        PhysicsManifold newManifold = CreatePhysicsManifold(bodyA, bodyB);
-                        newManifold->penetration = manifold->penetration;
-                        newManifold->normal = manifold->normal;
-                        newManifold->contacts[0] = manifold->contacts[0];
-                        newManifold->contacts[1] = manifold->contacts[1];
-                        newManifold->contactsCount = manifold->contactsCount;
-                        newManifold->restitution = manifold->restitution;
-                        newManifold->dynamicFriction = manifold->dynamicFriction;
-                        newManifold->staticFriction = manifold->staticFriction;
-                    }
-                }
-            }
-        }
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] new physics world created successfully\n");
+        #endif
     }
+    #if defined(PHYSAC_DEBUG)
+    else printf("[PHYSAC] new physics world creation failed because there is not enough memory\n");
+    #endif
 
-    // Integrate forces to physics bodies
-    for (int i = 0; i < physicsBodiesCount; i++)
-    {
-        PhysicsBody body = bodies[i];
-        if (body != NULL) IntegratePhysicsForces(body);
-    }
+    return newWorld;
+}
 
-    // Initialize physics manifolds to solve collisions
-    for (int i = 0; i < physicsManifoldsCount; i++)
+// Closes a physics world (bodies, manifolds and threads) and frees it
+// NOTE: Default physics world can not be destroyed (use ClosePhysics() instead), threads binding the destroyed
+// world must bind another world before calling physics functions again
+PHYSACDEF void DestroyPhysicsWorld(PhysicsWorld world)
+{
+    if ((world == NULL) || (world == &defaultWorld))
     {
-        PhysicsManifold manifold = contacts[i];
-        if (manifold != NULL) InitializePhysicsManifolds(manifold);
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] error when trying to destroy a null reference or default physics world\n");
+    #endif
+        return;
     }
 
-    // Integrate physics collisions impulses to solve collisions
-    for (int i = 0; i < PHYSAC_COLLISION_ITERATIONS; i++)
-    {
-        for (int j = 0; j < physicsManifoldsCount; j++)
-        {
-            PhysicsManifold manifold = contacts[i];
-            if (manifold != NULL) IntegratePhysicsImpulses(manifold);
-        }
-    }
+    PhysicsWorldData *previousWorld = physicsWorld;
+    physicsWorld = world;
 
-    // Integrate velocity to physics bodies
-    for (int i = 0; i < physicsBodiesCount; i++)
-    {
-        PhysicsBody body = bodies[i];
-        if (body != NULL) IntegratePhysicsVelocity(body);
-    }
+    ClosePhysics();
 
-    // Correct physics bodies positions based on manifolds collision information
-    for (int i = 0; i < physicsManifoldsCount; i++)
-    {
-        PhysicsManifold manifold = contacts[i];
-        if (manifold != NULL) CorrectPhysicsPositions(manifold);
-    }
+    physicsWorld = ((previousWorld != world) ? previousWorld : &defaultWorld);
 
-    // Clear physics bodies forces
-    for (int i = 0; i < physicsBodiesCount; i++)
-    {
-        PhysicsBody body = bodies[i];
-        if (body != NULL)
-        {
-            body->force = PHYSAC_VECTOR_ZERO;
-            body->torque = 0.0f;
-        }
-    }
+    #if !defined(PHYSAC_NO_THREADS)
+        pthread_mutex_destroy(&world->worldMutex);
+        pthread_mutex_destroy(&world->solverMutex);
+        pthread_cond_destroy(&world->solverStartCond);
+        pthread_cond_destroy(&world->solverDoneCond);
+    #endif
+
+    PHYSAC_FREE(world);
 }
 
-// Wrapper to ensure PhysicsStep is run with at a fixed time step
-PHYSACDEF void RunPhysicsStep(void)
+// Binds a physics world to calling thread, next physics functions calls use it (NULL binds default world)
+PHYSACDEF void SetPhysicsWorld(PhysicsWorld world)
 {
-    // Calculate current time
-    currentTime = GetCurrentTime();
+    physicsWorld = ((world != NULL) ? world : &defaultWorld);
+}
 
-    // Calculate current delta time
-    const double delta = currentTime - startTime;
+// Returns the physics world bound to calling thread
+PHYSACDEF PhysicsWorld GetPhysicsWorld(void)
+{
+    return physicsWorld;
+}
 
-    // Store the time elapsed since the last frame began
-    accumulator += delta;
+// Sets worker threads used to step physics worlds (0 steps them in calling thread)
+// NOTE: Calling thread also steps physics worlds while workers are running
+PHYSACDEF void SetPhysicsWorldsThreads(int count)
+{
+#if !defined(PHYSAC_NO_THREADS)
+    if (count < 0) count = 0;
+    if (count > PHYSAC_MAX_WORLDS_THREADS) count = PHYSAC_MAX_WORLDS_THREADS;
 
-    // Fixed time stepping loop
-    while (accumulator >= deltaTime)
+    // Stop current worker threads
+    pthread_mutex_lock(&worldsMutex);
+    worldsExit = true;
+    pthread_cond_broadcast(&worldsStartCond);
+    pthread_mutex_unlock(&worldsMutex);
+
+    for (int i = 0; i < worldsThreadsCount; i++) pthread_join(worldsThreads[i], NULL);
+
+    worldsThreadsCount = 0;
+    worldsExit = false;
+
+    // Create new worker threads
+    for (int i = 0; i < count; i++)
     {
-#ifdef PHYSAC_DEBUG
-        //printf("currentTime %f, startTime %f, accumulator-pre %f, accumulator-post %f, delta %f, deltaTime %f\n",
-        //       currentTime, startTime, accumulator, accumulator-deltaTime, delta, deltaTime);
-#endif
-        PhysicsStep();
-        accumulator -= deltaTime;
+        if (pthread_create(&worldsThreads[worldsThreadsCount], NULL, &PhysicsWorldsLoop, NULL) == 0) worldsThreadsCount++;
     }
 
-    // Record the starting of this frame
-    startTime = currentTime;
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] physics worlds stepping running on %i worker threads\n", worldsThreadsCount);
+    #endif
+#endif
 }
 
-PHYSACDEF void SetPhysicsTimeStep(double delta)
+// Runs a physics step on every physics world, spreading them over worker threads
+// NOTE: Stepped worlds must not run their own physics loop thread (InitPhysics()), every world is stepped by
+// only one thread at a time so worlds do not require any lock. Calling thread world binding is kept
+PHYSACDEF void StepPhysicsWorlds(PhysicsWorld *worlds, int count)
 {
-    deltaTime = delta;
-}
+    if ((worlds == NULL) || (count <= 0)) return;
 
-// Finds a valid index for a new manifold initialization
-static int FindAvailableManifoldIndex()
-{
-    int index = -1;
-    for (int i = 0; i < PHYSAC_MAX_MANIFOLDS; i++)
-    {
-        int currentId = i;
+    PhysicsWorldData *previousWorld = physicsWorld;
 
-        // Check if current id already exist in other physics body
-        for (int k = 0; k < physicsManifoldsCount; k++)
+#if !defined(PHYSAC_NO_THREADS)
+    if (worldsThreadsCount > 0)
+    {
+        pthread_mutex_lock(&worldsMutex);
+        worldsJob = worlds;
+        worldsJobCount = count;
+        worldsNextIndex = 0;
+        worldsDoneCount = 0;
+        worldsJobId++;
+        pthread_cond_broadcast(&worldsStartCond);
+
+        // Calling thread steps worlds too
+        while (worldsNextIndex < worldsJobCount)
         {
-            if (contacts[k]->id == currentId)
-            {
-                currentId++;
-                break;
-            }
-        }
+            int index = worldsNextIndex;
+            worldsNextIndex++;
 
-        // If it is not used, use it as new physics body id
-        if (currentId == i)
-        {
-            index = i;
-            break;
+            pthread_mutex_unlock(&worldsMutex);
+            StepPhysicsWorld(worlds[index]);
+            pthread_mutex_lock(&worldsMutex);
+
+            worldsDoneCount++;
         }
+
+        while (worldsDoneCount < worldsJobCount) pthread_cond_wait(&worldsDoneCond, &worldsMutex);
+
+        worldsJob = NULL;
+        worldsJobCount = 0;
+        pthread_mutex_unlock(&worldsMutex);
+    }
+    else
+#endif
+    {
+        for (int i = 0; i < count; i++) StepPhysicsWorld(worlds[i]);
     }
 
-    return index;
+    physicsWorld = previousWorld;
 }
 
-// Creates a new physics manifold to solve collision
-static PhysicsManifold CreatePhysicsManifold(PhysicsBody a, PhysicsBody b)
+// Returns the size in bytes required to save current physics state
+PHYSACDEF int GetPhysicsStateSize(void)
 {
-    PhysicsManifold newManifold = (PhysicsManifold)PHYSAC_MALLOC(sizeof(PhysicsManifoldData));
-    usedMemory += sizeof(PhysicsManifoldData);
+    PhysicsWorldData *world = physicsWorld;
 
-    int newId = FindAvailableManifoldIndex();
-    if (newId != -1)
-    {
-        // Initialize new manifold with generic values
-        newManifold->id = newId;
-        newManifold->bodyA = a;
-        newManifold->bodyB = b;
-        newManifold->penetration = 0;
-        newManifold->normal = PHYSAC_VECTOR_ZERO;
-        newManifold->contacts[0] = PHYSAC_VECTOR_ZERO;
-        newManifold->contacts[1] = PHYSAC_VECTOR_ZERO;
-        newManifold->contactsCount = 0;
-        newManifold->restitution = 0.0f;
-        newManifold->dynamicFriction = 0.0f;
-        newManifold->staticFriction = 0.0f;
+    PHYSAC_LOCK_WORLD(world);
+    int size = WritePhysicsState(NULL, 0);
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return size;
+}
+
+// Saves current physics state (bodies, shapes and contacts) into a buffer, returns written bytes (0 if it does not fit)
+// NOTE: Buffer requires GetPhysicsStateSize() bytes, physics state is never allocated
+PHYSACDEF int SavePhysicsState(unsigned char *buffer, int maxSize)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (buffer == NULL) return 0;
+
+    PHYSAC_LOCK_WORLD(world);
+    int size = WritePhysicsState(buffer, maxSize);
+    PHYSAC_UNLOCK_WORLD(world);
 
-        // Add new body to bodies pointers array and update bodies count
-        contacts[physicsManifoldsCount] = newManifold;
-        physicsManifoldsCount++;
-    }
     #if defined(PHYSAC_DEBUG)
-        else printf("[PHYSAC] new physics manifold creation failed because there is any available id to use\n");
+        if (size > maxSize) printf("[PHYSAC] physics state requires %i bytes, buffer size is %i bytes\n", size, maxSize);
     #endif
 
-    return newManifold;
+    return ((size <= maxSize) ? size : 0);
 }
 
-// Unitializes and destroys a physics manifold
-static void DestroyPhysicsManifold(PhysicsManifold manifold)
+// Restores a saved physics state in place (bodies keep their ids and references), returns false if data is not valid
+// NOTE: Bodies not included in the state are destroyed and bodies pool grows to state capacity if required. Records are
+// checked before any change, so physics state is only modified when it is restored completely
+PHYSACDEF bool LoadPhysicsState(const unsigned char *data, int size)
 {
-    if (manifold != NULL)
+    PhysicsWorldData *world = physicsWorld;
+
+    PHYSAC_LOCK_WORLD(world);
+    bool loaded = ReadPhysicsState(data, size);
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return loaded;
+}
+
+// Encodes a saved physics state as a delta against a base state, returns written bytes (0 if it does not fit)
+// NOTE: Delta is the state XOR base bytes as runs of zero bytes and literal bytes (run lengths stored as varints),
+// unchanged records (static bodies, shapes and sleeping bodies) only take a few bytes
+PHYSACDEF int EncodePhysicsStateDelta(const unsigned char *base, int baseSize, const unsigned char *state, int stateSize, unsigned char *delta, int maxSize)
+{
+    if ((state == NULL) || (delta == NULL) || (stateSize <= 0)) return 0;
+    if (base == NULL) baseSize = 0;
+
+    PhysicsStateStream stream = { delta, NULL, maxSize, 0 };
+    WriteStateVarint(&stream, stateSize);
+
+    int offset = 0;
+
+    while ((offset < stateSize) && (stream.offset <= maxSize))
     {
-        int id = manifold->id;
-        int index = -1;
+        // Count unchanged bytes
+        int start = offset;
+        while ((offset < stateSize) && (state[offset] == ((offset < baseSize) ? base[offset] : 0))) offset++;
 
-        for (int i = 0; i < physicsManifoldsCount; i++)
+        int zeros = offset - start;
+
+        // Count changed bytes, short unchanged runs are kept as literals (a new run costs at least two bytes)
+        start = offset;
+        int end = offset;
+
+        while (offset < stateSize)
         {
-            if (contacts[i]->id == id)
-            {
-                index = i;
-                break;
-            }
+            if (state[offset] != ((offset < baseSize) ? base[offset] : 0)) end = offset + 1;
+            else if ((offset - end) >= 2) break;
+
+            offset++;
         }
 
-        if (index == -1)
-        {
-        #if defined(PHYSAC_DEBUG)
-            printf("[PHYSAC] Not possible to manifold id %i in pointers array\n", id);
-        #endif
-            return;     // Prevent access to index -1
-        }      
+        offset = end;
 
-        // Free manifold allocated memory
-        PHYSAC_FREE(manifold);
-        usedMemory -= sizeof(PhysicsManifoldData);
-        contacts[index] = NULL;
+        WriteStateVarint(&stream, zeros);
+        WriteStateVarint(&stream, end - start);
 
-        // Reorder physics manifolds pointers array and its catched index
-        for (int i = index; i < physicsManifoldsCount; i++)
+        for (int i = start; i < end; i++)
         {
-            if ((i + 1) < physicsManifoldsCount) contacts[i] = contacts[i + 1];
+            unsigned char value = state[i] ^ ((i < baseSize) ? base[i] : 0);
+            WriteStateData(&stream, &value, 1);
         }
+    }
+
+    return ((stream.offset <= maxSize) ? stream.offset : 0);
+}
+
+// Decodes a physics state delta against its base state, returns decoded state bytes (0 if it does not fit or is not valid)
+PHYSACDEF int DecodePhysicsStateDelta(const unsigned char *base, int baseSize, const unsigned char *delta, int deltaSize, unsigned char *state, int maxSize)
+{
+    if ((delta == NULL) || (state == NULL)) return 0;
+    if (base == NULL) baseSize = 0;
+
+    PhysicsStateStream stream = { NULL, delta, deltaSize, 0 };
+    unsigned int stateSize = 0;
+
+    if (!ReadStateVarint(&stream, &stateSize) || (stateSize == 0) || (stateSize > (unsigned int)maxSize)) return 0;
+
+    unsigned int offset = 0;
 
-        // Update physics manifolds count
-        physicsManifoldsCount--;
+    while (offset < stateSize)
+    {
+        unsigned int zeros = 0;
+        unsigned int literals = 0;
+
+        if (!ReadStateVarint(&stream, &zeros) || !ReadStateVarint(&stream, &literals) ||
+            (zeros > (stateSize - offset)) || (literals > (stateSize - offset - zeros)) || (literals > (unsigned int)(deltaSize - stream.offset))) return 0;
+
+        for (unsigned int i = 0; i < zeros; i++, offset++) state[offset] = ((offset < baseSize) ? base[offset] : 0);
+
+        for (unsigned int i = 0; i < literals; i++, offset++) state[offset] = delta[stream.offset + i] ^ ((offset < baseSize) ? base[offset] : 0);
+
+        stream.offset += literals;
     }
-    #if defined(PHYSAC_DEBUG)
-        else printf("[PHYSAC] error trying to destroy a null referenced manifold\n");
-    #endif
+
+    return ((stream.offset == deltaSize) ? (int)stateSize : 0);
 }
 
-// Solves a created physics manifold between two physics bodies
-static void SolvePhysicsManifold(PhysicsManifold manifold)
+// Casts a ray and writes hit bodies sorted by distance (closest first) into an array, returns hits count
+// NOTE: Once hits array is full, ray is shortened to its farthest hit (one hit array finds the closest body quickly).
+// Bodies containing ray origin are not hit
+PHYSACDEF int PhysicsRaycast(Vector2 origin, Vector2 direction, float maxDistance, PhysicsRaycastHit *hits, int maxHits)
 {
-    switch (manifold->bodyA->shape.type)
+    PhysicsWorldData *world = physicsWorld;
+
+    if ((hits == NULL) || (maxHits <= 0) || (MathLenSqr(direction) == 0.0f)) return 0;
+
+    MathNormalize(&direction);
+    PHYSAC_LOCK_WORLD(world);
+    UpdatePhysicsTree();
+
+    int count = 0;
+    PhysicsTreeStack stack;
+    InitPhysicsTreeStack(&stack);
+
+    if (world->treeRoot != 0) PushPhysicsTreeStack(&stack, world->treeRoot);
+
+    while (stack.count > 0)
     {
-        case PHYSICS_CIRCLE:
+        PhysicsTreeNode *node = &world->treeNodes[stack.nodes[--stack.count]];
+
+        if (!RaycastBounds(origin, direction, maxDistance, node->min, node->max)) continue;
+
+        if (node->body != NULL)
         {
-            switch (manifold->bodyB->shape.type)
+            float distance = 0.0f;
+            Vector2 normal = PHYSAC_VECTOR_ZERO;
+
+            if (!RaycastPhysicsBody(node->body, origin, direction, maxDistance, &distance, &normal)) continue;
+
+            // Insert hit sorted by distance, farthest hit is dropped when hits array is full
+            int index = ((count < maxHits) ? count++ : (maxHits - 1));
+
+            while ((index > 0) && (hits[index - 1].distance > distance))
             {
-                case PHYSICS_CIRCLE: SolveCircleToCircle(manifold); break;
-                case PHYSICS_POLYGON: SolveCircleToPolygon(manifold); break;
-                default: break;
+                hits[index] = hits[index - 1];
+                index--;
             }
-        } break;
-        case PHYSICS_POLYGON:
+
+            hits[index].body = node->body;
+            hits[index].position = (Vector2){ origin.x + direction.x*distance, origin.y + direction.y*distance };
+            hits[index].normal = normal;
+            hits[index].distance = distance;
+
+            if (count == maxHits) maxDistance = hits[count - 1].distance;
+        }
+        else
         {
-            switch (manifold->bodyB->shape.type)
-            {
-                case PHYSICS_CIRCLE: SolvePolygonToCircle(manifold); break;
-                case PHYSICS_POLYGON: SolvePolygonToPolygon(manifold); break;
-                default: break;
-            }
-        } break;
-        default: break;
+            PushPhysicsTreeStack(&stack, node->children[0]);
+            PushPhysicsTreeStack(&stack, node->children[1]);
+        }
     }
 
-    // Update physics body grounded state if normal direction is down and grounded state is not set yet in previous manifolds
-    if (!manifold->bodyB->isGrounded) manifold->bodyB->isGrounded = (manifold->normal.y < 0);
+    UnloadPhysicsTreeStack(&stack);
+
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return count;
 }
 
-// Solves collision between two circle shape physics bodies
-static void SolveCircleToCircle(PhysicsManifold manifold)
+// Writes bodies which bounding box overlaps an axis aligned box into an array, returns bodies count
+PHYSACDEF int PhysicsQueryAABB(Vector2 min, Vector2 max, PhysicsBody *bodies, int maxBodies)
 {
-    PhysicsBody bodyA = manifold->bodyA;
-    PhysicsBody bodyB = manifold->bodyB;
+    PhysicsWorldData *world = physicsWorld;
 
-    if ((bodyA == NULL) || (bodyB == NULL)) return;
+    if ((bodies == NULL) || (maxBodies <= 0)) return 0;
 
-    // Calculate translational vector, which is normal
-    Vector2 normal = Vector2Subtract(bodyB->position, bodyA->position);
+    PHYSAC_LOCK_WORLD(world);
+    UpdatePhysicsTree();
 
-    float distSqr = MathLenSqr(normal);
-    float radius = bodyA->shape.radius + bodyB->shape.radius;
+    int count = 0;
+    PhysicsTreeStack stack;
+    InitPhysicsTreeStack(&stack);
 
-    // Check if circles are not in contact
-    if (distSqr >= radius*radius)
+    if (world->treeRoot != 0) PushPhysicsTreeStack(&stack, world->treeRoot);
+
+    while ((stack.count > 0) && (count < maxBodies))
     {
-        manifold->contactsCount = 0;
-        return;
-    }
+        PhysicsTreeNode *node = &world->treeNodes[stack.nodes[--stack.count]];
 
-    float distance = sqrtf(distSqr);
-    manifold->contactsCount = 1;
+        if ((node->min.x > max.x) || (node->max.x < min.x) || (node->min.y > max.y) || (node->max.y < min.y)) continue;
 
-    if (distance == 0.0f)
-    {
-        manifold->penetration = bodyA->shape.radius;
-        manifold->normal = (Vector2){ 1.0f, 0.0f };
-        manifold->contacts[0] = bodyA->position;
-    }
-    else
-    {
-        manifold->penetration = radius - distance;
-        manifold->normal = (Vector2){ normal.x/distance, normal.y/distance }; // Faster than using MathNormalize() due to sqrt is already performed
-        manifold->contacts[0] = (Vector2){ manifold->normal.x*bodyA->shape.radius + bodyA->position.x, manifold->normal.y*bodyA->shape.radius + bodyA->position.y };
+        if (node->body != NULL)
+        {
+            // Leaves bounding boxes are enlarged, check body bounding box
+            PhysicsBoundsData *bounds = &world->bounds[node->body->id];
+
+            if ((bounds->min.x <= max.x) && (bounds->max.x >= min.x) && (bounds->min.y <= max.y) && (bounds->max.y >= min.y)) bodies[count++] = node->body;
+        }
+        else
+        {
+            PushPhysicsTreeStack(&stack, node->children[0]);
+            PushPhysicsTreeStack(&stack, node->children[1]);
+        }
     }
 
-    // Update physics body grounded state if normal direction is down
-    if (!bodyA->isGrounded) bodyA->isGrounded = (manifold->normal.y < 0);
+    UnloadPhysicsTreeStack(&stack);
+
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return count;
 }
 
-// Solves collision between a circle to a polygon shape physics bodies
-static void SolveCircleToPolygon(PhysicsManifold manifold)
+// Writes bodies which shape contains a point into an array, returns bodies count
+PHYSACDEF int PhysicsQueryPoint(Vector2 point, PhysicsBody *bodies, int maxBodies)
 {
-    PhysicsBody bodyA = manifold->bodyA;
-    PhysicsBody bodyB = manifold->bodyB;
+    PhysicsWorldData *world = physicsWorld;
 
-    if ((bodyA == NULL) || (bodyB == NULL)) return;
+    if ((bodies == NULL) || (maxBodies <= 0)) return 0;
 
-    manifold->contactsCount = 0;
+    PHYSAC_LOCK_WORLD(world);
+    UpdatePhysicsTree();
 
-    // Transform circle center to polygon transform space
-    Vector2 center = bodyA->position;
-    center = Mat2MultiplyVector2(Mat2Transpose(bodyB->shape.transform), Vector2Subtract(center, bodyB->position));
+    int count = 0;
+    PhysicsTreeStack stack;
+    InitPhysicsTreeStack(&stack);
 
-    // Find edge with minimum penetration
-    // It is the same concept as using support points in SolvePolygonToPolygon
-    float separation = -PHYSAC_FLT_MAX;
-    int faceNormal = 0;
-    PolygonData vertexData = bodyB->shape.vertexData;
+    if (world->treeRoot != 0) PushPhysicsTreeStack(&stack, world->treeRoot);
 
-    for (int i = 0; i < vertexData.vertexCount; i++)
+    while ((stack.count > 0) && (count < maxBodies))
     {
-        float currentSeparation = MathDot(vertexData.normals[i], Vector2Subtract(center, vertexData.positions[i]));
+        PhysicsTreeNode *node = &world->treeNodes[stack.nodes[--stack.count]];
 
-        if (currentSeparation > bodyA->shape.radius) return;
+        if ((point.x < node->min.x) || (point.x > node->max.x) || (point.y < node->min.y) || (point.y > node->max.y)) continue;
 
-        if (currentSeparation > separation)
+        if (node->body != NULL)
         {
-            separation = currentSeparation;
-            faceNormal = i;
+            if (IsPhysicsBodyPoint(node->body, point)) bodies[count++] = node->body;
+        }
+        else
+        {
+            PushPhysicsTreeStack(&stack, node->children[0]);
+            PushPhysicsTreeStack(&stack, node->children[1]);
         }
     }
 
-    // Grab face's vertices
-    Vector2 v1 = vertexData.positions[faceNormal];
-    int nextIndex = (((faceNormal + 1) < vertexData.vertexCount) ? (faceNormal + 1) : 0);
-    Vector2 v2 = vertexData.positions[nextIndex];
+    UnloadPhysicsTreeStack(&stack);
 
-    // Check to see if center is within polygon
-    if (separation < PHYSAC_EPSILON)
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return count;
+}
+
+// Returns physics statistics of last step (times and counters require PHYSAC_STATS)
+// NOTE: Statistics are read from the world bound to calling thread, between steps (world mutex) if it runs a physics loop thread
+PHYSACDEF PhysicsStats GetPhysicsStats(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PHYSAC_LOCK_WORLD(world);
+
+    PhysicsStats stats = { 0 };
+
+#if defined(PHYSAC_STATS)
+    stats = world->stats;
+#endif
+    stats.usedMemory = world->usedMemory;
+    stats.stepsCount = world->stepsCount;
+    stats.maxIterations = world->solverIterations;
+    stats.timeDilation = world->timeDilation;
+    stats.droppedTime = world->droppedTime;
+
+    PHYSAC_UNLOCK_WORLD(world);
+
+    return stats;
+}
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------
+// Finds a valid index for a new physics body initialization
+// NOTE: Bodies pool grows when there is no available id, it returns -1 if pool can not grow
+static int FindAvailableBodyIndex()
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    int index = -1;
+
+    if ((world->freeIdsCount > 0) || GrowPhysicsBodies())
     {
-        manifold->contactsCount = 1;
-        Vector2 normal = Mat2MultiplyVector2(bodyB->shape.transform, vertexData.normals[faceNormal]);
-        manifold->normal = (Vector2){ -normal.x, -normal.y };
-        manifold->contacts[0] = (Vector2){ manifold->normal.x*bodyA->shape.radius + bodyA->position.x, manifold->normal.y*bodyA->shape.radius + bodyA->position.y };
-        manifold->penetration = bodyA->shape.radius;
-        return;
+        world->freeIdsCount--;
+        index = world->freeIds[world->freeIdsCount];
     }
 
-    // Determine which voronoi region of the edge center of circle lies within
-    float dot1 = MathDot(Vector2Subtract(center, v1), Vector2Subtract(v2, v1));
-    float dot2 = MathDot(Vector2Subtract(center, v2), Vector2Subtract(v1, v2));
-    manifold->penetration = bodyA->shape.radius - separation;
+    return index;
+}
 
-    if (dot1 <= 0.0f) // Closest to v1
+// Adds a new block to bodies pool, doubling bodies capacity
+// NOTE: Bodies are never moved once created, only bodies tracking arrays are reallocated
+static bool GrowPhysicsBodies(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (world->bodiesBlocksCount >= PHYSAC_MAX_BLOCKS) return false;
+
+    unsigned int blockSize = ((world->bodiesCapacity > 0) ? world->bodiesCapacity : PHYSAC_MAX_BODIES);
+    unsigned int newCapacity = world->bodiesCapacity + blockSize;
+
+    PhysicsBodyData *bodiesBlock = (PhysicsBodyData *)PHYSAC_MALLOC(blockSize*sizeof(PhysicsBodyData));
+    PolygonData *polygonsBlock = (PolygonData *)PHYSAC_MALLOC(blockSize*sizeof(PolygonData));
+    PhysicsBody *newBodies = (PhysicsBody *)PHYSAC_REALLOC(world->bodies, newCapacity*sizeof(PhysicsBody));
+    if (newBodies != NULL) world->bodies = newBodies;
+    unsigned int *newBodiesIndex = (unsigned int *)PHYSAC_REALLOC(world->bodiesIndex, newCapacity*sizeof(unsigned int));
+    if (newBodiesIndex != NULL) world->bodiesIndex = newBodiesIndex;
+    unsigned int *newFreeIds = (unsigned int *)PHYSAC_REALLOC(world->freeIds, newCapacity*sizeof(unsigned int));
+    if (newFreeIds != NULL) world->freeIds = newFreeIds;
+    PhysicsProxy *newProxies = (PhysicsProxy *)PHYSAC_REALLOC(world->proxies, newCapacity*sizeof(PhysicsProxy));
+    if (newProxies != NULL) world->proxies = newProxies;
+    PhysicsSleepData *newSleepData = (PhysicsSleepData *)PHYSAC_REALLOC(world->sleepData, newCapacity*sizeof(PhysicsSleepData));
+    if (newSleepData != NULL) world->sleepData = newSleepData;
+    PhysicsBoundsData *newBounds = (PhysicsBoundsData *)PHYSAC_REALLOC(world->bounds, newCapacity*sizeof(PhysicsBoundsData));
+    if (newBounds != NULL) world->bounds = newBounds;
+    unsigned int *newTreeLeaves = (unsigned int *)PHYSAC_REALLOC(world->treeLeaves, newCapacity*sizeof(unsigned int));
+    if (newTreeLeaves != NULL) world->treeLeaves = newTreeLeaves;
+    PhysicsPiecesData *newPieces = (PhysicsPiecesData *)PHYSAC_REALLOC(world->pieces, newCapacity*sizeof(PhysicsPiecesData));
+    if (newPieces != NULL) world->pieces = newPieces;
+
+    if ((bodiesBlock == NULL) || (polygonsBlock == NULL) || (newBodies == NULL) || (newBodiesIndex == NULL) || (newFreeIds == NULL) || (newProxies == NULL) ||
+        (newSleepData == NULL) || (newBounds == NULL) || (newTreeLeaves == NULL) || (newPieces == NULL))
     {
-        if (DistSqr(center, v1) > bodyA->shape.radius*bodyA->shape.radius) return;
+        PHYSAC_FREE(bodiesBlock);
+        PHYSAC_FREE(polygonsBlock);
 
-        manifold->contactsCount = 1;
-        Vector2 normal = Vector2Subtract(v1, center);
-        normal = Mat2MultiplyVector2(bodyB->shape.transform, normal);
-        MathNormalize(&normal);
-        manifold->normal = normal;
-        v1 = Mat2MultiplyVector2(bodyB->shape.transform, v1);
-        v1 = Vector2Add(v1, bodyB->position);
-        manifold->contacts[0] = v1;
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] bodies pool could not grow to %i bodies\n", newCapacity);
+        #endif
+
+        return false;
     }
-    else if (dot2 <= 0.0f) // Closest to v2
+
+    // Tracking arrays keep previous capacity until all of them are reallocated
+    world->usedMemory += blockSize*(sizeof(PhysicsBodyData) + sizeof(PolygonData) + sizeof(PhysicsBody) + 3*sizeof(unsigned int) + sizeof(PhysicsProxy) + sizeof(PhysicsSleepData) + sizeof(PhysicsBoundsData) + sizeof(PhysicsPiecesData));
+    PHYSAC_STATS_ADD(allocations, 1);
+
+    world->bodiesBlocks[world->bodiesBlocksCount] = bodiesBlock;
+    world->polygonsBlocks[world->bodiesBlocksCount] = polygonsBlock;
+    world->bodiesBlocksCount++;
+
+    // Stack new ids to be used in ascending order
+    for (int i = newCapacity - 1; i >= (int)world->bodiesCapacity; i--)
     {
-        if (DistSqr(center, v2) > bodyA->shape.radius*bodyA->shape.radius) return;
+        world->freeIds[world->freeIdsCount] = i;
+        world->freeIdsCount++;
+        world->treeLeaves[i] = 0;
+        world->pieces[i] = (PhysicsPiecesData){ 0 };
+        bodiesBlock[i - world->bodiesCapacity].generation = 0;
+    }
 
-        manifold->contactsCount = 1;
-        Vector2 normal = Vector2Subtract(v2, center);
-        v2 = Mat2MultiplyVector2(bodyB->shape.transform, v2);
-        v2 = Vector2Add(v2, bodyB->position);
-        manifold->contacts[0] = v2;
-        normal = Mat2MultiplyVector2(bodyB->shape.transform, normal);
-        MathNormalize(&normal);
-        manifold->normal = normal;
+    world->bodiesCapacity = newCapacity;
+
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] bodies pool capacity increased to %i bodies\n", world->bodiesCapacity);
+    #endif
+
+    return true;
+}
+
+// Reallocates manifolds pools, doubling manifolds capacity
+// NOTE: Previous step manifolds hash table is sized to keep its load factor under 1/2
+static bool GrowPhysicsManifolds(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int newCapacity = ((world->manifoldsCapacity > 0) ? 2*world->manifoldsCapacity : PHYSAC_MAX_MANIFOLDS);
+    unsigned int newTableSize = 1;
+    while (newTableSize < 2*newCapacity) newTableSize *= 2;
+
+    PhysicsManifoldData *newContacts = (PhysicsManifoldData *)PHYSAC_REALLOC(world->contacts, newCapacity*sizeof(PhysicsManifoldData));
+    if (newContacts != NULL) world->contacts = newContacts;
+    PhysicsManifoldData *newPreviousContacts = (PhysicsManifoldData *)PHYSAC_REALLOC(world->previousContacts, newCapacity*sizeof(PhysicsManifoldData));
+    if (newPreviousContacts != NULL) world->previousContacts = newPreviousContacts;
+    unsigned int *newTable = (unsigned int *)PHYSAC_MALLOC(newTableSize*sizeof(unsigned int));
+
+    if ((newContacts == NULL) || (newPreviousContacts == NULL) || (newTable == NULL))
+    {
+        PHYSAC_FREE(newTable);
+        return false;
     }
-    else // Closest to face
+
+    PHYSAC_FREE(world->manifoldsTable);
+    for (int i = 0; i < newTableSize; i++) newTable[i] = 0;
+
+    world->usedMemory += (newCapacity - world->manifoldsCapacity)*2*sizeof(PhysicsManifoldData) + (newTableSize - world->manifoldsTableSize)*sizeof(unsigned int);
+    PHYSAC_STATS_ADD(allocations, 1);
+    world->manifoldsTable = newTable;
+    world->manifoldsTableSize = newTableSize;
+    world->manifoldsCapacity = newCapacity;
+
+    // Index previous step manifolds again, so contacts matching does not depend on pool growth (restored states step the same)
+    for (int i = 0; i < world->previousManifoldsCount; i++)
     {
-        Vector2 normal = vertexData.normals[faceNormal];
+        unsigned int slot = HashPhysicsManifold(&world->previousContacts[i]);
 
-        if (MathDot(Vector2Subtract(center, v1), normal) > bodyA->shape.radius) return;
+        while (world->manifoldsTable[slot] != 0) slot = (slot + 1) & (world->manifoldsTableSize - 1);
 
-        normal = Mat2MultiplyVector2(bodyB->shape.transform, normal);
-        manifold->normal = (Vector2){ -normal.x, -normal.y };
-        manifold->contacts[0] = (Vector2){ manifold->normal.x*bodyA->shape.radius + bodyA->position.x, manifold->normal.y*bodyA->shape.radius + bodyA->position.y };
-        manifold->contactsCount = 1;
+        world->manifoldsTable[slot] = i + 1;
     }
+
+    return true;
 }
 
-// Solves collision between a polygon to a circle shape physics bodies
-static void SolvePolygonToCircle(PhysicsManifold manifold)
+// Frees bodies and manifolds pools dynamic memory
+static void ReleasePhysicsPools(void)
 {
-    PhysicsBody bodyA = manifold->bodyA;
-    PhysicsBody bodyB = manifold->bodyB;
+    PhysicsWorldData *world = physicsWorld;
+
+    for (int i = 0; i < world->bodiesCapacity; i++) ReleasePhysicsBodyPieces(i);
+
+    for (int i = 0; i < world->bodiesBlocksCount; i++)
+    {
+        PHYSAC_FREE(world->bodiesBlocks[i]);
+        PHYSAC_FREE(world->polygonsBlocks[i]);
+        world->bodiesBlocks[i] = NULL;
+        world->polygonsBlocks[i] = NULL;
+    }
+
+    PHYSAC_FREE(world->bodies);
+    PHYSAC_FREE(world->bodiesIndex);
+    PHYSAC_FREE(world->freeIds);
+    PHYSAC_FREE(world->proxies);
+    PHYSAC_FREE(world->sleepData);
+    PHYSAC_FREE(world->bounds);
+    PHYSAC_FREE(world->contacts);
+    PHYSAC_FREE(world->previousContacts);
+    PHYSAC_FREE(world->manifoldsTable);
+    PHYSAC_FREE(world->islandParents);
+    PHYSAC_FREE(world->islandKeys);
+    PHYSAC_FREE(world->islandManifolds);
+    PHYSAC_FREE(world->islandStarts);
+    PHYSAC_FREE(world->treeNodes);
+    PHYSAC_FREE(world->treeLeaves);
+    PHYSAC_FREE(world->pieces);
+    PHYSAC_FREE(world->fragments);
+    PHYSAC_FREE(world->touchingPairs.keys);
+    PHYSAC_FREE(world->previousTouchingPairs.keys);
+    PHYSAC_FREE(world->events);
+
+    for (int i = 0; i < 3; i++)
+    {
+        world->usedMemory -= world->snapshots[i].capacity*(sizeof(PhysicsBody) + 2*sizeof(PhysicsTransform) + 2*sizeof(unsigned int));
+
+        PHYSAC_FREE(world->snapshots[i].bodies);
+        PHYSAC_FREE(world->snapshots[i].generations);
+        PHYSAC_FREE(world->snapshots[i].previous);
+        PHYSAC_FREE(world->snapshots[i].current);
+        PHYSAC_FREE(world->snapshots[i].index);
+        world->snapshots[i] = (PhysicsSnapshot){ 0 };
+    }
+
+    world->snapshotBack = 0;
+    world->snapshotMiddle = 1;
+    world->snapshotFront = 2;
+    world->snapshotStarted = false;
+
+    world->bodies = NULL;
+    world->bodiesIndex = NULL;
+    world->freeIds = NULL;
+    world->proxies = NULL;
+    world->sleepData = NULL;
+    world->bounds = NULL;
+    world->contacts = NULL;
+    world->previousContacts = NULL;
+    world->manifoldsTable = NULL;
+    world->islandParents = NULL;
+    world->islandKeys = NULL;
+    world->islandManifolds = NULL;
+    world->islandStarts = NULL;
+    world->treeNodes = NULL;
+    world->treeLeaves = NULL;
+    world->pieces = NULL;
+    world->fragments = NULL;
+    world->events = NULL;
+    world->usedMemory -= world->bodiesCapacity*(sizeof(PhysicsBodyData) + sizeof(PolygonData) + sizeof(PhysicsBody) + 3*sizeof(unsigned int) + sizeof(PhysicsProxy) + sizeof(PhysicsSleepData) + sizeof(PhysicsBoundsData) + sizeof(PhysicsPiecesData));
+    world->usedMemory -= world->manifoldsCapacity*2*sizeof(PhysicsManifoldData) + world->manifoldsTableSize*sizeof(unsigned int);
+    world->usedMemory -= world->islandsCapacity*4*sizeof(unsigned int);
+    world->usedMemory -= world->treeNodesCapacity*sizeof(PhysicsTreeNode);
+    world->usedMemory -= world->fragmentsCapacity*sizeof(PhysicsFragmentData);
+    world->usedMemory -= (world->touchingPairs.capacity + world->previousTouchingPairs.capacity)*sizeof(uint64_t) + world->eventsCapacity*sizeof(PhysicsContactEvent);
+
+    world->bodiesBlocksCount = 0;
+    world->bodiesCapacity = 0;
+    world->freeIdsCount = 0;
+    world->physicsBodiesCount = 0;
+    world->manifoldsCapacity = 0;
+    world->physicsManifoldsCount = 0;
+    world->previousManifoldsCount = 0;
+    world->manifoldsTableSize = 0;
+    world->proxiesCount = 0;
+    world->proxiesDirty = true;
+    world->islandsCapacity = 0;
+    world->islandsCount = 0;
+    world->treeNodesCapacity = 0;
+    world->treeNodesCount = 0;
+    world->treeFreeNode = 0;
+    world->treeRoot = 0;
+    world->treeDirty = false;
+    world->fragmentsCapacity = 0;
+    world->fragmentsCount = 0;
+    world->fragmentsNext = 0;
+    world->touchingPairs = (PhysicsPairsData){ 0 };
+    world->previousTouchingPairs = (PhysicsPairsData){ 0 };
+    world->eventsCount = 0;
+    world->eventsCapacity = 0;
+}
+
+// Returns physics body slot of a body id in bodies pool blocks
+static PhysicsBody GetPhysicsBodySlot(unsigned int id)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int block = 0;
+    unsigned int base = 0;
+    unsigned int size = PHYSAC_MAX_BODIES;
+
+    while (id >= (base + size))
+    {
+        base += size;
+        size = base;        // Every block doubles pool capacity
+        block++;
+    }
+
+    return &world->bodiesBlocks[block][id - base];
+}
+
+// Returns polygon shape slot of a body id in polygons side table blocks
+static PolygonData *GetPolygonSlot(unsigned int id)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int block = 0;
+    unsigned int base = 0;
+    unsigned int size = PHYSAC_MAX_BODIES;
+
+    while (id >= (base + size))
+    {
+        base += size;
+        size = base;        // Every block doubles pool capacity
+        block++;
+    }
+
+    return &world->polygonsBlocks[block][id - base];
+}
+
+// Reserves compound shape pieces polygons of a body id, returns pieces polygons (NULL if they can not be allocated)
+// NOTE: Pieces polygons are only kept while body shape uses them, so a body using them gets its shape updated when they move
+static PolygonData *ReservePhysicsBodyPieces(unsigned int id, unsigned int count)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsPiecesData *pieces = &world->pieces[id];
+
+    if (pieces->capacity < count)
+    {
+        PolygonData *polygons = (PolygonData *)PHYSAC_REALLOC(pieces->polygons, count*sizeof(PolygonData));
+        if (polygons == NULL) return NULL;
+
+        if (pieces->polygons != NULL) GetPhysicsBodySlot(id)->shape.vertexData = polygons;
+
+        world->usedMemory += (count - pieces->capacity)*sizeof(PolygonData);
+        PHYSAC_STATS_ADD(allocations, 1);
+        pieces->polygons = polygons;
+        pieces->capacity = count;
+    }
+
+    return pieces->polygons;
+}
+
+// Frees compound shape pieces polygons of a body id
+static void ReleasePhysicsBodyPieces(unsigned int id)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsPiecesData *pieces = &world->pieces[id];
+
+    if (pieces->polygons != NULL)
+    {
+        PHYSAC_FREE(pieces->polygons);
+        world->usedMemory -= pieces->capacity*sizeof(PolygonData);
+        pieces->polygons = NULL;
+        pieces->capacity = 0;
+    }
+}
+
+// Removes a physics body from bodies pool, releasing its id (world mutex must be held)
+static void RemovePhysicsBody(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (body != NULL)
+    {
+        unsigned int id = body->id;
+        unsigned int index = ((id < world->bodiesCapacity) ? world->bodiesIndex[id] : world->physicsBodiesCount);
+
+        if ((index >= world->physicsBodiesCount) || (world->bodies[index] != body))
+        {
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] Not possible to find body id %i in pointers array\n", id);
+        #endif
+            return;     // Prevent releasing a body not in use
+        }
+
+        // Wake up sleeping bodies resting on destroyed body (sleeping bodies have no manifolds, find them by bounds)
+        WakeUpPhysicsBodiesAround(body);
+
+        // Move last body to released index to keep pointers array packed
+        world->physicsBodiesCount--;
+        world->bodies[index] = world->bodies[world->physicsBodiesCount];
+        world->bodiesIndex[world->bodies[index]->id] = index;
+        world->bodies[world->physicsBodiesCount] = NULL;
+
+        // Release body id to bodies pool, a new body in its slot does not match snapshots of destroyed body
+        world->freeIds[world->freeIdsCount] = id;
+        world->freeIdsCount++;
+        world->proxiesDirty = true;
+        body->generation++;
+
+        // Remove body from query tree, so queries never return destroyed bodies
+        if (world->treeLeaves[id] != 0)
+        {
+            RemovePhysicsTreeLeaf(world->treeLeaves[id]);
+            ReleasePhysicsTreeNode(world->treeLeaves[id]);
+            world->treeLeaves[id] = 0;
+        }
+
+        ReleasePhysicsBodyPieces(id);
+
+        // Forget touching pairs of destroyed body, so a new body reusing its id starts touching again
+        unsigned int touchingCount = 0;
+
+        for (int i = 0; i < world->touchingPairs.count; i++)
+        {
+            uint64_t key = world->touchingPairs.keys[i];
+
+            if (((unsigned int)(key >> 32) != id) && ((unsigned int)key != id))
+            {
+                world->touchingPairs.keys[touchingCount] = key;
+                touchingCount++;
+            }
+        }
+
+        world->touchingPairs.count = touchingCount;
+
+        // Drop last step manifolds of destroyed body, so a new body reusing its id does not start from their impulses
+        unsigned int manifoldsCount = 0;
+
+        for (int i = 0; i < world->physicsManifoldsCount; i++)
+        {
+            if ((world->contacts[i].bodyA != body) && (world->contacts[i].bodyB != body))
+            {
+                world->contacts[manifoldsCount] = world->contacts[i];
+                world->contacts[manifoldsCount].id = manifoldsCount;
+                manifoldsCount++;
+            }
+            else WakeUpPhysicsBody((world->contacts[i].bodyA == body) ? world->contacts[i].bodyB : world->contacts[i].bodyA);
+        }
+
+        world->physicsManifoldsCount = manifoldsCount;
+
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] destroyed physics body id %i\n", id);
+        #endif
+    }
+    #if defined(PHYSAC_DEBUG)
+        else printf("[PHYSAC] error trying to destroy a null referenced body\n");
+    #endif
+}
+
+// Creates a random polygon shape with max vertex distance from polygon pivot
+static PolygonData CreateRandomPolygon(float radius, int sides)
+{
+    PolygonData data = { 0 };
+    data.vertexCount = sides;
+
+    // Calculate polygon vertices positions
+    for (int i = 0; i < data.vertexCount; i++)
+    {
+        MathSinCos(360.0f/sides*i*PHYSAC_DEG2RAD, &data.positions[i].y, &data.positions[i].x);
+        data.positions[i].x *= radius;
+        data.positions[i].y *= radius;
+    }
+
+    // Calculate polygon faces normals
+    for (int i = 0; i < data.vertexCount; i++)
+    {
+        int nextIndex = (((i + 1) < sides) ? (i + 1) : 0);
+        Vector2 face = Vector2Subtract(data.positions[nextIndex], data.positions[i]);
+
+        data.normals[i] = (Vector2){ face.y, -face.x };
+        MathNormalize(&data.normals[i]);
+    }
+
+    return data;
+}
+
+// Creates a rectangle polygon shape based on a min and max positions
+static PolygonData CreateRectanglePolygon(Vector2 pos, Vector2 size)
+{
+    PolygonData data = { 0 };
+    data.vertexCount = 4;
+
+    // Calculate polygon vertices positions
+    data.positions[0] = (Vector2){ pos.x + size.x/2, pos.y - size.y/2 };
+    data.positions[1] = (Vector2){ pos.x + size.x/2, pos.y + size.y/2 };
+    data.positions[2] = (Vector2){ pos.x - size.x/2, pos.y + size.y/2 };
+    data.positions[3] = (Vector2){ pos.x - size.x/2, pos.y - size.y/2 };
+
+    // Calculate polygon faces normals
+    for (int i = 0; i < data.vertexCount; i++)
+    {
+        int nextIndex = (((i + 1) < data.vertexCount) ? (i + 1) : 0);
+        Vector2 face = Vector2Subtract(data.positions[nextIndex], data.positions[i]);
+
+        data.normals[i] = (Vector2){ face.y, -face.x };
+        MathNormalize(&data.normals[i]);
+    }
+
+    return data;
+}
+
+// Creates a convex polygon shape from the convex hull of a vertices set, returns false if hull has no area
+// NOTE: Monotone chain hull over vertices sorted by x, hulls over PHYSAC_MAX_VERTICES vertices are simplified removing
+// the vertices which triangle with their neighbours has the smallest area (hull only shrinks a little)
+static bool CreateHullPolygon(const Vector2 *vertices, int count, PolygonData *data)
+{
+    if ((vertices == NULL) || (count < 3)) return false;
+
+    Vector2 *sorted = (Vector2 *)PHYSAC_MALLOC(3*count*sizeof(Vector2));
+    if (sorted == NULL) return false;
+
+    Vector2 *hull = &sorted[count];     // Hull requires up to two vertices per sorted vertex while it is built
+    int hullCount = 0;
+
+    for (int i = 0; i < count; i++) sorted[i] = vertices[i];
+    qsort(sorted, count, sizeof(Vector2), CompareHullVertices);
+
+    // Lower hull from left to right and upper hull from right to left, keeping only counter clockwise turns
+    for (int i = 0; i < count; i++)
+    {
+        while ((hullCount >= 2) && (MathCrossVector2(Vector2Subtract(hull[hullCount - 1], hull[hullCount - 2]), Vector2Subtract(sorted[i], hull[hullCount - 2])) <= 0.0f)) hullCount--;
+        hull[hullCount++] = sorted[i];
+    }
+
+    for (int i = count - 2, lowerCount = hullCount + 1; i >= 0; i--)
+    {
+        while ((hullCount >= lowerCount) && (MathCrossVector2(Vector2Subtract(hull[hullCount - 1], hull[hullCount - 2]), Vector2Subtract(sorted[i], hull[hullCount - 2])) <= 0.0f)) hullCount--;
+        hull[hullCount++] = sorted[i];
+    }
+
+    hullCount--;        // Last vertex closes the hull (it is the first vertex)
+
+    while (hullCount > PHYSAC_MAX_VERTICES)
+    {
+        int removed = 0;
+        float minArea = PHYSAC_FLT_MAX;
+
+        for (int i = 0; i < hullCount; i++)
+        {
+            Vector2 previous = hull[(i + hullCount - 1)%hullCount];
+            Vector2 next = hull[(i + 1)%hullCount];
+            float area = MathCrossVector2(Vector2Subtract(hull[i], previous), Vector2Subtract(next, previous));
+
+            if (area < minArea)
+            {
+                minArea = area;
+                removed = i;
+            }
+        }
+
+        hullCount--;
+        for (int i = removed; i < hullCount; i++) hull[i] = hull[i + 1];
+    }
+
+    bool valid = (hullCount >= 3);
+
+    if (valid)
+    {
+        data->vertexCount = hullCount;
+
+        for (int i = 0; i < hullCount; i++) data->positions[i] = hull[i];
+
+        // Calculate polygon faces normals
+        for (int i = 0; i < data->vertexCount; i++)
+        {
+            int nextIndex = (((i + 1) < data->vertexCount) ? (i + 1) : 0);
+            Vector2 face = Vector2Subtract(data->positions[nextIndex], data->positions[i]);
+
+            data->normals[i] = (Vector2){ face.y, -face.x };
+            MathNormalize(&data->normals[i]);
+        }
+    }
+
+    PHYSAC_FREE(sorted);
+
+    return valid;
+}
+
+// Compares two vertices by x and then by y (used by qsort)
+static int CompareHullVertices(const void *a, const void *b)
+{
+    const Vector2 *vertexA = (const Vector2 *)a;
+    const Vector2 *vertexB = (const Vector2 *)b;
+
+    if (vertexA->x != vertexB->x) return ((vertexA->x < vertexB->x) ? -1 : 1);
+    else if (vertexA->y != vertexB->y) return ((vertexA->y < vertexB->y) ? -1 : 1);
+    else return 0;
+}
+
+// Computes mass and inertia of a physics body polygon shape, returns centroid moved to shape pivot
+// NOTE: Shape pieces vertices are translated to make the centroid (0, 0) in model space, so body rotates around its
+// center of mass, and inertia is computed around it. Body position is not changed
+static Vector2 ComputePhysicsBodyMass(PhysicsBody body, float density)
+{
+    Vector2 center = { 0.0f, 0.0f };
+    float area = 0.0f;
+    float inertia = 0.0f;
+
+    // Calculate area weighted centroid of all pieces
+    for (int i = 0; i < body->shape.piecesCount; i++)
+    {
+        PolygonData *vertexData = &body->shape.vertexData[i];
+
+        for (int j = 0; j < vertexData->vertexCount; j++)
+        {
+            // Triangle vertices, third vertex implied as (0, 0)
+            Vector2 p1 = vertexData->positions[j];
+            int nextIndex = (((j + 1) < vertexData->vertexCount) ? (j + 1) : 0);
+            Vector2 p2 = vertexData->positions[nextIndex];
+
+            float triangleArea = MathCrossVector2(p1, p2)/2;
+
+            area += triangleArea;
+
+            // Use area to weight the centroid average, not just vertex position
+            center.x += triangleArea*PHYSAC_K*(p1.x + p2.x);
+            center.y += triangleArea*PHYSAC_K*(p1.y + p2.y);
+        }
+    }
+
+    center.x *= 1.0f/area;
+    center.y *= 1.0f/area;
+
+    // Translate vertices to centroid and calculate moment of inertia around it
+    for (int i = 0; i < body->shape.piecesCount; i++)
+    {
+        PolygonData *vertexData = &body->shape.vertexData[i];
+
+        for (int j = 0; j < vertexData->vertexCount; j++) vertexData->positions[j] = Vector2Subtract(vertexData->positions[j], center);
+
+        for (int j = 0; j < vertexData->vertexCount; j++)
+        {
+            Vector2 p1 = vertexData->positions[j];
+            int nextIndex = (((j + 1) < vertexData->vertexCount) ? (j + 1) : 0);
+            Vector2 p2 = vertexData->positions[nextIndex];
+
+            float D = MathCrossVector2(p1, p2);
+            float intx2 = p1.x*p1.x + p2.x*p1.x + p2.x*p2.x;
+            float inty2 = p1.y*p1.y + p2.y*p1.y + p2.y*p2.y;
+            inertia += (0.25f*PHYSAC_K*D)*(intx2 + inty2);
+        }
+    }
+
+    body->mass = density*area;
+    body->inverseMass = ((body->mass != 0.0f) ? 1.0f/body->mass : 0.0f);
+    body->inertia = density*inertia;
+    body->inverseInertia = ((body->inertia != 0.0f) ? 1.0f/body->inertia : 0.0f);
+
+    return center;
+}
+
+// Returns the max distance from body position to its shape vertices
+static float ComputePhysicsBodyRadius(PhysicsBody body)
+{
+    float radius = body->shape.radius;
+
+    if (body->shape.type == PHYSICS_POLYGON)
+    {
+        for (int i = 0; i < body->shape.piecesCount; i++)
+        {
+            PolygonData *vertexData = &body->shape.vertexData[i];
+
+            for (int j = 0; j < vertexData->vertexCount; j++) radius = max(radius, sqrtf(MathLenSqr(vertexData->positions[j])));
+        }
+    }
+
+    return radius;
+}
+
+// Computes bounding circle radius and bounding box of a new physics body shape
+// NOTE: Shapes never change after body creation, so bounding circle radius is only computed once
+static void InitPhysicsBodyBounds(PhysicsBody body)
+{
+    PhysicsBoundsData *bounds = &physicsWorld->bounds[body->id];
+
+    bounds->radius = ComputePhysicsBodyRadius(body);
+    ComputePhysicsBodyAABB(body, &bounds->min, &bounds->max);
+    bounds->position = body->position;
+    bounds->rotation = (Vector2){ body->shape.transform.m00, body->shape.transform.m10 };
+}
+
+// Computes bounding box of a physics body again if it moved since last update, returns body bounds
+// NOTE: Static and sleeping bodies keep their bounding box, bodies moved by hand are detected by their position and rotation
+static PhysicsBoundsData *UpdatePhysicsBodyBounds(PhysicsBody body)
+{
+    PhysicsBoundsData *bounds = &physicsWorld->bounds[body->id];
+
+    if ((bounds->position.x != body->position.x) || (bounds->position.y != body->position.y) ||
+        (bounds->rotation.x != body->shape.transform.m00) || (bounds->rotation.y != body->shape.transform.m10))
+    {
+        ComputePhysicsBodyAABB(body, &bounds->min, &bounds->max);
+        bounds->position = body->position;
+        bounds->rotation = (Vector2){ body->shape.transform.m00, body->shape.transform.m10 };
+    }
+
+    return bounds;
+}
+
+// Returns model space position of a polygon shape vertex (compound shapes vertices are numbered piece after piece)
+static Vector2 GetPolygonVertex(PhysicsShape shape, int vertex)
+{
+    PolygonData *vertexData = shape.vertexData;
+
+    for (int i = 1; (i < shape.piecesCount) && (vertex >= vertexData->vertexCount); i++)
+    {
+        vertex -= vertexData->vertexCount;
+        vertexData++;
+    }
+
+    return vertexData->positions[vertex];
+}
+
+// Reserves shatter fragments queue for a fragments count, returns false if it can not grow
+// NOTE: Spawned fragments slots are reused once every queued fragment is spawned
+static bool ReservePhysicsFragments(unsigned int count)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (world->fragmentsCapacity < count)
+    {
+        unsigned int newCapacity = ((world->fragmentsCapacity > 0) ? 2*world->fragmentsCapacity : PHYSAC_MAX_VERTICES);
+        while (newCapacity < count) newCapacity *= 2;
+
+        PhysicsFragmentData *newFragments = (PhysicsFragmentData *)PHYSAC_REALLOC(world->fragments, newCapacity*sizeof(PhysicsFragmentData));
+        if (newFragments == NULL) return false;
+
+        world->usedMemory += (newCapacity - world->fragmentsCapacity)*sizeof(PhysicsFragmentData);
+        PHYSAC_STATS_ADD(allocations, 1);
+        world->fragments = newFragments;
+        world->fragmentsCapacity = newCapacity;
+    }
+
+    return true;
+}
+
+// Creates a new triangle physics body from a shatter fragment
+// NOTE: Fragment shape and mass data are already computed, only body generic values are initialized
+static PhysicsBody CreatePhysicsBodyFragment(const PhysicsFragmentData *fragment)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsBody newBody = NULL;
+
+    int newId = FindAvailableBodyIndex();
+    if (newId != -1)
+    {
+        // Initialize new body from bodies pool with fragment values
+        newBody = GetPhysicsBodySlot(newId);
+        newBody->id = newId;
+        newBody->enabled = true;
+        newBody->position = fragment->position;
+        newBody->velocity = PHYSAC_VECTOR_ZERO;
+        newBody->force = PHYSAC_VECTOR_ZERO;
+        newBody->angularVelocity = 0.0f;
+        newBody->torque = 0.0f;
+        newBody->orient = 0.0f;
+        newBody->shape.type = PHYSICS_POLYGON;
+        newBody->shape.body = newBody;
+        newBody->shape.radius = 0.0f;
+        newBody->shape.transform = fragment->transform;
+        newBody->shape.vertexData = GetPolygonSlot(newId);
+        newBody->shape.vertexData->vertexCount = 3;
+        newBody->shape.piecesCount = 1;
+
+        for (int i = 0; i < 3; i++)
+        {
+            newBody->shape.vertexData->positions[i] = fragment->positions[i];
+            newBody->shape.vertexData->normals[i] = fragment->normals[i];
+        }
+
+        newBody->mass = fragment->mass;
+        newBody->inverseMass = ((newBody->mass != 0.0f) ? 1.0f/newBody->mass : 0.0f);
+        newBody->inertia = fragment->inertia;
+        newBody->inverseInertia = ((newBody->inertia != 0.0f) ? 1.0f/newBody->inertia : 0.0f);
+        newBody->staticFriction = 0.4f;
+        newBody->dynamicFriction = 0.2f;
+        newBody->restitution = 0.0f;
+        newBody->useGravity = true;
+        newBody->isGrounded = false;
+        newBody->isSleeping = false;
+        newBody->freezeOrient = false;
+        newBody->isBullet = false;
+        newBody->isSensor = fragment->isSensor;
+        newBody->categoryBits = fragment->categoryBits;
+        newBody->maskBits = fragment->maskBits;
+        world->sleepData[newId].restTime = 0.0f;
+        InitPhysicsBodyBounds(newBody);
+
+        // Add new body to bodies pointers array and update bodies count
+        world->bodies[world->physicsBodiesCount] = newBody;
+        world->bodiesIndex[newId] = world->physicsBodiesCount;
+        world->physicsBodiesCount++;
+        world->proxiesDirty = true;
+        world->treeDirty = true;
+    }
+    #if defined(PHYSAC_DEBUG)
+        else printf("[PHYSAC] shatter fragment creation failed because there is any available id to use\n");
+    #endif
+
+    return newBody;
+}
+
+// Spawns queued shatter fragments until shatter time budget is spent
+// NOTE: At least one fragment is spawned every call, fragments are spawned in shatter order
+static void SpawnPhysicsFragments(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    double startTime = ((world->shatterBudget > 0.0) ? GetCurrentTime() : 0.0);
+
+    while (world->fragmentsNext < world->fragmentsCount)
+    {
+        PhysicsFragmentData *fragment = &world->fragments[world->fragmentsNext];
+        world->fragmentsNext++;
+
+        // New fragment is awake, so explosion force is set directly (world mutex is already held)
+        PhysicsBody newBody = CreatePhysicsBodyFragment(fragment);
+        if (newBody != NULL) newBody->force = fragment->force;
+
+        if ((world->shatterBudget > 0.0) && ((GetCurrentTime() - startTime) >= world->shatterBudget)) break;
+    }
+
+    // Reuse fragments queue once every fragment is spawned
+    if (world->fragmentsNext == world->fragmentsCount)
+    {
+        world->fragmentsNext = 0;
+        world->fragmentsCount = 0;
+    }
+}
+
+// Physics loop thread function
+static void *PhysicsLoop(void *arg)
+{
+#if !defined(PHYSAC_NO_THREADS)
+    // Bind physics world of the thread that initialized physics
+    PhysicsWorldData *world = (PhysicsWorldData *)arg;
+    physicsWorld = world;
+
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] physics thread created successfully\n");
+    #endif
+
+    // Physics update loop
+    while (world->physicsThreadEnabled)
+    {
+        RunPhysicsStep();
+
+        // Sleep until next step deadline, time accumulated after last update is already waited
+        double waitTime = world->deltaTime - world->accumulator - (GetCurrentTime() - world->startTime);
+        if (waitTime > 0.0) WaitTime(waitTime);
+    }
+#endif
+
+    return NULL;
+}
+
+#if !defined(PHYSAC_NO_THREADS)
+// Sleeps current thread for a time in milliseconds
+static void WaitTime(double ms)
+{
+#if defined(_WIN32)
+    Sleep((unsigned long)ms);
+#elif defined(__linux__) || defined(__APPLE__) || defined(__EMSCRIPTEN__)
+    struct timespec req = { 0 };
+    time_t sec = (time_t)(ms/1000.0);
+    req.tv_sec = sec;
+    req.tv_nsec = (long)((ms - sec*1000.0)*1000000.0);
+
+    // NOTE: Sleep is resumed if it is interrupted by a signal
+    while (nanosleep(&req, &req) == -1) continue;
+#endif
+}
+#endif
+
+// Reserves snapshot arrays for current bodies capacity
+// NOTE: Only back buffer is reserved, other buffers can be in use by render thread
+static bool ReservePhysicsSnapshot(PhysicsSnapshot *snapshot)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (snapshot->capacity < world->bodiesCapacity)
+    {
+        PhysicsBody *newBodies = (PhysicsBody *)PHYSAC_REALLOC(snapshot->bodies, world->bodiesCapacity*sizeof(PhysicsBody));
+        if (newBodies != NULL) snapshot->bodies = newBodies;
+        unsigned int *newGenerations = (unsigned int *)PHYSAC_REALLOC(snapshot->generations, world->bodiesCapacity*sizeof(unsigned int));
+        if (newGenerations != NULL) snapshot->generations = newGenerations;
+        PhysicsTransform *newPrevious = (PhysicsTransform *)PHYSAC_REALLOC(snapshot->previous, world->bodiesCapacity*sizeof(PhysicsTransform));
+        if (newPrevious != NULL) snapshot->previous = newPrevious;
+        PhysicsTransform *newCurrent = (PhysicsTransform *)PHYSAC_REALLOC(snapshot->current, world->bodiesCapacity*sizeof(PhysicsTransform));
+        if (newCurrent != NULL) snapshot->current = newCurrent;
+        unsigned int *newIndex = (unsigned int *)PHYSAC_REALLOC(snapshot->index, world->bodiesCapacity*sizeof(unsigned int));
+        if (newIndex != NULL) snapshot->index = newIndex;
+
+        if ((newBodies == NULL) || (newGenerations == NULL) || (newPrevious == NULL) || (newCurrent == NULL) || (newIndex == NULL)) return false;
+
+        world->usedMemory += (world->bodiesCapacity - snapshot->capacity)*(sizeof(PhysicsBody) + 2*sizeof(PhysicsTransform) + 2*sizeof(unsigned int));
+        PHYSAC_STATS_ADD(allocations, 1);
+        snapshot->capacity = world->bodiesCapacity;
+    }
+
+    return true;
+}
+
+// Stores bodies transforms before last step of current update in snapshot back buffer
+static void BeginPhysicsSnapshot(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsSnapshot *snapshot = &world->snapshots[world->snapshotBack];
+    world->snapshotStarted = ReservePhysicsSnapshot(snapshot);
+
+    if (world->snapshotStarted)
+    {
+        for (int i = 0; i < world->physicsBodiesCount; i++)
+        {
+            snapshot->bodies[i] = world->bodies[i];
+            snapshot->generations[i] = world->bodies[i]->generation;
+            snapshot->previous[i] = (PhysicsTransform){ world->bodies[i]->position, world->bodies[i]->orient };
+        }
+
+        snapshot->count = world->physicsBodiesCount;
+    }
+}
+
+// Stores bodies transforms after last step in snapshot back buffer and publishes it
+static void PublishPhysicsSnapshot(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (!world->snapshotStarted) return;
+
+    PhysicsSnapshot *snapshot = &world->snapshots[world->snapshotBack];
+
+    for (int i = 0; i < snapshot->count; i++)
+    {
+        PhysicsBody body = snapshot->bodies[i];
+
+        snapshot->current[i] = (PhysicsTransform){ body->position, body->orient };
+        snapshot->index[body->id] = i;
+    }
+
+    snapshot->time = world->currentTime - world->accumulator;
+    world->snapshotStarted = false;
+
+    // Exchange back buffer with published buffer, render thread takes it on next UpdatePhysicsSnapshot()
+    world->snapshotBack = PHYSAC_ATOMIC_EXCHANGE(&world->snapshotMiddle, world->snapshotBack | PHYSAC_SNAPSHOT_FRESH) & ~PHYSAC_SNAPSHOT_FRESH;
+}
+
+// Returns a physics body transform between two transforms (alpha 0 to 1)
+static PhysicsTransform InterpolatePhysicsTransform(PhysicsTransform previous, PhysicsTransform current, float alpha)
+{
+    PhysicsTransform transform = { 0 };
+
+    transform.position.x = previous.position.x + (current.position.x - previous.position.x)*alpha;
+    transform.position.y = previous.position.y + (current.position.y - previous.position.y)*alpha;
+    transform.orient = previous.orient + (current.orient - previous.orient)*alpha;
+
+    return transform;
+}
+
+// Physics steps calculations (dynamics, collisions and position corrections)
+static void PhysicsStep(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    // Update current steps count
+    world->stepsCount++;
+
+#if defined(PHYSAC_STATS)
+    // Reset last step statistics, pools allocations are counted from step start
+    double stepStart = GetCurrentTime();
+
+    for (int i = 0; i < PHYSICS_PHASE_COUNT; i++) world->stats.phaseTime[i] = 0.0;
+    world->stats.pairsCount = 0;
+    world->stats.manifoldsCount = 0;
+    world->stats.contactsCount = 0;
+    world->stats.islandsCount = 0;
+    world->stats.solverIterations = 0;
+    world->stats.allocations = 0;
+#endif
+
+    // Spawn shatter fragments queued under shatter time budget
+    if (world->fragmentsNext < world->fragmentsCount) SpawnPhysicsFragments();
+
+    // Keep previous generated collisions information to warm start matching manifolds
+    SwapPhysicsManifolds();
+
+    // Keep previous step touching pairs to report contact events
+    PhysicsPairsData swapPairs = world->previousTouchingPairs;
+    world->previousTouchingPairs = world->touchingPairs;
+    world->touchingPairs = swapPairs;
+    world->touchingPairs.count = 0;
+
+    // Reset physics bodies grounded state and wake up sleeping bodies moved by user
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+
+        if (body->isSleeping)
+        {
+            PhysicsSleepData *sleep = &world->sleepData[body->id];
+
+            bool moved = ((body->position.x != sleep->position.x) || (body->position.y != sleep->position.y) || (body->orient != sleep->orient) ||
+                          (body->velocity.x != 0.0f) || (body->velocity.y != 0.0f) || (body->angularVelocity != 0.0f));
+
+            if (!moved) continue;       // Sleeping bodies keep their grounded state
+
+            WakeUpPhysicsBody(body);
+        }
+
+        body->isGrounded = false;
+    }
+
+    // Generate new collision information for broad-phase overlapping pairs
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_BROAD);
+    UpdatePhysicsBroadPhase();
+    PHYSAC_PHASE_END(PHYSICS_PHASE_BROAD);
+    PHYSAC_STATS_ADD(pairsCount, world->physicsManifoldsCount);
+
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_NARROW);
+    UpdatePhysicsNarrowPhase();
+    PHYSAC_PHASE_END(PHYSICS_PHASE_NARROW);
+
+#if defined(PHYSAC_STATS)
+    world->stats.manifoldsCount = world->physicsManifoldsCount;
+    for (int i = 0; i < world->physicsManifoldsCount; i++) world->stats.contactsCount += world->contacts[i].contactsCount;
+#endif
+
+    // Integrate forces to physics bodies
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_INTEGRATE);
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+        if (body != NULL) IntegratePhysicsForces(body);
+    }
+    PHYSAC_PHASE_END(PHYSICS_PHASE_INTEGRATE);
+
+    // Initialize physics manifolds to solve collisions
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_SOLVE);
+    for (int i = 0; i < world->physicsManifoldsCount; i++) InitializePhysicsManifolds(&world->contacts[i]);
+
+    // Integrate physics collisions impulses to solve collisions, grouped by contact islands
+    bool islandsBuilt = BuildPhysicsIslands();
+
+    if (islandsBuilt)
+    {
+        SolvePhysicsIslands();
+        PHYSAC_STATS_ADD(islandsCount, world->islandsCount);
+    }
+    else
+    {
+        // Contact islands could not be allocated, solve all manifolds together
+        for (int i = 0; i < world->solverIterations; i++)
+        {
+            float maxChange = 0.0f;
+
+            for (int j = 0; j < world->physicsManifoldsCount; j++) maxChange = max(maxChange, IntegratePhysicsImpulses(&world->contacts[j]));
+            PHYSAC_STATS_ADD(solverIterations, 1);
+
+            if (maxChange < world->solverTolerance) break;
+        }
+    }
+    PHYSAC_PHASE_END(PHYSICS_PHASE_SOLVE);
+
+    // Integrate velocity to physics bodies
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_INTEGRATE);
+    int bulletsCount = 0;
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+        if (body == NULL) continue;
+
+        if (body->isBullet) bulletsCount++;
+        else IntegratePhysicsVelocity(body);
+    }
+
+    // Integrate bullet bodies velocity once the rest of bodies reached their new positions
+    // NOTE: Bullets find bodies in their motion through query tree, updated once here for all of them
+    if (bulletsCount > 0)
+    {
+        world->treeDirty = true;
+        UpdatePhysicsTree();
+
+        for (int i = 0; i < world->physicsBodiesCount; i++)
+        {
+            PhysicsBody body = world->bodies[i];
+            if ((body != NULL) && body->isBullet) IntegratePhysicsBullet(body);
+        }
+    }
+    PHYSAC_PHASE_END(PHYSICS_PHASE_INTEGRATE);
+
+    // Correct physics bodies positions based on manifolds collision information
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_CORRECT);
+    for (int i = 0; i < world->physicsManifoldsCount; i++) CorrectPhysicsPositions(&world->contacts[i]);
+    PHYSAC_PHASE_END(PHYSICS_PHASE_CORRECT);
+
+    // Put to sleep resting contact islands (it requires contact islands information)
+    PHYSAC_PHASE_BEGIN(PHYSICS_PHASE_INTEGRATE);
+    if (islandsBuilt) UpdatePhysicsSleeping();
+
+    // Clear physics bodies forces and update bounds of moved bodies (read by callers and next step broad-phase)
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+        if (body != NULL)
+        {
+            body->force = PHYSAC_VECTOR_ZERO;
+            body->torque = 0.0f;
+            UpdatePhysicsBodyBounds(body);
+        }
+    }
+
+    world->treeDirty = true;
+    PHYSAC_PHASE_END(PHYSICS_PHASE_INTEGRATE);
+
+#if defined(PHYSAC_STATS)
+    world->stats.stepTime = GetCurrentTime() - stepStart;
+#endif
+}
+
+// Updates broad-phase proxies bounds and order and creates overlapping pairs manifolds
+// NOTE: Proxies are kept sorted by bounding box minimum x between steps (sort and sweep),
+// bodies move a little every step so insertion sort runs almost in linear time
+static void UpdatePhysicsBroadPhase(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    // Rebuild proxies array if physics bodies were created or destroyed
+    if (world->proxiesDirty)
+    {
+        world->proxiesCount = 0;
+
+        for (int i = 0; i < world->physicsBodiesCount; i++)
+        {
+            if (world->bodies[i] != NULL)
+            {
+                PhysicsBoundsData *bounds = UpdatePhysicsBodyBounds(world->bodies[i]);
+
+                world->proxies[world->proxiesCount].body = world->bodies[i];
+                world->proxies[world->proxiesCount].min = bounds->min;
+                world->proxies[world->proxiesCount].max = bounds->max;
+                world->proxiesCount++;
+            }
+        }
+
+        qsort(world->proxies, world->proxiesCount, sizeof(PhysicsProxy), CompareProxies);
+        world->proxiesDirty = false;
+    }
+    else
+    {
+        // Update proxies bounds and restore order with insertion sort
+        for (int i = 0; i < world->proxiesCount; i++)
+        {
+            PhysicsProxy proxy = world->proxies[i];
+            PhysicsBoundsData *bounds = UpdatePhysicsBodyBounds(proxy.body);
+            proxy.min = bounds->min;
+            proxy.max = bounds->max;
+
+            int j = i - 1;
+            while ((j >= 0) && (world->proxies[j].min.x > proxy.min.x))
+            {
+                world->proxies[j + 1] = world->proxies[j];
+                j--;
+            }
+
+            world->proxies[j + 1] = proxy;
+        }
+    }
+
+    // Sweep sorted proxies, only pairs overlapping in both axis get a manifold for narrow phase
+    for (int i = 0; i < world->proxiesCount; i++)
+    {
+        PhysicsProxy *proxyA = &world->proxies[i];
+
+        for (int j = i + 1; (j < world->proxiesCount) && (world->proxies[j].min.x <= proxyA->max.x); j++)
+        {
+            PhysicsProxy *proxyB = &world->proxies[j];
+
+            if ((proxyB->min.y > proxyA->max.y) || (proxyB->max.y < proxyA->min.y)) continue;
+            if (!CanPhysicsBodiesCollide(proxyA->body, proxyB->body)) continue;
+
+            // Static and sleeping bodies never collide between them, but sensors keep detecting them
+            if (!IsPhysicsBodyAwake(proxyA->body) && !IsPhysicsBodyAwake(proxyB->body) && !proxyA->body->isSensor && !proxyB->body->isSensor) continue;
+
+            // Keep pair bodies order by id, independent of proxies order
+            if (proxyA->body->id < proxyB->body->id) CreatePhysicsPiecesManifolds(proxyA->body, proxyB->body);
+            else CreatePhysicsPiecesManifolds(proxyB->body, proxyA->body);
+        }
+    }
+}
+
+// Computes world space bounding box of a physics body shape
+static void ComputePhysicsBodyAABB(PhysicsBody body, Vector2 *min, Vector2 *max)
+{
+    ComputePhysicsPieceAABB(body, 0, min, max);
+
+    // Compound shapes bounding box contains every piece bounding box
+    for (int i = 1; i < body->shape.piecesCount; i++)
+    {
+        Vector2 pieceMin = PHYSAC_VECTOR_ZERO;
+        Vector2 pieceMax = PHYSAC_VECTOR_ZERO;
+        ComputePhysicsPieceAABB(body, i, &pieceMin, &pieceMax);
+
+        min->x = min(min->x, pieceMin.x);
+        min->y = min(min->y, pieceMin.y);
+        max->x = max(max->x, pieceMax.x);
+        max->y = max(max->y, pieceMax.y);
+    }
+}
+
+// Computes world space bounding box of a physics body shape piece
+static void ComputePhysicsPieceAABB(PhysicsBody body, unsigned int piece, Vector2 *min, Vector2 *max)
+{
+    if (body->shape.type == PHYSICS_CIRCLE)
+    {
+        *min = (Vector2){ body->position.x - body->shape.radius, body->position.y - body->shape.radius };
+        *max = (Vector2){ body->position.x + body->shape.radius, body->position.y + body->shape.radius };
+    }
+    else
+    {
+        PolygonData *vertexData = &body->shape.vertexData[piece];
+
+        *min = (Vector2){ PHYSAC_FLT_MAX, PHYSAC_FLT_MAX };
+        *max = (Vector2){ -PHYSAC_FLT_MAX, -PHYSAC_FLT_MAX };
+
+        for (int i = 0; i < vertexData->vertexCount; i++)
+        {
+            Vector2 vertex = Mat2MultiplyVector2(body->shape.transform, vertexData->positions[i]);
+
+            min->x = min(min->x, vertex.x);
+            min->y = min(min->y, vertex.y);
+            max->x = max(max->x, vertex.x);
+            max->y = max(max->y, vertex.y);
+        }
+
+        *min = Vector2Add(*min, body->position);
+        *max = Vector2Add(*max, body->position);
+    }
+}
+
+// Compares two broad-phase proxies by bounding box minimum x (used by qsort)
+static int CompareProxies(const void *a, const void *b)
+{
+    const PhysicsProxy *proxyA = (const PhysicsProxy *)a;
+    const PhysicsProxy *proxyB = (const PhysicsProxy *)b;
+
+    if (proxyA->min.x < proxyB->min.x) return -1;
+    else if (proxyA->min.x > proxyB->min.x) return 1;
+    else return ((int)proxyA->body->id - (int)proxyB->body->id);
+}
+
+// Solves broad-phase pairs manifolds and keeps only the ones in contact
+// NOTE: Manifolds in contact are compacted to the start of manifolds pool keeping broad-phase order
+static void UpdatePhysicsNarrowPhase(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    int count = 0;
+
+    for (int i = 0; i < world->physicsManifoldsCount; i++)
+    {
+        PhysicsManifold manifold = &world->contacts[i];
+
+        SolvePhysicsManifold(manifold);
+
+        if (manifold->contactsCount == 0) continue;
+
+        // Sensor overlaps are only tracked to report contact events, they get no collision response
+        bool isSensor = (manifold->bodyA->isSensor || manifold->bodyB->isSensor);
+
+        if (isSensor || world->contactEvents) AddPhysicsTouchingPair(manifold->bodyA, manifold->bodyB);
+        if (isSensor) continue;
+
+        if (i != count)
+        {
+            world->contacts[count] = *manifold;
+            manifold = &world->contacts[count];
+            manifold->id = count;
+        }
+
+        MatchPhysicsManifold(manifold);
+
+        // Sleeping bodies are woken up by awake bodies touching them
+        if (manifold->bodyA->isSleeping) WakeUpPhysicsBody(manifold->bodyA);
+        if (manifold->bodyB->isSleeping) WakeUpPhysicsBody(manifold->bodyB);
+
+        count++;
+    }
+
+    world->physicsManifoldsCount = count;
+
+    UpdatePhysicsContactEvents();
+}
+
+// Wrapper to ensure PhysicsStep is run with at a fixed time step
+PHYSACDEF void RunPhysicsStep(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    // Bodies pools do not change while steps run (API calls from other threads wait for them)
+    PHYSAC_LOCK_WORLD(world);
+
+    // Calculate current time
+    world->currentTime = GetCurrentTime();
+
+    // Calculate current delta time
+    const double delta = world->currentTime - world->startTime;
+
+    // Store the time elapsed since the last frame began
+    world->accumulator += delta;
+
+#if defined(PHYSAC_STATS)
+    world->stats.updateSteps = 0;
+#endif
+
+    // Contact events are reported for every step of this call
+    world->eventsCount = 0;
+
+    // Average time between calls, stalls count at most twice the average so they do not raise expected steps
+    if (world->averageDelta <= 0.0) world->averageDelta = delta;
+    else world->averageDelta += (min(delta, 2.0*world->averageDelta) - world->averageDelta)*0.1;
+
+    // Lower contact solver iterations while catching up, so pending steps fit the solver work of max steps (or the steps
+    // expected per call, one more to absorb timing jitter, without max steps)
+    int pendingSteps = (int)(world->accumulator/world->deltaTime);
+    int expectedSteps = (int)ceil(world->averageDelta/world->deltaTime) + 1;
+    int maxSteps = world->maxSteps;
+    int stepsLimit = ((maxSteps > 0) ? maxSteps : expectedSteps);
+
+    world->solverIterations = PHYSAC_COLLISION_ITERATIONS;
+
+    if (world->adaptiveIterations && (pendingSteps > stepsLimit))
+    {
+        world->solverIterations = max(PHYSAC_ADAPTIVE_ITERATIONS, stepsLimit*PHYSAC_COLLISION_ITERATIONS/pendingSteps);
+        if (maxSteps > 0) maxSteps = stepsLimit*PHYSAC_COLLISION_ITERATIONS/world->solverIterations;
+    }
+
+    // Drop simulation time of steps over max steps (time dilation), partial step time is kept to interpolate snapshot
+    double droppedTime = 0.0;
+
+    if ((maxSteps > 0) && (pendingSteps > maxSteps))
+    {
+        droppedTime = (pendingSteps - maxSteps)*world->deltaTime;
+        world->accumulator -= droppedTime;
+        world->droppedTime += droppedTime;
+
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] physics steps over max steps dropped (%i steps)\n", pendingSteps - maxSteps);
+        #endif
+    }
+
+    world->timeDilation = ((delta > 0.0) ? (float)((delta - droppedTime)/delta) : 1.0f);
+
+    // Fixed time stepping loop
+    while (world->accumulator >= world->deltaTime)
+    {
+#ifdef PHYSAC_DEBUG
+        //printf("currentTime %f, startTime %f, accumulator-pre %f, accumulator-post %f, delta %f, deltaTime %f\n",
+        //       currentTime, startTime, accumulator, accumulator-deltaTime, delta, deltaTime);
+#endif
+        // Store bodies transforms before last step to interpolate published snapshot
+        if (world->accumulator < 2.0*world->deltaTime) BeginPhysicsSnapshot();
+
+        PhysicsStep();
+        world->accumulator -= world->deltaTime;
+        PHYSAC_STATS_ADD(updateSteps, 1);
+    }
+
+    PublishPhysicsSnapshot();
+
+#if defined(PHYSAC_STATS)
+    world->stats.updateTime = GetCurrentTime() - world->currentTime;
+#endif
+
+    // Record the starting of this frame
+    world->startTime = world->currentTime;
+
+    PHYSAC_UNLOCK_WORLD(world);
+}
+
+PHYSACDEF void SetPhysicsTimeStep(double delta)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    world->deltaTime = delta;
+}
+
+// Sets max physics steps run by a RunPhysicsStep() call, time over them is dropped (0 for no limit)
+// NOTE: Dropped time slows down simulation (time dilation) instead of freezing next frames to catch up after a stall
+PHYSACDEF void SetPhysicsMaxSteps(int steps)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    world->maxSteps = ((steps > 0) ? steps : 0);
+}
+
+// Sets contact solver iterations lowered while RunPhysicsStep() catches up, before dropping time
+// NOTE: Pending steps share the solver iterations of max steps (steps expected from average time between calls without
+// max steps), down to PHYSAC_ADAPTIVE_ITERATIONS. Calls running their usual steps keep all iterations
+PHYSACDEF void SetPhysicsAdaptiveIterations(bool enabled)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    world->adaptiveIterations = enabled;
+}
+
+// Creates a new physics manifold from manifolds pool to solve collision
+// NOTE: Manifolds pool is reset every step, it returns NULL if pool can not grow
+static PhysicsManifold CreatePhysicsManifold(PhysicsBody a, PhysicsBody b, unsigned int pieceA, unsigned int pieceB)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsManifold newManifold = NULL;
+
+    if ((world->physicsManifoldsCount < world->manifoldsCapacity) || GrowPhysicsManifolds())
+    {
+        // Initialize new manifold with generic values
+        newManifold = &world->contacts[world->physicsManifoldsCount];
+        newManifold->id = world->physicsManifoldsCount;
+        newManifold->bodyA = a;
+        newManifold->bodyB = b;
+        newManifold->pieceA = pieceA;
+        newManifold->pieceB = pieceB;
+        newManifold->penetration = 0;
+        newManifold->normal = PHYSAC_VECTOR_ZERO;
+        newManifold->contacts[0] = PHYSAC_VECTOR_ZERO;
+        newManifold->contacts[1] = PHYSAC_VECTOR_ZERO;
+        newManifold->contactsIds[0] = 0;
+        newManifold->contactsIds[1] = 0;
+        newManifold->contactsCount = 0;
+        newManifold->normalImpulses[0] = 0.0f;
+        newManifold->normalImpulses[1] = 0.0f;
+        newManifold->tangentImpulses[0] = 0.0f;
+        newManifold->tangentImpulses[1] = 0.0f;
+        newManifold->restitution = 0.0f;
+        newManifold->dynamicFriction = 0.0f;
+        newManifold->staticFriction = 0.0f;
+
+        // Update manifolds pool count
+        world->physicsManifoldsCount++;
+    }
+    #if defined(PHYSAC_DEBUG)
+        else printf("[PHYSAC] new physics manifold creation failed because manifolds pool could not grow\n");
+    #endif
+
+    return newManifold;
+}
+
+// Creates a physics manifold for every pieces pair of two bodies which bounding boxes overlap
+// NOTE: Single polygon shapes pair only requires one manifold (broad-phase already checked their bounding boxes)
+static void CreatePhysicsPiecesManifolds(PhysicsBody a, PhysicsBody b)
+{
+    if ((a->shape.piecesCount == 1) && (b->shape.piecesCount == 1))
+    {
+        CreatePhysicsManifold(a, b, 0, 0);
+        return;
+    }
+
+    Vector2 minA = PHYSAC_VECTOR_ZERO;
+    Vector2 maxA = PHYSAC_VECTOR_ZERO;
+    Vector2 minB = physicsWorld->bounds[b->id].min;     // Updated by broad-phase
+    Vector2 maxB = physicsWorld->bounds[b->id].max;
+
+    for (int i = 0; i < a->shape.piecesCount; i++)
+    {
+        ComputePhysicsPieceAABB(a, i, &minA, &maxA);
+
+        if ((minA.x > maxB.x) || (maxA.x < minB.x) || (minA.y > maxB.y) || (maxA.y < minB.y)) continue;
+
+        for (int j = 0; j < b->shape.piecesCount; j++)
+        {
+            Vector2 pieceMin = minB;
+            Vector2 pieceMax = maxB;
+            if (b->shape.piecesCount > 1) ComputePhysicsPieceAABB(b, j, &pieceMin, &pieceMax);
+
+            if ((minA.x > pieceMax.x) || (maxA.x < pieceMin.x) || (minA.y > pieceMax.y) || (maxA.y < pieceMin.y)) continue;
+
+            if (CreatePhysicsManifold(a, b, i, j) == NULL) return;
+        }
+    }
+}
+
+// Returns true if two bodies collision filters accept each other (sensors never detect other sensors)
+static bool CanPhysicsBodiesCollide(PhysicsBody a, PhysicsBody b)
+{
+    if (a->isSensor && b->isSensor) return false;
+
+    return (((a->categoryBits & b->maskBits) != 0) && ((b->categoryBits & a->maskBits) != 0));
+}
+
+// Adds a touching bodies pair to current step touching pairs (first body has lower id)
+// NOTE: Compound shapes pieces manifolds of a bodies pair are consecutive, so the pair is only added once
+static void AddPhysicsTouchingPair(PhysicsBody a, PhysicsBody b)
+{
+    PhysicsWorldData *world = physicsWorld;
+    PhysicsPairsData *pairs = &world->touchingPairs;
+
+    uint64_t key = ((uint64_t)a->id << 32) | b->id;
+
+    if ((pairs->count > 0) && (pairs->keys[pairs->count - 1] == key)) return;
+
+    if (pairs->count == pairs->capacity)
+    {
+        unsigned int newCapacity = ((pairs->capacity > 0) ? 2*pairs->capacity : PHYSAC_MAX_BODIES);
+
+        uint64_t *newKeys = (uint64_t *)PHYSAC_REALLOC(pairs->keys, newCapacity*sizeof(uint64_t));
+
+        if (newKeys == NULL)
+        {
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] touching pair of bodies id %i and %i discarded because touching pairs array could not grow\n", a->id, b->id);
+        #endif
+            return;
+        }
+
+        world->usedMemory += (newCapacity - pairs->capacity)*sizeof(uint64_t);
+        PHYSAC_STATS_ADD(allocations, 1);
+        pairs->keys = newKeys;
+        pairs->capacity = newCapacity;
+    }
+
+    pairs->keys[pairs->count] = key;
+    pairs->count++;
+}
+
+// Compares two touching bodies pairs keys (used by qsort)
+static int CompareTouchingPairs(const void *a, const void *b)
+{
+    uint64_t keyA = *(const uint64_t *)a;
+    uint64_t keyB = *(const uint64_t *)b;
+
+    return ((keyA > keyB) - (keyA < keyB));
+}
+
+// Reports touching pairs starting or stopping touching since previous step as contact events
+// NOTE: Resting pairs of static and sleeping bodies are not tested by broad-phase, so they keep touching until a body wakes up
+static void UpdatePhysicsContactEvents(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if ((world->touchingPairs.count == 0) && (world->previousTouchingPairs.count == 0)) return;
+
+    qsort(world->touchingPairs.keys, world->touchingPairs.count, sizeof(uint64_t), CompareTouchingPairs);
+
+    // Carry over resting pairs of previous step not tested by broad-phase
+    unsigned int testedCount = world->touchingPairs.count;
+
+    for (unsigned int i = 0, j = 0; i < world->previousTouchingPairs.count; i++)
+    {
+        uint64_t key = world->previousTouchingPairs.keys[i];
+
+        while ((j < testedCount) && (world->touchingPairs.keys[j] < key)) j++;
+
+        if ((j < testedCount) && (world->touchingPairs.keys[j] == key)) continue;
+
+        PhysicsBody bodyA = GetPhysicsBodySlot((unsigned int)(key >> 32));
+        PhysicsBody bodyB = GetPhysicsBodySlot((unsigned int)key);
+
+        if (world->contactEvents && !bodyA->isSensor && !bodyB->isSensor && !IsPhysicsBodyAwake(bodyA) && !IsPhysicsBodyAwake(bodyB)) AddPhysicsTouchingPair(bodyA, bodyB);
+    }
+
+    if (world->touchingPairs.count > testedCount) qsort(world->touchingPairs.keys, world->touchingPairs.count, sizeof(uint64_t), CompareTouchingPairs);
+
+    // Merge both sorted pairs arrays, pairs only in current step begin touching and pairs only in previous step end touching
+    PhysicsPairsData *current = &world->touchingPairs;
+    PhysicsPairsData *previous = &world->previousTouchingPairs;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    while ((i < previous->count) || (j < current->count))
+    {
+        if ((j == current->count) || ((i < previous->count) && (previous->keys[i] < current->keys[j])))
+        {
+            AddPhysicsContactEvent(PHYSICS_CONTACT_END, previous->keys[i]);
+            i++;
+        }
+        else if ((i == previous->count) || (current->keys[j] < previous->keys[i]))
+        {
+            AddPhysicsContactEvent(PHYSICS_CONTACT_BEGIN, current->keys[j]);
+            j++;
+        }
+        else
+        {
+            i++;
+            j++;
+        }
+    }
+}
+
+// Adds a contact event of a touching bodies pair key to contact events array
+static void AddPhysicsContactEvent(PhysicsContactEventType type, uint64_t key)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (world->eventsCount == world->eventsCapacity)
+    {
+        unsigned int newCapacity = ((world->eventsCapacity > 0) ? 2*world->eventsCapacity : PHYSAC_MAX_BODIES);
+
+        PhysicsContactEvent *newEvents = (PhysicsContactEvent *)PHYSAC_REALLOC(world->events, newCapacity*sizeof(PhysicsContactEvent));
+
+        if (newEvents == NULL)
+        {
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] contact event discarded because contact events array could not grow\n");
+        #endif
+            return;
+        }
+
+        world->usedMemory += (newCapacity - world->eventsCapacity)*sizeof(PhysicsContactEvent);
+        PHYSAC_STATS_ADD(allocations, 1);
+        world->events = newEvents;
+        world->eventsCapacity = newCapacity;
+    }
+
+    PhysicsContactEvent *event = &world->events[world->eventsCount];
+    event->type = type;
+    event->bodyA = GetPhysicsBodySlot((unsigned int)(key >> 32));
+    event->bodyB = GetPhysicsBodySlot((unsigned int)key);
+    event->isSensor = (event->bodyA->isSensor || event->bodyB->isSensor);
+    world->eventsCount++;
+}
+
+// Swaps manifolds pools and indexes previous step manifolds by bodies pair
+static void SwapPhysicsManifolds(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    ClearPhysicsManifoldsTable();
+
+    PhysicsManifoldData *swap = world->previousContacts;
+    world->previousContacts = world->contacts;
+    world->contacts = swap;
+    world->previousManifoldsCount = world->physicsManifoldsCount;
+    world->physicsManifoldsCount = 0;
+
+    // Index current step manifolds, they are matched by next step manifolds (linear probing)
+    for (int i = 0; i < world->previousManifoldsCount; i++)
+    {
+        unsigned int slot = HashPhysicsManifold(&world->previousContacts[i]);
+
+        while (world->manifoldsTable[slot] != 0) slot = (slot + 1) & (world->manifoldsTableSize - 1);
+
+        world->manifoldsTable[slot] = i + 1;
+    }
+}
+
+// Clears previous step manifolds from hash table and discards them
+static void ClearPhysicsManifoldsTable(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    for (int i = 0; i < world->previousManifoldsCount; i++)
+    {
+        unsigned int slot = HashPhysicsManifold(&world->previousContacts[i]);
+
+        while (world->manifoldsTable[slot] != 0)
+        {
+            world->manifoldsTable[slot] = 0;
+            slot = (slot + 1) & (world->manifoldsTableSize - 1);
+        }
+    }
+
+    world->previousManifoldsCount = 0;
+}
+
+// Returns manifolds hash table slot of a manifold bodies and pieces pair
+static unsigned int HashPhysicsManifold(PhysicsManifold manifold)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int hash = (manifold->bodyA->id*2654435761u) ^ (manifold->bodyB->id*2246822519u) ^ ((manifold->pieceA ^ (manifold->pieceB << 16))*3266489917u);
+
+    return ((hash ^ (hash >> 16)) & (world->manifoldsTableSize - 1));
+}
+
+// Copies accumulated impulses of matching previous step contacts to a new manifold
+// NOTE: Contacts are matched by bodies pair (and pieces pair) and contact feature id, unmatched contacts start from zero impulses
+static void MatchPhysicsManifold(PhysicsManifold manifold)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int slot = HashPhysicsManifold(manifold);
+
+    while (world->manifoldsTable[slot] != 0)
+    {
+        PhysicsManifold previous = &world->previousContacts[world->manifoldsTable[slot] - 1];
+
+        if ((previous->bodyA == manifold->bodyA) && (previous->bodyB == manifold->bodyB) && (previous->pieceA == manifold->pieceA) && (previous->pieceB == manifold->pieceB))
+        {
+            for (int i = 0; i < manifold->contactsCount; i++)
+            {
+                for (int j = 0; j < previous->contactsCount; j++)
+                {
+                    if (manifold->contactsIds[i] == previous->contactsIds[j])
+                    {
+                        manifold->normalImpulses[i] = previous->normalImpulses[j];
+                        manifold->tangentImpulses[i] = previous->tangentImpulses[j];
+                        break;
+                    }
+                }
+            }
+
+            break;
+        }
+
+        slot = (slot + 1) & (world->manifoldsTableSize - 1);
+    }
+}
+
+// Solves a created physics manifold between two physics bodies
+static void SolvePhysicsManifold(PhysicsManifold manifold)
+{
+    // Bodies which bounding circles do not overlap can not touch, skip shapes separating axis tests
+    float radius = physicsWorld->bounds[manifold->bodyA->id].radius + physicsWorld->bounds[manifold->bodyB->id].radius;
+
+    if (DistSqr(manifold->bodyA->position, manifold->bodyB->position) > radius*radius) return;
+
+    switch (manifold->bodyA->shape.type)
+    {
+        case PHYSICS_CIRCLE:
+        {
+            switch (manifold->bodyB->shape.type)
+            {
+                case PHYSICS_CIRCLE: SolveCircleToCircle(manifold); break;
+                case PHYSICS_POLYGON: SolveCircleToPolygon(manifold); break;
+                default: break;
+            }
+        } break;
+        case PHYSICS_POLYGON:
+        {
+            switch (manifold->bodyB->shape.type)
+            {
+                case PHYSICS_CIRCLE: SolvePolygonToCircle(manifold); break;
+                case PHYSICS_POLYGON: SolvePolygonToPolygon(manifold); break;
+                default: break;
+            }
+        } break;
+        default: break;
+    }
+
+    // Update physics body grounded state of the upper body if grounded state is not set yet in previous manifolds
+    // NOTE: Normal points from body A to body B, so body B is over body A when normal direction is up
+    if ((manifold->contactsCount > 0) && !manifold->bodyA->isSensor && !manifold->bodyB->isSensor)
+    {
+        if (!manifold->bodyB->isGrounded) manifold->bodyB->isGrounded = (manifold->normal.y < 0);
+        if (!manifold->bodyA->isGrounded) manifold->bodyA->isGrounded = (manifold->normal.y > 0);
+    }
+}
+
+// Solves collision between two circle shape physics bodies
+static void SolveCircleToCircle(PhysicsManifold manifold)
+{
+    PhysicsBody bodyA = manifold->bodyA;
+    PhysicsBody bodyB = manifold->bodyB;
+
+    if ((bodyA == NULL) || (bodyB == NULL)) return;
+
+    // Calculate translational vector, which is normal
+    Vector2 normal = Vector2Subtract(bodyB->position, bodyA->position);
+
+    float distSqr = MathLenSqr(normal);
+    float radius = bodyA->shape.radius + bodyB->shape.radius;
+
+    // Check if circles are not in contact
+    if (distSqr >= radius*radius)
+    {
+        manifold->contactsCount = 0;
+        return;
+    }
+
+    float distance = sqrtf(distSqr);
+    manifold->contactsCount = 1;
+
+    if (distance == 0.0f)
+    {
+        manifold->penetration = bodyA->shape.radius;
+        manifold->normal = (Vector2){ 1.0f, 0.0f };
+        manifold->contacts[0] = bodyA->position;
+    }
+    else
+    {
+        manifold->penetration = radius - distance;
+        manifold->normal = (Vector2){ normal.x/distance, normal.y/distance }; // Faster than using MathNormalize() due to sqrt is already performed
+        manifold->contacts[0] = (Vector2){ manifold->normal.x*bodyA->shape.radius + bodyA->position.x, manifold->normal.y*bodyA->shape.radius + bodyA->position.y };
+    }
+}
+
+// Solves collision between a circle to a polygon shape physics bodies
+static void SolveCircleToPolygon(PhysicsManifold manifold)
+{
+    PhysicsBody bodyA = manifold->bodyA;
+    PhysicsBody bodyB = manifold->bodyB;
+
+    if ((bodyA == NULL) || (bodyB == NULL)) return;
+
+    manifold->contactsCount = 0;
+
+    // Transform circle center to polygon transform space
+    Vector2 center = bodyA->position;
+    center = Mat2MultiplyVector2(Mat2Transpose(bodyB->shape.transform), Vector2Subtract(center, bodyB->position));
+
+    // Find edge with minimum penetration
+    // It is the same concept as using support points in SolvePolygonToPolygon
+    float separation = -PHYSAC_FLT_MAX;
+    int faceNormal = 0;
+    PolygonData *vertexData = &bodyB->shape.vertexData[manifold->pieceB];
+
+    for (int i = 0; i < vertexData->vertexCount; i++)
+    {
+        float currentSeparation = MathDot(vertexData->normals[i], Vector2Subtract(center, vertexData->positions[i]));
+
+        if (currentSeparation > bodyA->shape.radius) return;
+
+        if (currentSeparation > separation)
+        {
+            separation = currentSeparation;
+            faceNormal = i;
+        }
+    }
+
+    // Grab face's vertices
+    Vector2 v1 = vertexData->positions[faceNormal];
+    int nextIndex = (((faceNormal + 1) < vertexData->vertexCount) ? (faceNormal + 1) : 0);
+    Vector2 v2 = vertexData->positions[nextIndex];
+
+    // Check to see if center is within polygon
+    if (separation < PHYSAC_EPSILON)
+    {
+        manifold->contactsCount = 1;
+        Vector2 normal = Mat2MultiplyVector2(bodyB->shape.transform, vertexData->normals[faceNormal]);
+        manifold->normal = (Vector2){ -normal.x, -normal.y };
+        manifold->contacts[0] = (Vector2){ manifold->normal.x*bodyA->shape.radius + bodyA->position.x, manifold->normal.y*bodyA->shape.radius + bodyA->position.y };
+        manifold->contactsIds[0] = faceNormal;
+        manifold->penetration = bodyA->shape.radius;
+        return;
+    }
+
+    // Determine which voronoi region of the edge center of circle lies within
+    float dot1 = MathDot(Vector2Subtract(center, v1), Vector2Subtract(v2, v1));
+    float dot2 = MathDot(Vector2Subtract(center, v2), Vector2Subtract(v1, v2));
+    manifold->penetration = bodyA->shape.radius - separation;
+
+    if (dot1 <= 0.0f) // Closest to v1
+    {
+        if (DistSqr(center, v1) > bodyA->shape.radius*bodyA->shape.radius) return;
+
+        manifold->contactsCount = 1;
+        Vector2 normal = Vector2Subtract(v1, center);
+        normal = Mat2MultiplyVector2(bodyB->shape.transform, normal);
+        MathNormalize(&normal);
+        manifold->normal = normal;
+        v1 = Mat2MultiplyVector2(bodyB->shape.transform, v1);
+        v1 = Vector2Add(v1, bodyB->position);
+        manifold->contacts[0] = v1;
+        manifold->contactsIds[0] = 0x100 | faceNormal;     // Vertex feature
+    }
+    else if (dot2 <= 0.0f) // Closest to v2
+    {
+        if (DistSqr(center, v2) > bodyA->shape.radius*bodyA->shape.radius) return;
+
+        manifold->contactsCount = 1;
+        Vector2 normal = Vector2Subtract(v2, center);
+        v2 = Mat2MultiplyVector2(bodyB->shape.transform, v2);
+        v2 = Vector2Add(v2, bodyB->position);
+        manifold->contacts[0] = v2;
+        manifold->contactsIds[0] = 0x100 | nextIndex;      // Vertex feature
+        normal = Mat2MultiplyVector2(bodyB->shape.transform, normal);
+        MathNormalize(&normal);
+        manifold->normal = normal;
+    }
+    else // Closest to face
+    {
+        Vector2 normal = vertexData->normals[faceNormal];
+
+        if (MathDot(Vector2Subtract(center, v1), normal) > bodyA->shape.radius) return;
+
+        normal = Mat2MultiplyVector2(bodyB->shape.transform, normal);
+        manifold->normal = (Vector2){ -normal.x, -normal.y };
+        manifold->contacts[0] = (Vector2){ manifold->normal.x*bodyA->shape.radius + bodyA->position.x, manifold->normal.y*bodyA->shape.radius + bodyA->position.y };
+        manifold->contactsIds[0] = faceNormal;
+        manifold->contactsCount = 1;
+    }
+}
+
+// Solves collision between a polygon to a circle shape physics bodies
+static void SolvePolygonToCircle(PhysicsManifold manifold)
+{
+    PhysicsBody bodyA = manifold->bodyA;
+    PhysicsBody bodyB = manifold->bodyB;
+
+    if ((bodyA == NULL) || (bodyB == NULL)) return;
+
+    unsigned int pieceA = manifold->pieceA;
+    unsigned int pieceB = manifold->pieceB;
+
+    manifold->bodyA = bodyB;
+    manifold->bodyB = bodyA;
+    manifold->pieceA = pieceB;
+    manifold->pieceB = pieceA;
+    SolveCircleToPolygon(manifold);
+
+    // Restore bodies order, normal must point from polygon to circle
+    manifold->bodyA = bodyA;
+    manifold->bodyB = bodyB;
+    manifold->pieceA = pieceA;
+    manifold->pieceB = pieceB;
+    manifold->normal.x *= -1.0f;
+    manifold->normal.y *= -1.0f;
+}
+
+// Solves collision between two polygons shape physics bodies
+static void SolvePolygonToPolygon(PhysicsManifold manifold)
+{
+    if ((manifold->bodyA == NULL) || (manifold->bodyB == NULL)) return;
+
+    PhysicsShape bodyA = manifold->bodyA->shape;
+    PhysicsShape bodyB = manifold->bodyB->shape;
+    bodyA.vertexData = &manifold->bodyA->shape.vertexData[manifold->pieceA];
+    bodyB.vertexData = &manifold->bodyB->shape.vertexData[manifold->pieceB];
+    manifold->contactsCount = 0;
+
+    // Check for separating axis with A shape's face planes
+    int faceA = 0;
+    float penetrationA = FindAxisLeastPenetration(&faceA, bodyA, bodyB);
+    if (penetrationA >= 0.0f) return;
+
+    // Check for separating axis with B shape's face planes
+    int faceB = 0;
+    float penetrationB = FindAxisLeastPenetration(&faceB, bodyB, bodyA);
+    if (penetrationB >= 0.0f) return;
+
+    int referenceIndex = 0;
+    bool flip = false;  // Always point from A shape to B shape
+
+    PhysicsShape refPoly; // Reference
+    PhysicsShape incPoly; // Incident
+
+    // Determine which shape contains reference face
+    if (BiasGreaterThan(penetrationA, penetrationB))
+    {
+        refPoly = bodyA;
+        incPoly = bodyB;
+        referenceIndex = faceA;
+    }
+    else
+    {
+        refPoly = bodyB;
+        incPoly = bodyA;
+        referenceIndex = faceB;
+        flip = true;
+    }
+
+    // Contact features identifiers are keyed by reference face (used to match contacts between steps)
+    unsigned int referenceFeature = ((flip ? 0x10000 : 0) | (referenceIndex << 8));
+
+    // World space incident face
+    PhysicsClipVertex incidentFace[2];
+    FindIncidentFace(&incidentFace[0], &incidentFace[1], refPoly, incPoly, referenceIndex);
+
+    // Setup reference face vertices
+    PolygonData *refData = refPoly.vertexData;
+    Vector2 v1 = refData->positions[referenceIndex];
+    referenceIndex = (((referenceIndex + 1) < refData->vertexCount) ? (referenceIndex + 1) : 0);
+    Vector2 v2 = refData->positions[referenceIndex];
+
+    // Transform vertices to world space
+    v1 = Mat2MultiplyVector2(refPoly.transform, v1);
+    v1 = Vector2Add(v1, refPoly.body->position);
+    v2 = Mat2MultiplyVector2(refPoly.transform, v2);
+    v2 = Vector2Add(v2, refPoly.body->position);
+
+    // Calculate reference face side normal in world space
+    Vector2 sidePlaneNormal = Vector2Subtract(v2, v1);
+    MathNormalize(&sidePlaneNormal);
+
+    // Orthogonalize
+    Vector2 refFaceNormal = { sidePlaneNormal.y, -sidePlaneNormal.x };
+    float refC = MathDot(refFaceNormal, v1);
+    float negSide = MathDot(sidePlaneNormal, v1)*-1;
+    float posSide = MathDot(sidePlaneNormal, v2);
+
+    // Clip incident face to reference face side planes (due to floating point error, possible to not have required points
+    if (Clip((Vector2){ -sidePlaneNormal.x, -sidePlaneNormal.y }, negSide, &incidentFace[0], &incidentFace[1], 0x80) < 2) return;
+    if (Clip(sidePlaneNormal, posSide, &incidentFace[0], &incidentFace[1], 0x81) < 2) return;
+
+    // Flip normal if required
+    manifold->normal = (flip ? (Vector2){ -refFaceNormal.x, -refFaceNormal.y } : refFaceNormal);
+
+    // Keep points behind reference face
+    int currentPoint = 0; // Clipped points behind reference face
+    float separation = MathDot(refFaceNormal, incidentFace[0].position) - refC;
+    if (separation <= 0.0f)
+    {
+        manifold->contacts[currentPoint] = incidentFace[0].position;
+        manifold->contactsIds[currentPoint] = referenceFeature | incidentFace[0].feature;
+        manifold->penetration = -separation;
+        currentPoint++;
+    }
+    else manifold->penetration = 0.0f;
+
+    separation = MathDot(refFaceNormal, incidentFace[1].position) - refC;
+
+    if (separation <= 0.0f)
+    {
+        manifold->contacts[currentPoint] = incidentFace[1].position;
+        manifold->contactsIds[currentPoint] = referenceFeature | incidentFace[1].feature;
+        manifold->penetration += -separation;
+        currentPoint++;
+
+        // Calculate total penetration average
+        manifold->penetration /= currentPoint;
+    }
+
+    manifold->contactsCount = currentPoint;
+}
+
+// Integrates physics forces into velocity
+static void IntegratePhysicsForces(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if ((body == NULL) || (body->inverseMass == 0.0f) || !body->enabled || body->isSleeping) return;
+
+    body->velocity.x += (body->force.x*body->inverseMass)*(world->deltaTime/2.0);
+    body->velocity.y += (body->force.y*body->inverseMass)*(world->deltaTime/2.0);
+
+    if (body->useGravity)
+    {
+        body->velocity.x += world->gravityForce.x*(world->deltaTime/1000/2.0);
+        body->velocity.y += world->gravityForce.y*(world->deltaTime/1000/2.0);
+    }
+
+    if (!body->freezeOrient) body->angularVelocity += body->torque*body->inverseInertia*(world->deltaTime/2.0);
+}
+
+// Initializes physics manifolds to solve collisions
+static void InitializePhysicsManifolds(PhysicsManifold manifold)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsBody bodyA = manifold->bodyA;
+    PhysicsBody bodyB = manifold->bodyB;
+
+    if ((bodyA == NULL) || (bodyB == NULL)) return;
+
+    // Calculate average restitution, static and dynamic friction
+    manifold->restitution = sqrtf(bodyA->restitution*bodyB->restitution);
+    manifold->staticFriction = sqrtf(bodyA->staticFriction*bodyB->staticFriction);
+    manifold->dynamicFriction = sqrtf(bodyA->dynamicFriction*bodyB->dynamicFriction);
+
+    for (int i = 0; i < manifold->contactsCount; i++)
+    {
+        // Caculate radius from center of mass to contact
+        Vector2 radiusA = Vector2Subtract(manifold->contacts[i], bodyA->position);
+        Vector2 radiusB = Vector2Subtract(manifold->contacts[i], bodyB->position);
+
+        Vector2 crossA = MathCross(bodyA->angularVelocity, radiusA);
+        Vector2 crossB = MathCross(bodyB->angularVelocity, radiusB);
+
+        Vector2 radiusV = { 0.0f, 0.0f };
+        radiusV.x = bodyB->velocity.x + crossB.x - bodyA->velocity.x - crossA.x;
+        radiusV.y = bodyB->velocity.y + crossB.y - bodyA->velocity.y - crossA.y;
+
+        // Determine if we should perform a resting collision or not;
+        // The idea is if the only thing moving this object is gravity, then the collision should be performed without any restitution
+        if (MathLenSqr(radiusV) < (MathLenSqr((Vector2){ world->gravityForce.x*world->deltaTime/1000, world->gravityForce.y*world->deltaTime/1000 }) + PHYSAC_EPSILON)) manifold->restitution = 0;
+    }
+
+    // Calculate contacts effective masses and restitution target velocity, then apply previous step impulses (warm starting)
+    Vector2 tangent = { manifold->normal.y, -manifold->normal.x };
+
+    for (int i = 0; i < manifold->contactsCount; i++)
+    {
+        Vector2 radiusA = Vector2Subtract(manifold->contacts[i], bodyA->position);
+        Vector2 radiusB = Vector2Subtract(manifold->contacts[i], bodyB->position);
+
+        float raCrossN = MathCrossVector2(radiusA, manifold->normal);
+        float rbCrossN = MathCrossVector2(radiusB, manifold->normal);
+        float raCrossT = MathCrossVector2(radiusA, tangent);
+        float rbCrossT = MathCrossVector2(radiusB, tangent);
+
+        float inverseMassSum = bodyA->inverseMass + bodyB->inverseMass;
+        float normalMassSum = inverseMassSum + (raCrossN*raCrossN)*bodyA->inverseInertia + (rbCrossN*rbCrossN)*bodyB->inverseInertia;
+        float tangentMassSum = inverseMassSum + (raCrossT*raCrossT)*bodyA->inverseInertia + (rbCrossT*rbCrossT)*bodyB->inverseInertia;
+
+        manifold->normalMasses[i] = ((normalMassSum > 0.0f) ? 1.0f/normalMassSum : 0.0f);
+        manifold->tangentMasses[i] = ((tangentMassSum > 0.0f) ? 1.0f/tangentMassSum : 0.0f);
+
+        Vector2 radiusV = { 0.0f, 0.0f };
+        radiusV.x = bodyB->velocity.x + MathCross(bodyB->angularVelocity, radiusB).x - bodyA->velocity.x - MathCross(bodyA->angularVelocity, radiusA).x;
+        radiusV.y = bodyB->velocity.y + MathCross(bodyB->angularVelocity, radiusB).y - bodyA->velocity.y - MathCross(bodyA->angularVelocity, radiusA).y;
+
+        float contactVelocity = MathDot(radiusV, manifold->normal);
+        manifold->velocityBiases[i] = ((contactVelocity < 0.0f) ? -manifold->restitution*contactVelocity : 0.0f);
+
+        Vector2 impulse = { manifold->normal.x*manifold->normalImpulses[i] + tangent.x*manifold->tangentImpulses[i],
+                            manifold->normal.y*manifold->normalImpulses[i] + tangent.y*manifold->tangentImpulses[i] };
+
+        ApplyPhysicsImpulse(bodyA, (Vector2){ -impulse.x, -impulse.y }, radiusA);
+        ApplyPhysicsImpulse(bodyB, impulse, radiusB);
+    }
+}
+
+// Integrates physics collisions impulses to solve collisions, returns max contact velocity change
+// NOTE: Contact impulses are accumulated and clamped (sequential impulses), so they can be carried over to next step
+static float IntegratePhysicsImpulses(PhysicsManifold manifold)
+{
+    PhysicsBody bodyA = manifold->bodyA;
+    PhysicsBody bodyB = manifold->bodyB;
+    float maxChange = 0.0f;
+
+    if ((bodyA == NULL) || (bodyB == NULL)) return maxChange;
+
+    // NOTE: Static bodies (disabled or infinite mass) are never written, contact islands share them between solver threads
+
+    // Early out and positional correct if both objects have infinite mass (only dynamic bodies velocity is reset)
+    if (fabs(bodyA->inverseMass + bodyB->inverseMass) <= PHYSAC_EPSILON)
+    {
+        if (bodyA->enabled && (bodyA->inverseMass != 0.0f)) bodyA->velocity = PHYSAC_VECTOR_ZERO;
+        if (bodyB->enabled && (bodyB->inverseMass != 0.0f)) bodyB->velocity = PHYSAC_VECTOR_ZERO;
+        return maxChange;
+    }
+
+    Vector2 tangent = { manifold->normal.y, -manifold->normal.x };
+
+    for (int i = 0; i < manifold->contactsCount; i++)
+    {
+        // Calculate radius from center of mass to contact
+        Vector2 radiusA = Vector2Subtract(manifold->contacts[i], bodyA->position);
+        Vector2 radiusB = Vector2Subtract(manifold->contacts[i], bodyB->position);
+
+        // Calculate relative velocity
+        Vector2 radiusV = { 0.0f, 0.0f };
+        radiusV.x = bodyB->velocity.x + MathCross(bodyB->angularVelocity, radiusB).x - bodyA->velocity.x - MathCross(bodyA->angularVelocity, radiusA).x;
+        radiusV.y = bodyB->velocity.y + MathCross(bodyB->angularVelocity, radiusB).y - bodyA->velocity.y - MathCross(bodyA->angularVelocity, radiusA).y;
+
+        // Calculate normal impulse, accumulated impulse can only push bodies apart
+        float contactVelocity = MathDot(radiusV, manifold->normal);
+        float impulse = -(contactVelocity - manifold->velocityBiases[i])*manifold->normalMasses[i];
+        float accumulated = max(manifold->normalImpulses[i] + impulse, 0.0f);
+        impulse = accumulated - manifold->normalImpulses[i];
+        manifold->normalImpulses[i] = accumulated;
+
+        // Apply impulse to each physics body
+        Vector2 impulseV = { manifold->normal.x*impulse, manifold->normal.y*impulse };
+        ApplyPhysicsImpulse(bodyA, (Vector2){ -impulseV.x, -impulseV.y }, radiusA);
+        ApplyPhysicsImpulse(bodyB, impulseV, radiusB);
+
+        if (manifold->normalMasses[i] > 0.0f) maxChange = max(maxChange, fabsf(impulse)/manifold->normalMasses[i]);
+
+        // Calculate friction impulse with updated relative velocity
+        radiusV.x = bodyB->velocity.x + MathCross(bodyB->angularVelocity, radiusB).x - bodyA->velocity.x - MathCross(bodyA->angularVelocity, radiusA).x;
+        radiusV.y = bodyB->velocity.y + MathCross(bodyB->angularVelocity, radiusB).y - bodyA->velocity.y - MathCross(bodyA->angularVelocity, radiusA).y;
+
+        float impulseTangent = -MathDot(radiusV, tangent)*manifold->tangentMasses[i];
+
+        // Apply coulumb's law, accumulated friction impulse sticks under static friction and slides with dynamic friction
+        float accumulatedTangent = manifold->tangentImpulses[i] + impulseTangent;
+        if (fabsf(accumulatedTangent) > manifold->staticFriction*manifold->normalImpulses[i])
+        {
+            float maxFriction = manifold->dynamicFriction*manifold->normalImpulses[i];
+            accumulatedTangent = min(max(accumulatedTangent, -maxFriction), maxFriction);
+        }
+
+        impulseTangent = accumulatedTangent - manifold->tangentImpulses[i];
+        manifold->tangentImpulses[i] = accumulatedTangent;
+
+        // Apply friction impulse
+        Vector2 tangentImpulse = { tangent.x*impulseTangent, tangent.y*impulseTangent };
+        ApplyPhysicsImpulse(bodyA, (Vector2){ -tangentImpulse.x, -tangentImpulse.y }, radiusA);
+        ApplyPhysicsImpulse(bodyB, tangentImpulse, radiusB);
+
+        if (manifold->tangentMasses[i] > 0.0f) maxChange = max(maxChange, fabsf(impulseTangent)/manifold->tangentMasses[i]);
+    }
+
+    return maxChange;
+}
+
+// Applies an impulse to a dynamic physics body at a contact radius
+static void ApplyPhysicsImpulse(PhysicsBody body, Vector2 impulse, Vector2 radius)
+{
+    if (!body->enabled || (body->inverseMass == 0.0f)) return;
+
+    body->velocity.x += body->inverseMass*impulse.x;
+    body->velocity.y += body->inverseMass*impulse.y;
+
+    if (!body->freezeOrient) body->angularVelocity += body->inverseInertia*MathCrossVector2(radius, impulse);
+}
+
+// Integrates physics velocity into position and forces
+static void IntegratePhysicsVelocity(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if ((body == NULL) || !body->enabled || body->isSleeping) return;
+
+    body->position.x += body->velocity.x*world->deltaTime;
+    body->position.y += body->velocity.y*world->deltaTime;
+
+    if (!body->freezeOrient) body->orient += body->angularVelocity*world->deltaTime;
+    Mat2Set(&body->shape.transform, body->orient);
+
+    IntegratePhysicsForces(body);
+}
+
+// Integrates bullet physics body velocity, stopping it at first time of impact with other bodies
+// NOTE: Body is left slightly overlapping the hit body (within penetration allowance), so next step narrow phase
+// generates the contact and solver stops it. The rest of the step motion after the impact is discarded
+static void IntegratePhysicsBullet(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (!IsPhysicsBodyAwake(body) || body->isSensor)
+    {
+        IntegratePhysicsVelocity(body);
+        UpdatePhysicsTreeBody(body);
+        return;
+    }
+
+    PhysicsTransform start = { body->position, body->orient };
+    IntegratePhysicsVelocity(body);
+    PhysicsTransform end = { body->position, body->orient };
+
+    // Swept bounding box of the body motion, using shape bounding radius to include any rotation
+    float radius = world->bounds[body->id].radius;
+
+    Vector2 sweptMin = { min(start.position.x, end.position.x) - radius, min(start.position.y, end.position.y) - radius };
+    Vector2 sweptMax = { max(start.position.x, end.position.x) + radius, max(start.position.y, end.position.y) + radius };
+
+    float time = 1.0f;
+
+    // Find bodies which bounding box overlaps swept bounding box through query tree
+    // NOTE: Time of impact is the minimum of every body time of impact, so it does not depend on tree traversal order
+    PhysicsTreeStack stack;
+    InitPhysicsTreeStack(&stack);
+
+    if (world->treeRoot != 0) PushPhysicsTreeStack(&stack, world->treeRoot);
+
+    while (stack.count > 0)
+    {
+        PhysicsTreeNode *node = &world->treeNodes[stack.nodes[--stack.count]];
+
+        if ((node->min.x > sweptMax.x) || (node->max.x < sweptMin.x) || (node->min.y > sweptMax.y) || (node->max.y < sweptMin.y)) continue;
+
+        if (node->body != NULL)
+        {
+            PhysicsBody other = node->body;
+
+            if ((other == body) || other->isSensor || !CanPhysicsBodiesCollide(body, other)) continue;
+
+            PhysicsBoundsData *bounds = UpdatePhysicsBodyBounds(other);
+
+            if ((bounds->min.x > sweptMax.x) || (bounds->max.x < sweptMin.x) || (bounds->min.y > sweptMax.y) || (bounds->max.y < sweptMin.y)) continue;
+
+            time = FindPhysicsTimeOfImpact(body, other, start, end, time);
+        }
+        else
+        {
+            PushPhysicsTreeStack(&stack, node->children[0]);
+            PushPhysicsTreeStack(&stack, node->children[1]);
+        }
+    }
+
+    UnloadPhysicsTreeStack(&stack);
+
+    SetPhysicsBodyPose(body, start, end, time);
+
+    // Move bullet body leaf, so next bullets find it in its new position
+    UpdatePhysicsTreeBody(body);
+
+    #if defined(PHYSAC_DEBUG)
+        if (time < 1.0f) printf("[PHYSAC] bullet body id %i motion clamped at time of impact %f\n", body->id, time);
+    #endif
+}
+
+// Finds bullet body time of impact with a body in a step motion (maxTime if none before)
+// NOTE: Conservative advancement, bullet moves along its motion by the separation lower bound divided by the
+// max approach speed of any shape point, so it never gets deeper than target separation
+static float FindPhysicsTimeOfImpact(PhysicsBody bullet, PhysicsBody body, PhysicsTransform start, PhysicsTransform end, float maxTime)
+{
+    const float target = -PHYSAC_PENETRATION_ALLOWANCE*0.5f;        // Target separation, a small overlap detected by narrow phase
+    const float tolerance = PHYSAC_PENETRATION_ALLOWANCE*0.25f;
+
+    // Max distance any bullet shape point moves in the whole step
+    float rotationRadius = ((bullet->shape.type == PHYSICS_POLYGON) ? physicsWorld->bounds[bullet->id].radius : 0.0f);
+
+    float motion = sqrtf(DistSqr(start.position, end.position)) + fabsf(end.orient - start.orient)*rotationRadius;
+
+    if (motion < PHYSAC_EPSILON) return maxTime;
+
+    float time = 0.0f;
+    SetPhysicsBodyPose(bullet, start, end, time);
+    float separation = GetPhysicsBodiesSeparation(bullet, body);
+
+    if (separation < 0.0f) return maxTime;     // Bodies already overlapping are solved by discrete collisions
+
+    for (int i = 0; i < PHYSAC_CCD_ITERATIONS; i++)
+    {
+        if (separation - target < tolerance) return time;
+
+        time += (separation - target)/motion;
+
+        if (time >= maxTime) return maxTime;
+
+        SetPhysicsBodyPose(bullet, start, end, time);
+        separation = GetPhysicsBodiesSeparation(bullet, body);
+    }
+
+    // Not converged yet, current time is still safe (body never gets deeper than target)
+    return time;
+}
+
+// Places a physics body between two transforms
+static void SetPhysicsBodyPose(PhysicsBody body, PhysicsTransform start, PhysicsTransform end, float time)
+{
+    body->position.x = start.position.x + (end.position.x - start.position.x)*time;
+    body->position.y = start.position.y + (end.position.y - start.position.y)*time;
+    body->orient = start.orient + (end.orient - start.orient)*time;
+    Mat2Set(&body->shape.transform, body->orient);
+}
+
+// Returns a lower bound of the distance between two bodies shapes (negative when overlapping)
+// NOTE: Separation along shapes faces normals (separating axis), exact for overlapping shapes. Compound shapes
+// separation is the minimum separation of their pieces pairs
+static float GetPhysicsBodiesSeparation(PhysicsBody bodyA, PhysicsBody bodyB)
+{
+    float separation = PHYSAC_FLT_MAX;
+
+    if ((bodyA->shape.type == PHYSICS_POLYGON) && (bodyB->shape.type == PHYSICS_POLYGON))
+    {
+        PhysicsShape shapeA = bodyA->shape;
+        PhysicsShape shapeB = bodyB->shape;
+
+        for (int i = 0; i < bodyA->shape.piecesCount; i++)
+        {
+            shapeA.vertexData = &bodyA->shape.vertexData[i];
+
+            for (int j = 0; j < bodyB->shape.piecesCount; j++)
+            {
+                int faceIndex = 0;
+                shapeB.vertexData = &bodyB->shape.vertexData[j];
+
+                separation = min(separation, max(FindAxisLeastPenetration(&faceIndex, shapeA, shapeB), FindAxisLeastPenetration(&faceIndex, shapeB, shapeA)));
+            }
+        }
+    }
+    else if ((bodyA->shape.type == PHYSICS_CIRCLE) && (bodyB->shape.type == PHYSICS_CIRCLE))
+    {
+        separation = sqrtf(DistSqr(bodyA->position, bodyB->position)) - bodyA->shape.radius - bodyB->shape.radius;
+    }
+    else
+    {
+        PhysicsBody circle = ((bodyA->shape.type == PHYSICS_CIRCLE) ? bodyA : bodyB);
+        PhysicsBody polygon = ((bodyA->shape.type == PHYSICS_CIRCLE) ? bodyB : bodyA);
+
+        for (int i = 0; i < polygon->shape.piecesCount; i++)
+        {
+            PolygonData *vertexData = &polygon->shape.vertexData[i];
+            float pieceSeparation = -PHYSAC_FLT_MAX;
+
+            for (int j = 0; j < vertexData->vertexCount; j++)
+            {
+                Vector2 normal = Mat2MultiplyVector2(polygon->shape.transform, vertexData->normals[j]);
+                Vector2 vertex = Vector2Add(polygon->position, Mat2MultiplyVector2(polygon->shape.transform, vertexData->positions[j]));
+
+                pieceSeparation = max(pieceSeparation, MathDot(normal, Vector2Subtract(circle->position, vertex)) - circle->shape.radius);
+            }
+
+            separation = min(separation, pieceSeparation);
+        }
+    }
+
+    return separation;
+}
+
+// Corrects physics bodies positions based on manifolds collision information
+static void CorrectPhysicsPositions(PhysicsManifold manifold)
+{
+    PhysicsBody bodyA = manifold->bodyA;
+    PhysicsBody bodyB = manifold->bodyB;
+
+    if ((bodyA == NULL) || (bodyB == NULL)) return;
+
+    Vector2 correction = { 0.0f, 0.0f };
+    correction.x = (max(manifold->penetration - PHYSAC_PENETRATION_ALLOWANCE, 0.0f)/(bodyA->inverseMass + bodyB->inverseMass))*manifold->normal.x*PHYSAC_PENETRATION_CORRECTION;
+    correction.y = (max(manifold->penetration - PHYSAC_PENETRATION_ALLOWANCE, 0.0f)/(bodyA->inverseMass + bodyB->inverseMass))*manifold->normal.y*PHYSAC_PENETRATION_CORRECTION;
+
+    if (bodyA->enabled)
+    {
+        bodyA->position.x -= correction.x*bodyA->inverseMass;
+        bodyA->position.y -= correction.y*bodyA->inverseMass;
+    }
+
+    if (bodyB->enabled)
+    {
+        bodyB->position.x += correction.x*bodyB->inverseMass;
+        bodyB->position.y += correction.y*bodyB->inverseMass;
+    }
+}
+
+// Returns true if a physics body is dynamic (enabled with finite mass) and not sleeping
+static bool IsPhysicsBodyAwake(PhysicsBody body)
+{
+    return (body->enabled && (body->inverseMass != 0.0f) && !body->isSleeping);
+}
+
+// Wakes up a sleeping physics body and resets its resting time
+static void WakeUpPhysicsBody(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    body->isSleeping = false;
+    world->sleepData[body->id].restTime = 0.0f;
+}
+
+// Wakes up sleeping bodies which bounding box overlaps a physics body bounding box
+static void WakeUpPhysicsBodiesAround(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    UpdatePhysicsTree();
+
+    PhysicsBoundsData *bounds = UpdatePhysicsBodyBounds(body);
+    Vector2 min = bounds->min;
+    Vector2 max = bounds->max;
+
+    PhysicsTreeStack stack;
+    InitPhysicsTreeStack(&stack);
+
+    if (world->treeRoot != 0) PushPhysicsTreeStack(&stack, world->treeRoot);
+
+    while (stack.count > 0)
+    {
+        PhysicsTreeNode *node = &world->treeNodes[stack.nodes[--stack.count]];
+
+        if ((node->min.x > max.x) || (node->max.x < min.x) || (node->min.y > max.y) || (node->max.y < min.y)) continue;
+
+        if (node->body != NULL)
+        {
+            PhysicsBody other = node->body;
+
+            if ((other == body) || !other->isSleeping) continue;
+
+            // Leaves bounding boxes are enlarged, check body bounding box
+            PhysicsBoundsData *otherBounds = &world->bounds[other->id];
+
+            if ((otherBounds->min.x <= max.x) && (otherBounds->max.x >= min.x) && (otherBounds->min.y <= max.y) && (otherBounds->max.y >= min.y)) WakeUpPhysicsBody(other);
+        }
+        else
+        {
+            PushPhysicsTreeStack(&stack, node->children[0]);
+            PushPhysicsTreeStack(&stack, node->children[1]);
+        }
+    }
+
+    UnloadPhysicsTreeStack(&stack);
+}
+
+// Updates bodies resting time and puts to sleep contact islands resting for long enough
+// NOTE: A contact island sleeps as a whole, so bodies resting over moving ones stay awake. Bodies without contacts sleep on their own
+static void UpdatePhysicsSleeping(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    // Update resting time of awake dynamic bodies
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+
+        if (!IsPhysicsBodyAwake(body)) continue;
+
+        if ((MathLenSqr(body->velocity) < PHYSAC_SLEEP_LINEAR_VELOCITY*PHYSAC_SLEEP_LINEAR_VELOCITY) &&
+            (fabs(body->angularVelocity) < PHYSAC_SLEEP_ANGULAR_VELOCITY)) world->sleepData[body->id].restTime += world->deltaTime;
+        else world->sleepData[body->id].restTime = 0.0f;
+    }
+
+    // Find contact islands ready to sleep, island parents are reused to store the island index of every body
+    for (int i = 0; i < world->physicsBodiesCount; i++) world->islandParents[i] = world->islandsCount;
+
+    for (unsigned int i = 0; i < world->islandsCount; i++)
+    {
+        bool ready = true;
+
+        for (unsigned int j = world->islandStarts[i]; j < world->islandStarts[i + 1]; j++)
+        {
+            PhysicsManifold manifold = &world->contacts[world->islandManifolds[j]];
+            PhysicsBody pair[2] = { manifold->bodyA, manifold->bodyB };
+
+            for (int k = 0; k < 2; k++)
+            {
+                if (!IsPhysicsBodyAwake(pair[k])) continue;
+
+                world->islandParents[world->bodiesIndex[pair[k]->id]] = i;
+                if (world->sleepData[pair[k]->id].restTime < PHYSAC_SLEEP_TIME) ready = false;
+            }
+        }
+
+        world->islandKeys[i] = ready;
+    }
+
+    // Put to sleep bodies of ready islands and bodies without contacts resting for long enough
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+
+        if (!IsPhysicsBodyAwake(body)) continue;
+
+        PhysicsSleepData *sleep = &world->sleepData[body->id];
+        unsigned int island = world->islandParents[i];
+        bool ready = ((island < world->islandsCount) ? world->islandKeys[island] : (sleep->restTime >= PHYSAC_SLEEP_TIME));
+
+        if (ready)
+        {
+            body->isSleeping = true;
+            body->velocity = PHYSAC_VECTOR_ZERO;
+            body->angularVelocity = 0.0f;
+            sleep->position = body->position;
+            sleep->orient = body->orient;
+        }
+    }
+}
+
+// Reserves contact islands arrays for current bodies and manifolds count
+static bool ReservePhysicsIslands(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int required = max(world->physicsBodiesCount, world->physicsManifoldsCount) + 1;
+
+    if (required > world->islandsCapacity)
+    {
+        unsigned int newCapacity = max(required, 2*world->islandsCapacity);
+
+        unsigned int *newParents = (unsigned int *)PHYSAC_REALLOC(world->islandParents, newCapacity*sizeof(unsigned int));
+        if (newParents != NULL) world->islandParents = newParents;
+        unsigned int *newKeys = (unsigned int *)PHYSAC_REALLOC(world->islandKeys, newCapacity*sizeof(unsigned int));
+        if (newKeys != NULL) world->islandKeys = newKeys;
+        unsigned int *newManifolds = (unsigned int *)PHYSAC_REALLOC(world->islandManifolds, newCapacity*sizeof(unsigned int));
+        if (newManifolds != NULL) world->islandManifolds = newManifolds;
+        unsigned int *newStarts = (unsigned int *)PHYSAC_REALLOC(world->islandStarts, newCapacity*sizeof(unsigned int));
+        if (newStarts != NULL) world->islandStarts = newStarts;
+
+        if ((newParents == NULL) || (newKeys == NULL) || (newManifolds == NULL) || (newStarts == NULL)) return false;
+
+        world->usedMemory += (newCapacity - world->islandsCapacity)*4*sizeof(unsigned int);
+        PHYSAC_STATS_ADD(allocations, 1);
+        world->islandsCapacity = newCapacity;
+    }
+
+    return true;
+}
+
+// Groups manifolds in contact islands (connected dynamic bodies)
+// NOTE: Static bodies (disabled or infinite mass) never get impulses so they do not connect islands,
+// islands are sorted by root body index and manifolds keep their order inside every island
+static bool BuildPhysicsIslands(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    world->islandsCount = 0;
+
+    if (!ReservePhysicsIslands()) return false;
+
+    // Join dynamic bodies in contact
+    for (int i = 0; i < world->physicsBodiesCount; i++) world->islandParents[i] = i;
+
+    for (int i = 0; i < world->physicsManifoldsCount; i++)
+    {
+        PhysicsBody bodyA = world->contacts[i].bodyA;
+        PhysicsBody bodyB = world->contacts[i].bodyB;
+
+        if (!bodyA->enabled || (bodyA->inverseMass == 0.0f) || !bodyB->enabled || (bodyB->inverseMass == 0.0f)) continue;
+
+        unsigned int rootA = FindIslandRoot(world->bodiesIndex[bodyA->id]);
+        unsigned int rootB = FindIslandRoot(world->bodiesIndex[bodyB->id]);
+
+        if (rootA < rootB) world->islandParents[rootB] = rootA;
+        else if (rootB < rootA) world->islandParents[rootA] = rootB;
+    }
+
+    // Key every manifold by its island root and count manifolds of every root
+    for (int i = 0; i <= world->physicsBodiesCount; i++) world->islandStarts[i] = 0;
+
+    for (int i = 0; i < world->physicsManifoldsCount; i++)
+    {
+        PhysicsBody body = world->contacts[i].bodyA;
+        if (!body->enabled || (body->inverseMass == 0.0f)) body = world->contacts[i].bodyB;
+
+        world->islandKeys[i] = FindIslandRoot(world->bodiesIndex[body->id]);
+        world->islandStarts[world->islandKeys[i]]++;
+    }
+
+    // Turn roots counters into islands offsets, island index never exceeds root index so counters are read before overwritten
+    unsigned int offset = 0;
+
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        unsigned int count = world->islandStarts[i];
+
+        if (count > 0)
+        {
+            world->islandParents[i] = world->islandsCount;        // Root body stores its island index, union-find is not used anymore
+            world->islandStarts[world->islandsCount] = offset;
+            world->islandsCount++;
+            offset += count;
+        }
+    }
+
+    world->islandStarts[world->islandsCount] = offset;
+
+    // Sort manifolds by island (stable counting sort), islands starts are used as cursors and restored later
+    for (int i = 0; i < world->physicsManifoldsCount; i++)
+    {
+        unsigned int island = world->islandParents[world->islandKeys[i]];
+
+        world->islandManifolds[world->islandStarts[island]] = i;
+        world->islandStarts[island]++;
+    }
+
+    for (int i = world->islandsCount; i > 0; i--) world->islandStarts[i] = world->islandStarts[i - 1];
+    world->islandStarts[0] = 0;
+
+    return true;
+}
+
+// Finds contact island root body index of a body index
+static unsigned int FindIslandRoot(unsigned int index)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    while (world->islandParents[index] != index)
+    {
+        world->islandParents[index] = world->islandParents[world->islandParents[index]];     // Path halving
+        index = world->islandParents[index];
+    }
+
+    return index;
+}
+
+// Integrates collisions impulses of a contact island manifolds until they converge, returns iterations run
+static int SolvePhysicsIsland(unsigned int island)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int start = world->islandStarts[island];
+    unsigned int end = world->islandStarts[island + 1];
+    int iterations = 0;
+
+    while (iterations < world->solverIterations)
+    {
+        float maxChange = 0.0f;
+
+        for (unsigned int j = start; j < end; j++) maxChange = max(maxChange, IntegratePhysicsImpulses(&world->contacts[world->islandManifolds[j]]));
+        iterations++;
+
+        // Stop iterating when contact island impulses converged
+        if (maxChange < world->solverTolerance) break;
+    }
+
+    return iterations;
+}
+
+// Solves all contact islands, spreading them over solver worker threads
+// NOTE: Islands do not share any dynamic body, so solving order between islands does not change results
+static void SolvePhysicsIslands(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+#if !defined(PHYSAC_NO_THREADS)
+    if ((world->solverThreadsCount > 0) && (world->islandsCount > 1))
+    {
+        pthread_mutex_lock(&world->solverMutex);
+        world->solverIslandsCount = world->islandsCount;
+        world->solverNextIsland = 0;
+        world->solverDoneIslands = 0;
+        world->solverJob++;
+        pthread_cond_broadcast(&world->solverStartCond);
+
+        // Physics step thread solves islands too, then waits for workers to finish
+        while (world->solverNextIsland < world->solverIslandsCount)
+        {
+            unsigned int island = world->solverNextIsland;
+            world->solverNextIsland++;
+
+            pthread_mutex_unlock(&world->solverMutex);
+            int iterations = SolvePhysicsIsland(island);
+            pthread_mutex_lock(&world->solverMutex);
+
+            world->solverDoneIslands++;
+            PHYSAC_STATS_ADD(solverIterations, iterations);
+        }
+
+        while (world->solverDoneIslands < world->solverIslandsCount) pthread_cond_wait(&world->solverDoneCond, &world->solverMutex);
+        pthread_mutex_unlock(&world->solverMutex);
+
+        return;
+    }
+#endif
+
+    for (unsigned int i = 0; i < world->islandsCount; i++)
+    {
+        int iterations = SolvePhysicsIsland(i);
+        PHYSAC_STATS_ADD(solverIterations, iterations);
+    }
+}
+
+#if !defined(PHYSAC_NO_THREADS)
+// Contact islands solver worker thread function
+static void *PhysicsSolverLoop(void *arg)
+{
+    // Bind physics world which contact islands are solved
+    PhysicsWorldData *world = (PhysicsWorldData *)arg;
+    physicsWorld = world;
+
+    unsigned int lastJob = 0;
+
+    pthread_mutex_lock(&world->solverMutex);
+    lastJob = world->solverJob;
+
+    while (!world->solverExit)
+    {
+        if (world->solverJob == lastJob)
+        {
+            pthread_cond_wait(&world->solverStartCond, &world->solverMutex);
+            continue;
+        }
+
+        lastJob = world->solverJob;
+
+        while (world->solverNextIsland < world->solverIslandsCount)
+        {
+            unsigned int island = world->solverNextIsland;
+            world->solverNextIsland++;
+
+            pthread_mutex_unlock(&world->solverMutex);
+            int iterations = SolvePhysicsIsland(island);
+            pthread_mutex_lock(&world->solverMutex);
+
+            world->solverDoneIslands++;
+            PHYSAC_STATS_ADD(solverIterations, iterations);
+            if (world->solverDoneIslands == world->solverIslandsCount) pthread_cond_signal(&world->solverDoneCond);
+        }
+    }
+
+    pthread_mutex_unlock(&world->solverMutex);
+
+    return NULL;
+}
+#endif
+
+// Binds a physics world to calling thread and runs a physics step on it
+static void StepPhysicsWorld(PhysicsWorld world)
+{
+    if (world == NULL) return;
+
+    physicsWorld = world;
+
+    PHYSAC_LOCK_WORLD(world);
+    world->eventsCount = 0;
+    PhysicsStep();
+    PHYSAC_UNLOCK_WORLD(world);
+}
+
+#if !defined(PHYSAC_NO_THREADS)
+// Physics worlds stepping worker thread function
+static void *PhysicsWorldsLoop(void *arg)
+{
+    unsigned int lastJob = 0;
+
+    pthread_mutex_lock(&worldsMutex);
+    lastJob = worldsJobId;
+
+    while (!worldsExit)
+    {
+        if (worldsJobId == lastJob)
+        {
+            pthread_cond_wait(&worldsStartCond, &worldsMutex);
+            continue;
+        }
+
+        lastJob = worldsJobId;
+
+        while (worldsNextIndex < worldsJobCount)
+        {
+            int index = worldsNextIndex;
+            worldsNextIndex++;
+
+            pthread_mutex_unlock(&worldsMutex);
+            StepPhysicsWorld(worldsJob[index]);
+            pthread_mutex_lock(&worldsMutex);
+
+            worldsDoneCount++;
+            if (worldsDoneCount == worldsJobCount) pthread_cond_signal(&worldsDoneCond);
+        }
+    }
+
+    pthread_mutex_unlock(&worldsMutex);
+
+    return NULL;
+}
+#endif
+
+// Writes current physics state records into a buffer, returns state size (written only if it fits)
+static int WritePhysicsState(unsigned char *buffer, int maxSize)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsStateStream stream = { buffer, NULL, maxSize, 0 };
+
+    PhysicsStateHeader header = { { 'P', 'H', 'S', 'T' }, PHYSAC_STATE_VERSION, 0 };
+
+    // Measure state size first, so nothing is written to a buffer that is too small
+    if (buffer != NULL)
+    {
+        header.size = WritePhysicsState(NULL, 0);
+        if (header.size > maxSize) return header.size;
+    }
+
+    header.deltaTime = world->deltaTime;
+    header.bodyStateSize = sizeof(PhysicsBodyState);
+    header.stepsCount = world->stepsCount;
+    header.gravityForce = world->gravityForce;
+    header.solverTolerance = world->solverTolerance;
+    header.bodiesCapacity = world->bodiesCapacity;
+    header.bodiesCount = world->physicsBodiesCount;
+    header.freeIdsCount = world->freeIdsCount;
+    header.manifoldsCount = world->physicsManifoldsCount;
+    header.proxiesCount = (world->proxiesDirty ? 0 : world->proxiesCount);
+    header.proxiesDirty = world->proxiesDirty;
+
+    WriteStateData(&stream, &header, sizeof(PhysicsStateHeader));
+
+    // Physics bodies in bodies pointers array order
+    // NOTE: Records are grouped by type and most changing records go last, so records keep their offsets between steps (small deltas)
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+
+        PhysicsBodyState state = { 0 };
+        state.id = body->id;
+        state.flags = (body->enabled ? 0x01 : 0) | (body->useGravity ? 0x02 : 0) | (body->isGrounded ? 0x04 : 0) |
+                      (body->isSleeping ? 0x08 : 0) | (body->freezeOrient ? 0x10 : 0) | (body->isBullet ? 0x20 : 0) | (body->isSensor ? 0x40 : 0);
+        state.shapeType = body->shape.type;
+        state.piecesCount = body->shape.piecesCount;
+        state.categoryBits = body->categoryBits;
+        state.maskBits = body->maskBits;
+        state.position = body->position;
+        state.velocity = body->velocity;
+        state.force = body->force;
+        state.angularVelocity = body->angularVelocity;
+        state.torque = body->torque;
+        state.orient = body->orient;
+        state.inertia = body->inertia;
+        state.inverseInertia = body->inverseInertia;
+        state.mass = body->mass;
+        state.inverseMass = body->inverseMass;
+        state.staticFriction = body->staticFriction;
+        state.dynamicFriction = body->dynamicFriction;
+        state.restitution = body->restitution;
+        state.radius = body->shape.radius;
+        state.transform = body->shape.transform;
+        state.sleep = world->sleepData[body->id];
+
+        WriteStateData(&stream, &state, sizeof(PhysicsBodyState));
+    }
+
+    // Polygon shapes pieces vertices count, positions and normals, in the same order
+    for (int i = 0; i < world->physicsBodiesCount; i++)
+    {
+        PhysicsBody body = world->bodies[i];
+
+        for (int j = 0; (j < body->shape.piecesCount) && (body->shape.type == PHYSICS_POLYGON); j++)
+        {
+            PolygonData *vertexData = &body->shape.vertexData[j];
+
+            WriteStateData(&stream, &vertexData->vertexCount, sizeof(unsigned int));
+            WriteStateData(&stream, vertexData->positions, vertexData->vertexCount*sizeof(Vector2));
+            WriteStateData(&stream, vertexData->normals, vertexData->vertexCount*sizeof(Vector2));
+        }
+    }
+
+    // Available ids stack, so new bodies get the same ids after restoring state
+    WriteStateData(&stream, world->freeIds, world->freeIdsCount*sizeof(unsigned int));
+
+    // Broad-phase proxies order, it decides manifolds order of next step
+    for (int i = 0; i < header.proxiesCount; i++) WriteStateData(&stream, &world->proxies[i].body->id, sizeof(unsigned int));
+
+    // Last step manifolds, next step warm starts matching contacts from them
+    for (int i = 0; i < world->physicsManifoldsCount; i++)
+    {
+        PhysicsManifold manifold = &world->contacts[i];
+
+        PhysicsManifoldState state = { 0 };
+        state.bodyA = manifold->bodyA->id;
+        state.bodyB = manifold->bodyB->id;
+        state.pieceA = manifold->pieceA;
+        state.pieceB = manifold->pieceB;
+        state.contactsCount = manifold->contactsCount;
+        state.penetration = manifold->penetration;
+        state.normal = manifold->normal;
+
+        for (int j = 0; j < 2; j++)
+        {
+            state.contacts[j] = manifold->contacts[j];
+            state.contactsIds[j] = manifold->contactsIds[j];
+            state.normalImpulses[j] = manifold->normalImpulses[j];
+            state.tangentImpulses[j] = manifold->tangentImpulses[j];
+        }
+
+        WriteStateData(&stream, &state, sizeof(PhysicsManifoldState));
+    }
+
+    return stream.offset;
+}
+
+// Restores physics state records from a buffer, returns false if data is not valid (world mutex must be held)
+static bool ReadPhysicsState(const unsigned char *data, int size)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    PhysicsStateStream stream = { NULL, data, size, 0 };
+    PhysicsStateHeader header = { 0 };
+
+    if ((data == NULL) || !ReadStateData(&stream, &header, sizeof(PhysicsStateHeader))) return false;
+
+    if ((header.magic[0] != 'P') || (header.magic[1] != 'H') || (header.magic[2] != 'S') || (header.magic[3] != 'T') ||
+        (header.version != PHYSAC_STATE_VERSION) || (header.size != size) || (header.bodyStateSize != sizeof(PhysicsBodyState)))
+    {
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] physics state could not be loaded, it is not a valid version %i physics state\n", PHYSAC_STATE_VERSION);
+    #endif
+        return false;
+    }
+
+    // Check records fit in state before growing pools (polygon vertices not included)
+    unsigned long long minSize = sizeof(PhysicsStateHeader) + (unsigned long long)header.bodiesCount*sizeof(PhysicsBodyState) +
+                                 (unsigned long long)header.freeIdsCount*sizeof(unsigned int) + (unsigned long long)header.manifoldsCount*sizeof(PhysicsManifoldState) +
+                                 (unsigned long long)header.proxiesCount*sizeof(unsigned int);
+
+    if ((minSize > (unsigned long long)size) || (header.bodiesCapacity == 0) || ((header.bodiesCount + header.freeIdsCount) != header.bodiesCapacity) ||
+        (header.proxiesCount > header.bodiesCount)) return false;
+
+    // Reserve pools for state bodies ids and manifolds
+    while (world->bodiesCapacity < header.bodiesCapacity)
+    {
+        if (!GrowPhysicsBodies()) return false;
+    }
+
+    while (world->manifoldsCapacity < header.manifoldsCount)
+    {
+        if (!GrowPhysicsManifolds()) return false;
+    }
+
+    // Check every body id is used once (bodies index marks state bodies ids, restored if state is not valid)
+    const unsigned int unused = world->bodiesCapacity;
+    PhysicsStateStream shapes = { NULL, data, size, sizeof(PhysicsStateHeader) + header.bodiesCount*sizeof(PhysicsBodyState) };
+    bool valid = true;
+
+    for (int i = 0; i < world->bodiesCapacity; i++) world->bodiesIndex[i] = unused;
+
+    for (unsigned int i = 0; (i < header.bodiesCount) && valid; i++)
+    {
+        PhysicsBodyState body = { 0 };
+
+        valid = (ReadStateData(&stream, &body, sizeof(PhysicsBodyState)) && (body.id < header.bodiesCapacity) && (world->bodiesIndex[body.id] == unused) &&
+                 (((body.shapeType == PHYSICS_CIRCLE) && (body.piecesCount == 1)) || ((body.shapeType == PHYSICS_POLYGON) && (body.piecesCount > 0))));
+
+        // Check polygon shape pieces vertices records
+        for (unsigned int j = 0; (j < body.piecesCount) && (body.shapeType == PHYSICS_POLYGON) && valid; j++)
+        {
+            unsigned int vertexCount = 0;
+
+            valid = (ReadStateData(&shapes, &vertexCount, sizeof(unsigned int)) && (vertexCount <= PHYSAC_MAX_VERTICES) &&
+                     ((int)(vertexCount*2*sizeof(Vector2)) <= (shapes.size - shapes.offset)));
+
+            if (valid) shapes.offset += vertexCount*2*sizeof(Vector2);
+        }
+
+        if (valid) world->bodiesIndex[body.id] = i;
+    }
+
+    if (valid) stream.offset = shapes.offset;
+
+    for (unsigned int i = 0; (i < header.freeIdsCount) && valid; i++)
+    {
+        unsigned int id = 0;
+
+        valid = (ReadStateData(&stream, &id, sizeof(unsigned int)) && (id < header.bodiesCapacity) && (world->bodiesIndex[id] == unused));
+        if (valid) world->bodiesIndex[id] = header.bodiesCount;
+    }
+
+    for (unsigned int i = 0; (i < header.proxiesCount) && valid; i++)
+    {
+        unsigned int id = 0;
+
+        valid = (ReadStateData(&stream, &id, sizeof(unsigned int)) && (id < header.bodiesCapacity) && (world->bodiesIndex[id] < header.bodiesCount));
+    }
+
+    for (unsigned int i = 0; (i < header.manifoldsCount) && valid; i++)
+    {
+        PhysicsManifoldState manifold = { 0 };
+
+        valid = (ReadStateData(&stream, &manifold, sizeof(PhysicsManifoldState)) && (manifold.contactsCount <= 2) &&
+                 (manifold.bodyA < header.bodiesCapacity) && (world->bodiesIndex[manifold.bodyA] < header.bodiesCount) &&
+                 (manifold.bodyB < header.bodiesCapacity) && (world->bodiesIndex[manifold.bodyB] < header.bodiesCount));
+    }
+
+    if (valid) valid = (stream.offset == size);
+
+    // Reserve compound shapes pieces before restoring any body, so state is not modified if they can not be allocated
+    stream.offset = sizeof(PhysicsStateHeader);
+
+    for (unsigned int i = 0; (i < header.bodiesCount) && valid; i++)
+    {
+        PhysicsBodyState body = { 0 };
+        ReadStateData(&stream, &body, sizeof(PhysicsBodyState));
+
+        if (body.piecesCount > 1) valid = (ReservePhysicsBodyPieces(body.id, body.piecesCount) != NULL);
+    }
+
+    if (!valid)
+    {
+        for (int i = 0; i < world->physicsBodiesCount; i++) world->bodiesIndex[world->bodies[i]->id] = i;
+
+        // Free compound shapes pieces reserved for ids that are not current compound bodies
+        for (int i = 0; i < world->bodiesCapacity; i++)
+        {
+            unsigned int index = world->bodiesIndex[i];
+
+            if ((world->pieces[i].polygons != NULL) && ((index >= world->physicsBodiesCount) || (world->bodies[index]->id != i) ||
+                (world->bodies[index]->shape.piecesCount == 1))) ReleasePhysicsBodyPieces(i);
+        }
+
+        #if defined(PHYSAC_DEBUG)
+            printf("[PHYSAC] physics state could not be loaded, its records are not valid\n");
+        #endif
+
+        return false;
+    }
+
+    // Clear previous step manifolds from hash table, state manifolds are indexed by next step
+    ClearPhysicsManifoldsTable();
+
+    // Restore physics bodies in their pool slots (bodies index was already restored while checking records)
+    shapes.offset = sizeof(PhysicsStateHeader) + header.bodiesCount*sizeof(PhysicsBodyState);
+    stream.offset = sizeof(PhysicsStateHeader);
+
+    // Restored bodies do not match snapshots of previous bodies, they are not interpolated from them
+    for (int i = 0; i < world->physicsBodiesCount; i++) world->bodies[i]->generation++;
+    for (int i = header.bodiesCount; i < world->physicsBodiesCount; i++) world->bodies[i] = NULL;
+
+    for (unsigned int i = 0; i < header.bodiesCount; i++)
+    {
+        PhysicsBodyState state = { 0 };
+        ReadStateData(&stream, &state, sizeof(PhysicsBodyState));
+
+        PhysicsBody body = GetPhysicsBodySlot(state.id);
+        body->id = state.id;
+        body->enabled = ((state.flags & 0x01) != 0);
+        body->useGravity = ((state.flags & 0x02) != 0);
+        body->isGrounded = ((state.flags & 0x04) != 0);
+        body->isSleeping = ((state.flags & 0x08) != 0);
+        body->freezeOrient = ((state.flags & 0x10) != 0);
+        body->isBullet = ((state.flags & 0x20) != 0);
+        body->isSensor = ((state.flags & 0x40) != 0);
+        body->categoryBits = state.categoryBits;
+        body->maskBits = state.maskBits;
+        body->position = state.position;
+        body->velocity = state.velocity;
+        body->force = state.force;
+        body->angularVelocity = state.angularVelocity;
+        body->torque = state.torque;
+        body->orient = state.orient;
+        body->inertia = state.inertia;
+        body->inverseInertia = state.inverseInertia;
+        body->mass = state.mass;
+        body->inverseMass = state.inverseMass;
+        body->staticFriction = state.staticFriction;
+        body->dynamicFriction = state.dynamicFriction;
+        body->restitution = state.restitution;
+        body->shape.type = (PhysicsShapeType)state.shapeType;
+        body->shape.body = body;
+        body->shape.radius = state.radius;
+        body->shape.transform = state.transform;
+        body->shape.vertexData = ((state.piecesCount > 1) ? world->pieces[state.id].polygons : GetPolygonSlot(state.id));
+        body->shape.vertexData->vertexCount = 0;
+        body->shape.piecesCount = state.piecesCount;
+
+        for (unsigned int j = 0; (j < state.piecesCount) && (state.shapeType == PHYSICS_POLYGON); j++)
+        {
+            PolygonData *vertexData = &body->shape.vertexData[j];
+
+            ReadStateData(&shapes, &vertexData->vertexCount, sizeof(unsigned int));
+            ReadStateData(&shapes, vertexData->positions, vertexData->vertexCount*sizeof(Vector2));
+            ReadStateData(&shapes, vertexData->normals, vertexData->vertexCount*sizeof(Vector2));
+        }
+
+        world->sleepData[state.id] = state.sleep;
+        world->bodies[i] = body;
+        InitPhysicsBodyBounds(body);
+    }
+
+    world->physicsBodiesCount = header.bodiesCount;
+    stream.offset = shapes.offset;
+
+    // Free compound shapes pieces of bodies not restored as compound bodies
+    for (int i = 0; i < world->bodiesCapacity; i++)
+    {
+        if ((world->pieces[i].polygons != NULL) && ((world->bodiesIndex[i] >= header.bodiesCount) || (GetPhysicsBodySlot(i)->shape.piecesCount == 1))) ReleasePhysicsBodyPieces(i);
+    }
+
+    // Restore available ids stack, ids over state capacity are used last in the same order bodies pool growth would stack them
+    world->freeIdsCount = 0;
+
+    for (int i = world->bodiesCapacity - 1; i >= (int)header.bodiesCapacity; i--)
+    {
+        world->freeIds[world->freeIdsCount] = i;
+        world->freeIdsCount++;
+    }
+
+    ReadStateData(&stream, &world->freeIds[world->freeIdsCount], header.freeIdsCount*sizeof(unsigned int));
+    world->freeIdsCount += header.freeIdsCount;
+
+    // Restore broad-phase proxies order (bounds are updated by next step)
+    for (unsigned int i = 0; i < header.proxiesCount; i++)
+    {
+        unsigned int id = 0;
+        ReadStateData(&stream, &id, sizeof(unsigned int));
+
+        world->proxies[i].body = GetPhysicsBodySlot(id);
+    }
+
+    world->proxiesCount = header.proxiesCount;
+    world->proxiesDirty = (header.proxiesDirty != 0);
+
+    // Restore last step manifolds, they are matched by next step manifolds to warm start contacts
+    for (unsigned int i = 0; i < header.manifoldsCount; i++)
+    {
+        PhysicsManifoldState state = { 0 };
+        ReadStateData(&stream, &state, sizeof(PhysicsManifoldState));
+
+        PhysicsManifold manifold = &world->contacts[i];
+        manifold->id = i;
+        manifold->bodyA = GetPhysicsBodySlot(state.bodyA);
+        manifold->bodyB = GetPhysicsBodySlot(state.bodyB);
+        manifold->pieceA = state.pieceA;
+        manifold->pieceB = state.pieceB;
+        manifold->penetration = state.penetration;
+        manifold->normal = state.normal;
+        manifold->contactsCount = state.contactsCount;
+
+        for (int j = 0; j < 2; j++)
+        {
+            manifold->contacts[j] = state.contacts[j];
+            manifold->contactsIds[j] = state.contactsIds[j];
+            manifold->normalImpulses[j] = state.normalImpulses[j];
+            manifold->tangentImpulses[j] = state.tangentImpulses[j];
+        }
+
+        manifold->restitution = 0.0f;
+        manifold->dynamicFriction = 0.0f;
+        manifold->staticFriction = 0.0f;
+    }
+
+    world->physicsManifoldsCount = header.manifoldsCount;
+
+    // Restored bodies are inserted in query tree again by next query
+    ResetPhysicsTree();
+
+    // Touching pairs are not saved, restored contacts begin touching again on next step
+    world->touchingPairs.count = 0;
+    world->eventsCount = 0;
+
+    world->stepsCount = header.stepsCount;
+    world->deltaTime = header.deltaTime;
+    world->gravityForce = header.gravityForce;
+    world->solverTolerance = header.solverTolerance;
+
+    #if defined(PHYSAC_DEBUG)
+        printf("[PHYSAC] physics state of step %i loaded successfully (%i bodies)\n", world->stepsCount, world->physicsBodiesCount);
+    #endif
+
+    return true;
+}
+
+// Writes bytes to a physics state stream (only measured if they do not fit)
+static void WriteStateData(PhysicsStateStream *stream, const void *data, int size)
+{
+    if ((stream->output != NULL) && (size > 0) && ((stream->offset + size) <= stream->size)) memcpy(stream->output + stream->offset, data, size);
+
+    stream->offset += size;
+}
+
+// Reads bytes from a physics state stream, returns false if there are not enough bytes
+static bool ReadStateData(PhysicsStateStream *stream, void *data, int size)
+{
+    if ((size < 0) || (size > (stream->size - stream->offset))) return false;
+
+    if (size > 0) memcpy(data, stream->input + stream->offset, size);
+    stream->offset += size;
+
+    return true;
+}
+
+// Writes a variable length unsigned integer (7 bits per byte) to a physics state stream
+static void WriteStateVarint(PhysicsStateStream *stream, unsigned int value)
+{
+    do
+    {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        if (value != 0) byte |= 0x80;
+
+        WriteStateData(stream, &byte, 1);
+    } while (value != 0);
+}
+
+// Reads a variable length unsigned integer from a physics state stream
+static bool ReadStateVarint(PhysicsStateStream *stream, unsigned int *value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        unsigned char byte = 0;
+        if (!ReadStateData(stream, &byte, 1)) return false;
+
+        *value |= (unsigned int)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+// Updates query tree leaves of bodies moved out of them and inserts new bodies
+// NOTE: Only runs once after bodies changed (first query after a step), leaves are enlarged by PHYSAC_TREE_MARGIN
+// so bodies moving a little keep their leaf
+static void UpdatePhysicsTree(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    if (!world->treeDirty) return;
+
+    for (int i = 0; i < world->physicsBodiesCount; i++) UpdatePhysicsTreeBody(world->bodies[i]);
+
+    world->treeDirty = false;
+}
+
+// Updates query tree leaf of a physics body moved out of it (inserts new bodies)
+static void UpdatePhysicsTreeBody(PhysicsBody body)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int leaf = world->treeLeaves[body->id];
+
+    PhysicsBoundsData *bounds = UpdatePhysicsBodyBounds(body);
+    Vector2 min = bounds->min;
+    Vector2 max = bounds->max;
+
+    if (leaf != 0)
+    {
+        PhysicsTreeNode *node = &world->treeNodes[leaf];
+        if ((min.x >= node->min.x) && (min.y >= node->min.y) && (max.x <= node->max.x) && (max.y <= node->max.y)) return;
+
+        RemovePhysicsTreeLeaf(leaf);
+    }
+    else
+    {
+        leaf = AllocatePhysicsTreeNode();
+        if (leaf == 0) return;
+
+        world->treeLeaves[body->id] = leaf;
+    }
+
+    PhysicsTreeNode *node = &world->treeNodes[leaf];
+    node->min = (Vector2){ min.x - PHYSAC_TREE_MARGIN, min.y - PHYSAC_TREE_MARGIN };
+    node->max = (Vector2){ max.x + PHYSAC_TREE_MARGIN, max.y + PHYSAC_TREE_MARGIN };
+    node->body = body;
+
+    if (!InsertPhysicsTreeLeaf(leaf))
+    {
+        ReleasePhysicsTreeNode(leaf);
+        world->treeLeaves[body->id] = 0;
+    }
+}
+
+// Removes all bodies from query tree
+static void ResetPhysicsTree(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    for (int i = 0; i < world->bodiesCapacity; i++) world->treeLeaves[i] = 0;
+
+    world->treeNodesCount = 0;
+    world->treeFreeNode = 0;
+    world->treeRoot = 0;
+    world->treeDirty = true;
+}
+
+// Returns a new query tree node from nodes pool (0 if pool can not grow)
+static unsigned int AllocatePhysicsTreeNode(void)
+{
+    PhysicsWorldData *world = physicsWorld;
+
+    unsigned int node = 0;
+
+    if (world->treeFreeNode != 0)
+    {
+        node = world->treeFreeNode;
+        world->treeFreeNode = world->treeNodes[node].parent;
+    }
+    else
+    {
+        if (world->treeNodesCount == 0) world->treeNodesCount = 1;     // Node 0 is used as null node
+
+        if (world->treeNodesCount >= world->treeNodesCapacity)
+        {
+            unsigned int newCapacity = ((world->treeNodesCapacity > 0) ? 2*world->treeNodesCapacity : 2*PHYSAC_MAX_BODIES);
+
+            PhysicsTreeNode *newNodes = (PhysicsTreeNode *)PHYSAC_REALLOC(world->treeNodes, newCapacity*sizeof(PhysicsTreeNode));
+
+            if (newNodes == NULL)
+            {
+            #if defined(PHYSAC_DEBUG)
+                printf("[PHYSAC] query tree nodes pool could not grow to %i nodes\n", newCapacity);
+            #endif
+                return 0;
+            }
+
+            world->usedMemory += (newCapacity - world->treeNodesCapacity)*sizeof(PhysicsTreeNode);
+            PHYSAC_STATS_ADD(allocations, 1);
+            world->treeNodes = newNodes;
+            world->treeNodesCapacity = newCapacity;
+        }
 
-    if ((bodyA == NULL) || (bodyB == NULL)) return;
+        node = world->treeNodesCount;
+        world->treeNodesCount++;
+    }
 
-    manifold->bodyA = bodyB;
-    manifold->bodyB = bodyA;
-    SolveCircleToPolygon(manifold);
+    world->treeNodes[node] = (PhysicsTreeNode){ 0 };
 
-    manifold->normal.x *= -1.0f;
-    manifold->normal.y *= -1.0f;
+    return node;
 }
 
-// Solves collision between two polygons shape physics bodies
-static void SolvePolygonToPolygon(PhysicsManifold manifold)
+// Returns a query tree node to nodes pool
+static void ReleasePhysicsTreeNode(unsigned int node)
 {
-    if ((manifold->bodyA == NULL) || (manifold->bodyB == NULL)) return;
+    PhysicsWorldData *world = physicsWorld;
 
-    PhysicsShape bodyA = manifold->bodyA->shape;
-    PhysicsShape bodyB = manifold->bodyB->shape;
-    manifold->contactsCount = 0;
+    world->treeNodes[node].parent = world->treeFreeNode;
+    world->treeNodes[node].body = NULL;
+    world->treeNodes[node].height = -1;
+    world->treeFreeNode = node;
+}
 
-    // Check for separating axis with A shape's face planes
-    int faceA = 0;
-    float penetrationA = FindAxisLeastPenetration(&faceA, bodyA, bodyB);
-    if (penetrationA >= 0.0f) return;
+// Inserts a leaf in query tree next to the node which bounding box grows less, returns false if it fails
+// NOTE: Nodes cost is their bounding box perimeter, ancestors bounding boxes grow too (inherited cost)
+static bool InsertPhysicsTreeLeaf(unsigned int leaf)
+{
+    PhysicsWorldData *world = physicsWorld;
 
-    // Check for separating axis with B shape's face planes
-    int faceB = 0;
-    float penetrationB = FindAxisLeastPenetration(&faceB, bodyB, bodyA);
-    if (penetrationB >= 0.0f) return;
+    if (world->treeRoot == 0)
+    {
+        world->treeRoot = leaf;
+        world->treeNodes[leaf].parent = 0;
+        return true;
+    }
 
-    int referenceIndex = 0;
-    bool flip = false;  // Always point from A shape to B shape
+    // New parent node is allocated first, nodes pool could be reallocated
+    unsigned int newParent = AllocatePhysicsTreeNode();
+    if (newParent == 0) return false;
 
-    PhysicsShape refPoly; // Reference
-    PhysicsShape incPoly; // Incident
+    PhysicsTreeNode *nodes = world->treeNodes;
+    Vector2 leafMin = nodes[leaf].min;
+    Vector2 leafMax = nodes[leaf].max;
 
-    // Determine which shape contains reference face
-    if (BiasGreaterThan(penetrationA, penetrationB))
-    {
-        refPoly = bodyA;
-        incPoly = bodyB;
-        referenceIndex = faceA;
-    }
-    else
+    // Find best sibling for new leaf
+    unsigned int index = world->treeRoot;
+
+    while (nodes[index].children[0] != 0)
     {
-        refPoly = bodyB;
-        incPoly = bodyA;
-        referenceIndex = faceB;
-        flip = true;
-    }
+        Vector2 combinedMin = { min(nodes[index].min.x, leafMin.x), min(nodes[index].min.y, leafMin.y) };
+        Vector2 combinedMax = { max(nodes[index].max.x, leafMax.x), max(nodes[index].max.y, leafMax.y) };
+        float combined = BoundsPerimeter(combinedMin, combinedMax);
 
-    // World space incident face
-    Vector2 incidentFace[2];
-    FindIncidentFace(&incidentFace[0], &incidentFace[1], refPoly, incPoly, referenceIndex);
+        float cost = 2.0f*combined;                                                     // Cost of a new parent for this node and new leaf
+        float inheritance = 2.0f*(combined - BoundsPerimeter(nodes[index].min, nodes[index].max));    // Cost of growing ancestors
 
-    // Setup reference face vertices
-    PolygonData refData = refPoly.vertexData;
-    Vector2 v1 = refData.positions[referenceIndex];
-    referenceIndex = (((referenceIndex + 1) < refData.vertexCount) ? (referenceIndex + 1) : 0);
-    Vector2 v2 = refData.positions[referenceIndex];
+        float childrenCost[2] = { 0.0f, 0.0f };
 
-    // Transform vertices to world space
-    v1 = Mat2MultiplyVector2(refPoly.transform, v1);
-    v1 = Vector2Add(v1, refPoly.body->position);
-    v2 = Mat2MultiplyVector2(refPoly.transform, v2);
-    v2 = Vector2Add(v2, refPoly.body->position);
+        for (int i = 0; i < 2; i++)
+        {
+            PhysicsTreeNode *child = &nodes[nodes[index].children[i]];
+            Vector2 childMin = { min(child->min.x, leafMin.x), min(child->min.y, leafMin.y) };
+            Vector2 childMax = { max(child->max.x, leafMax.x), max(child->max.y, leafMax.y) };
 
-    // Calculate reference face side normal in world space
-    Vector2 sidePlaneNormal = Vector2Subtract(v2, v1);
-    MathNormalize(&sidePlaneNormal);
+            if (child->children[0] == 0) childrenCost[i] = BoundsPerimeter(childMin, childMax) + inheritance;
+            else childrenCost[i] = BoundsPerimeter(childMin, childMax) - BoundsPerimeter(child->min, child->max) + inheritance;
+        }
 
-    // Orthogonalize
-    Vector2 refFaceNormal = { sidePlaneNormal.y, -sidePlaneNormal.x };
-    float refC = MathDot(refFaceNormal, v1);
-    float negSide = MathDot(sidePlaneNormal, v1)*-1;
-    float posSide = MathDot(sidePlaneNormal, v2);
+        if ((cost < childrenCost[0]) && (cost < childrenCost[1])) break;
 
-    // Clip incident face to reference face side planes (due to floating point error, possible to not have required points
-    if (Clip((Vector2){ -sidePlaneNormal.x, -sidePlaneNormal.y }, negSide, &incidentFace[0], &incidentFace[1]) < 2) return;
-    if (Clip(sidePlaneNormal, posSide, &incidentFace[0], &incidentFace[1]) < 2) return;
+        index = ((childrenCost[0] < childrenCost[1]) ? nodes[index].children[0] : nodes[index].children[1]);
+    }
 
-    // Flip normal if required
-    manifold->normal = (flip ? (Vector2){ -refFaceNormal.x, -refFaceNormal.y } : refFaceNormal);
+    // Replace sibling by a new parent of sibling and new leaf
+    unsigned int sibling = index;
+    unsigned int oldParent = nodes[sibling].parent;
 
-    // Keep points behind reference face
-    int currentPoint = 0; // Clipped points behind reference face
-    float separation = MathDot(refFaceNormal, incidentFace[0]) - refC;
-    if (separation <= 0.0f)
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].children[0] = sibling;
+    nodes[newParent].children[1] = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != 0)
     {
-        manifold->contacts[currentPoint] = incidentFace[0];
-        manifold->penetration = -separation;
-        currentPoint++;
+        if (nodes[oldParent].children[0] == sibling) nodes[oldParent].children[0] = newParent;
+        else nodes[oldParent].children[1] = newParent;
     }
-    else manifold->penetration = 0.0f;
+    else world->treeRoot = newParent;
 
-    separation = MathDot(refFaceNormal, incidentFace[1]) - refC;
+    // Walk back up fixing ancestors bounding boxes and heights
+    index = newParent;
 
-    if (separation <= 0.0f)
+    while (index != 0)
     {
-        manifold->contacts[currentPoint] = incidentFace[1];
-        manifold->penetration += -separation;
-        currentPoint++;
-
-        // Calculate total penetration average
-        manifold->penetration /= currentPoint;
+        index = BalancePhysicsTreeNode(index);
+        UpdatePhysicsTreeNode(index);
+        index = nodes[index].parent;
     }
 
-    manifold->contactsCount = currentPoint;
+    return true;
 }
 
-// Integrates physics forces into velocity
-static void IntegratePhysicsForces(PhysicsBody body)
+// Removes a leaf from query tree (leaf node is not released)
+static void RemovePhysicsTreeLeaf(unsigned int leaf)
 {
-    if ((body == NULL) || (body->inverseMass == 0.0f) || !body->enabled) return;
+    PhysicsWorldData *world = physicsWorld;
 
-    body->velocity.x += (body->force.x*body->inverseMass)*(deltaTime/2.0);
-    body->velocity.y += (body->force.y*body->inverseMass)*(deltaTime/2.0);
+    PhysicsTreeNode *nodes = world->treeNodes;
 
-    if (body->useGravity)
+    if (leaf == world->treeRoot)
     {
-        body->velocity.x += gravityForce.x*(deltaTime/1000/2.0);
-        body->velocity.y += gravityForce.y*(deltaTime/1000/2.0);
+        world->treeRoot = 0;
+        return;
     }
 
-    if (!body->freezeOrient) body->angularVelocity += body->torque*body->inverseInertia*(deltaTime/2.0);
-}
-
-// Initializes physics manifolds to solve collisions
-static void InitializePhysicsManifolds(PhysicsManifold manifold)
-{
-    PhysicsBody bodyA = manifold->bodyA;
-    PhysicsBody bodyB = manifold->bodyB;
-
-    if ((bodyA == NULL) || (bodyB == NULL)) return;
+    // Replace leaf parent by leaf sibling
+    unsigned int parent = nodes[leaf].parent;
+    unsigned int grandParent = nodes[parent].parent;
+    unsigned int sibling = ((nodes[parent].children[0] == leaf) ? nodes[parent].children[1] : nodes[parent].children[0]);
 
-    // Calculate average restitution, static and dynamic friction
-    manifold->restitution = sqrtf(bodyA->restitution*bodyB->restitution);
-    manifold->staticFriction = sqrtf(bodyA->staticFriction*bodyB->staticFriction);
-    manifold->dynamicFriction = sqrtf(bodyA->dynamicFriction*bodyB->dynamicFriction);
+    nodes[sibling].parent = grandParent;
+    ReleasePhysicsTreeNode(parent);
 
-    for (int i = 0; i < manifold->contactsCount; i++)
+    if (grandParent != 0)
     {
-        // Caculate radius from center of mass to contact
-        Vector2 radiusA = Vector2Subtract(manifold->contacts[i], bodyA->position);
-        Vector2 radiusB = Vector2Subtract(manifold->contacts[i], bodyB->position);
+        if (nodes[grandParent].children[0] == parent) nodes[grandParent].children[0] = sibling;
+        else nodes[grandParent].children[1] = sibling;
 
-        Vector2 crossA = MathCross(bodyA->angularVelocity, radiusA);
-        Vector2 crossB = MathCross(bodyB->angularVelocity, radiusB);
-
-        Vector2 radiusV = { 0.0f, 0.0f };
-        radiusV.x = bodyB->velocity.x + crossB.x - bodyA->velocity.x - crossA.x;
-        radiusV.y = bodyB->velocity.y + crossB.y - bodyA->velocity.y - crossA.y;
+        // Walk back up fixing ancestors bounding boxes and heights
+        unsigned int index = grandParent;
 
-        // Determine if we should perform a resting collision or not;
-        // The idea is if the only thing moving this object is gravity, then the collision should be performed without any restitution
-        if (MathLenSqr(radiusV) < (MathLenSqr((Vector2){ gravityForce.x*deltaTime/1000, gravityForce.y*deltaTime/1000 }) + PHYSAC_EPSILON)) manifold->restitution = 0;
+        while (index != 0)
+        {
+            index = BalancePhysicsTreeNode(index);
+            UpdatePhysicsTreeNode(index);
+            index = nodes[index].parent;
+        }
     }
+    else world->treeRoot = sibling;
 }
 
-// Integrates physics collisions impulses to solve collisions
-static void IntegratePhysicsImpulses(PhysicsManifold manifold)
+// Rotates a query tree node if its children heights differ more than one, returns node in its place
+// NOTE: Highest child takes node place, node takes the lowest grandchild of that child
+static unsigned int BalancePhysicsTreeNode(unsigned int node)
 {
-    PhysicsBody bodyA = manifold->bodyA;
-    PhysicsBody bodyB = manifold->bodyB;
+    PhysicsWorldData *world = physicsWorld;
 
-    if ((bodyA == NULL) || (bodyB == NULL)) return;
+    PhysicsTreeNode *nodes = world->treeNodes;
 
-    // Early out and positional correct if both objects have infinite mass
-    if (fabs(bodyA->inverseMass + bodyB->inverseMass) <= PHYSAC_EPSILON)
+    if ((nodes[node].children[0] == 0) || (nodes[node].height < 2)) return node;
+
+    int balance = nodes[nodes[node].children[1]].height - nodes[nodes[node].children[0]].height;
+    if ((balance >= -1) && (balance <= 1)) return node;
+
+    int up = ((balance > 1) ? 1 : 0);                   // Child index to move up
+    unsigned int child = nodes[node].children[up];
+    unsigned int grandChildA = nodes[child].children[0];
+    unsigned int grandChildB = nodes[child].children[1];
+
+    // Child takes node place
+    nodes[child].children[0] = node;
+    nodes[child].parent = nodes[node].parent;
+    nodes[node].parent = child;
+
+    if (nodes[child].parent != 0)
     {
-        bodyA->velocity = PHYSAC_VECTOR_ZERO;
-        bodyB->velocity = PHYSAC_VECTOR_ZERO;
-        return;
+        if (nodes[nodes[child].parent].children[0] == node) nodes[nodes[child].parent].children[0] = child;
+        else nodes[nodes[child].parent].children[1] = child;
     }
+    else world->treeRoot = child;
 
-    for (int i = 0; i < manifold->contactsCount; i++)
-    {
-        // Calculate radius from center of mass to contact
-        Vector2 radiusA = Vector2Subtract(manifold->contacts[i], bodyA->position);
-        Vector2 radiusB = Vector2Subtract(manifold->contacts[i], bodyB->position);
+    // Highest grandchild stays with child, lowest grandchild replaces child under node
+    unsigned int high = ((nodes[grandChildA].height > nodes[grandChildB].height) ? grandChildA : grandChildB);
+    unsigned int low = ((high == grandChildA) ? grandChildB : grandChildA);
 
-        // Calculate relative velocity
-        Vector2 radiusV = { 0.0f, 0.0f };
-        radiusV.x = bodyB->velocity.x + MathCross(bodyB->angularVelocity, radiusB).x - bodyA->velocity.x - MathCross(bodyA->angularVelocity, radiusA).x;
-        radiusV.y = bodyB->velocity.y + MathCross(bodyB->angularVelocity, radiusB).y - bodyA->velocity.y - MathCross(bodyA->angularVelocity, radiusA).y;
+    nodes[child].children[1] = high;
+    nodes[node].children[up] = low;
+    nodes[low].parent = node;
 
-        // Relative velocity along the normal
-        float contactVelocity = MathDot(radiusV, manifold->normal);
+    UpdatePhysicsTreeNode(node);
+    UpdatePhysicsTreeNode(child);
 
-        // Do not resolve if velocities are separating
-        if (contactVelocity > 0.0f) return;
+    return child;
+}
 
-        float raCrossN = MathCrossVector2(radiusA, manifold->normal);
-        float rbCrossN = MathCrossVector2(radiusB, manifold->normal);
+// Updates a query tree internal node bounding box and height from its children
+static void UpdatePhysicsTreeNode(unsigned int node)
+{
+    PhysicsWorldData *world = physicsWorld;
 
-        float inverseMassSum = bodyA->inverseMass + bodyB->inverseMass + (raCrossN*raCrossN)*bodyA->inverseInertia + (rbCrossN*rbCrossN)*bodyB->inverseInertia;
+    PhysicsTreeNode *nodes = world->treeNodes;
+    PhysicsTreeNode *childA = &nodes[nodes[node].children[0]];
+    PhysicsTreeNode *childB = &nodes[nodes[node].children[1]];
 
-        // Calculate impulse scalar value
-        float impulse = -(1.0f + manifold->restitution)*contactVelocity;
-        impulse /= inverseMassSum;
-        impulse /= (float)manifold->contactsCount;
+    nodes[node].min = (Vector2){ min(childA->min.x, childB->min.x), min(childA->min.y, childB->min.y) };
+    nodes[node].max = (Vector2){ max(childA->max.x, childB->max.x), max(childA->max.y, childB->max.y) };
+    nodes[node].height = 1 + max(childA->height, childB->height);
+}
 
-        // Apply impulse to each physics body
-        Vector2 impulseV = { manifold->normal.x*impulse, manifold->normal.y*impulse };
+// Initializes a query tree traversal stack with its local nodes array
+static void InitPhysicsTreeStack(PhysicsTreeStack *stack)
+{
+    stack->nodes = stack->local;
+    stack->count = 0;
+    stack->capacity = PHYSAC_TREE_STACK;
+}
+
+// Pushes a node to a query tree traversal stack, returns false if it can not grow
+// NOTE: Local nodes array is enough for balanced trees of any usual size, heap memory is only used once it is full
+static bool PushPhysicsTreeStack(PhysicsTreeStack *stack, unsigned int node)
+{
+    if (stack->count == stack->capacity)
+    {
+        int newCapacity = stack->capacity*2;
+        unsigned int *newNodes = NULL;
 
-        if (bodyA->enabled)
+        if (stack->nodes == stack->local)
         {
-            bodyA->velocity.x += bodyA->inverseMass*(-impulseV.x);
-            bodyA->velocity.y += bodyA->inverseMass*(-impulseV.y);
-            if (!bodyA->freezeOrient) bodyA->angularVelocity += bodyA->inverseInertia*MathCrossVector2(radiusA, (Vector2){ -impulseV.x, -impulseV.y });
+            newNodes = (unsigned int *)PHYSAC_MALLOC(newCapacity*sizeof(unsigned int));
+            if (newNodes != NULL) memcpy(newNodes, stack->local, stack->count*sizeof(unsigned int));
         }
+        else newNodes = (unsigned int *)PHYSAC_REALLOC(stack->nodes, newCapacity*sizeof(unsigned int));
 
-        if (bodyB->enabled)
+        if (newNodes == NULL)
         {
-            bodyB->velocity.x += bodyB->inverseMass*(impulseV.x);
-            bodyB->velocity.y += bodyB->inverseMass*(impulseV.y);
-            if (!bodyB->freezeOrient) bodyB->angularVelocity += bodyB->inverseInertia*MathCrossVector2(radiusB, impulseV);
+            #if defined(PHYSAC_DEBUG)
+                printf("[PHYSAC] query tree stack could not grow to %i nodes, query results are incomplete\n", newCapacity);
+            #endif
+
+            return false;
         }
 
-        // Apply friction impulse to each physics body
-        radiusV.x = bodyB->velocity.x + MathCross(bodyB->angularVelocity, radiusB).x - bodyA->velocity.x - MathCross(bodyA->angularVelocity, radiusA).x;
-        radiusV.y = bodyB->velocity.y + MathCross(bodyB->angularVelocity, radiusB).y - bodyA->velocity.y - MathCross(bodyA->angularVelocity, radiusA).y;
+        stack->nodes = newNodes;
+        stack->capacity = newCapacity;
+    }
 
-        Vector2 tangent = { radiusV.x - (manifold->normal.x*MathDot(radiusV, manifold->normal)), radiusV.y - (manifold->normal.y*MathDot(radiusV, manifold->normal)) };
-        MathNormalize(&tangent);
+    stack->nodes[stack->count++] = node;
 
-        // Calculate impulse tangent magnitude
-        float impulseTangent = -MathDot(radiusV, tangent);
-        impulseTangent /= inverseMassSum;
-        impulseTangent /= (float)manifold->contactsCount;
+    return true;
+}
 
-        float absImpulseTangent = fabs(impulseTangent);
+// Releases query tree traversal stack heap memory (if it grew)
+static void UnloadPhysicsTreeStack(PhysicsTreeStack *stack)
+{
+    if (stack->nodes != stack->local) PHYSAC_FREE(stack->nodes);
 
-        // Don't apply tiny friction impulses
-        if (absImpulseTangent <= PHYSAC_EPSILON) return;
+    stack->nodes = stack->local;
+    stack->count = 0;
+    stack->capacity = PHYSAC_TREE_STACK;
+}
 
-        // Apply coulumb's law
-        Vector2 tangentImpulse = { 0.0f, 0.0f };
-        if (absImpulseTangent < impulse*manifold->staticFriction) tangentImpulse = (Vector2){ tangent.x*impulseTangent, tangent.y*impulseTangent };
-        else tangentImpulse = (Vector2){ tangent.x*-impulse*manifold->dynamicFriction, tangent.y*-impulse*manifold->dynamicFriction };
+// Returns true if a point is inside a physics body shape
+static bool IsPhysicsBodyPoint(PhysicsBody body, Vector2 point)
+{
+    if (body->shape.type == PHYSICS_CIRCLE) return (DistSqr(point, body->position) <= body->shape.radius*body->shape.radius);
 
-        // Apply friction impulse
-        if (bodyA->enabled)
-        {
-            bodyA->velocity.x += bodyA->inverseMass*(-tangentImpulse.x);
-            bodyA->velocity.y += bodyA->inverseMass*(-tangentImpulse.y);
+    // Transform point to polygon model space, it is inside a piece if it is behind every piece face
+    Vector2 local = Mat2MultiplyVector2(Mat2Transpose(body->shape.transform), Vector2Subtract(point, body->position));
 
-            if (!bodyA->freezeOrient) bodyA->angularVelocity += bodyA->inverseInertia*MathCrossVector2(radiusA, (Vector2){ -tangentImpulse.x, -tangentImpulse.y });
-        }
+    for (int i = 0; i < body->shape.piecesCount; i++)
+    {
+        PolygonData *data = &body->shape.vertexData[i];
+        bool inside = true;
 
-        if (bodyB->enabled)
-        {
-            bodyB->velocity.x += bodyB->inverseMass*(tangentImpulse.x);
-            bodyB->velocity.y += bodyB->inverseMass*(tangentImpulse.y);
+        for (int j = 0; (j < data->vertexCount) && inside; j++) inside = (MathDot(data->normals[j], Vector2Subtract(local, data->positions[j])) <= 0.0f);
 
-            if (!bodyB->freezeOrient) bodyB->angularVelocity += bodyB->inverseInertia*MathCrossVector2(radiusB, tangentImpulse);
-        }
+        if (inside) return true;
     }
+
+    return false;
 }
 
-// Integrates physics velocity into position and forces
-static void IntegratePhysicsVelocity(PhysicsBody body)
+// Returns true if a ray hits a physics body shape from outside before max distance
+// NOTE: Polygons clip ray against every face plane, entering face gives hit normal
+static bool RaycastPhysicsBody(PhysicsBody body, Vector2 origin, Vector2 direction, float maxDistance, float *distance, Vector2 *normal)
 {
-    if ((body == NULL) ||!body->enabled) return;
+    if (body->shape.type == PHYSICS_CIRCLE)
+    {
+        Vector2 offset = Vector2Subtract(origin, body->position);
+        float b = MathDot(offset, direction);
+        float c = MathLenSqr(offset) - body->shape.radius*body->shape.radius;
 
-    body->position.x += body->velocity.x*deltaTime;
-    body->position.y += body->velocity.y*deltaTime;
+        if ((c <= 0.0f) || (b > 0.0f)) return false;     // Origin inside circle or ray pointing away
 
-    if (!body->freezeOrient) body->orient += body->angularVelocity*deltaTime;
-    Mat2Set(&body->shape.transform, body->orient);
+        float discriminant = b*b - c;
+        if (discriminant < 0.0f) return false;
 
-    IntegratePhysicsForces(body);
-}
+        float hit = -b - sqrtf(discriminant);
+        if (hit > maxDistance) return false;
 
-// Corrects physics bodies positions based on manifolds collision information
-static void CorrectPhysicsPositions(PhysicsManifold manifold)
-{
-    PhysicsBody bodyA = manifold->bodyA;
-    PhysicsBody bodyB = manifold->bodyB;
+        *distance = hit;
+        *normal = (Vector2){ offset.x + direction.x*hit, offset.y + direction.y*hit };
+        MathNormalize(normal);
 
-    if ((bodyA == NULL) || (bodyB == NULL)) return;
+        return true;
+    }
 
-    Vector2 correction = { 0.0f, 0.0f };
-    correction.x = (max(manifold->penetration - PHYSAC_PENETRATION_ALLOWANCE, 0.0f)/(bodyA->inverseMass + bodyB->inverseMass))*manifold->normal.x*PHYSAC_PENETRATION_CORRECTION;
-    correction.y = (max(manifold->penetration - PHYSAC_PENETRATION_ALLOWANCE, 0.0f)/(bodyA->inverseMass + bodyB->inverseMass))*manifold->normal.y*PHYSAC_PENETRATION_CORRECTION;
+    Matrix2x2 transpose = Mat2Transpose(body->shape.transform);
+    Vector2 localOrigin = Mat2MultiplyVector2(transpose, Vector2Subtract(origin, body->position));
+    Vector2 localDirection = Mat2MultiplyVector2(transpose, direction);
+    bool hit = false;
 
-    if (bodyA->enabled)
+    // Compound shapes return closest piece hit
+    for (int i = 0; i < body->shape.piecesCount; i++)
     {
-        bodyA->position.x -= correction.x*bodyA->inverseMass;
-        bodyA->position.y -= correction.y*bodyA->inverseMass;
-    }
+        PolygonData *data = &body->shape.vertexData[i];
 
-    if (bodyB->enabled)
-    {
-        bodyB->position.x += correction.x*bodyB->inverseMass;
-        bodyB->position.y += correction.y*bodyB->inverseMass;
+        float lower = 0.0f;
+        float upper = maxDistance;
+        int face = -1;
+
+        for (int j = 0; (j < data->vertexCount) && (lower <= upper); j++)
+        {
+            float numerator = MathDot(data->normals[j], Vector2Subtract(data->positions[j], localOrigin));
+            float denominator = MathDot(data->normals[j], localDirection);
+
+            if (denominator == 0.0f)
+            {
+                if (numerator < 0.0f) upper = -1.0f;        // Ray parallel to face and outside of it
+            }
+            else if ((denominator < 0.0f) && (numerator < lower*denominator))
+            {
+                lower = numerator/denominator;              // Ray enters face half plane
+                face = j;
+            }
+            else if ((denominator > 0.0f) && (numerator < upper*denominator)) upper = numerator/denominator;    // Ray leaves face half plane
+        }
+
+        if ((upper < lower) || (face < 0)) continue;        // Ray misses piece or origin inside piece
+
+        maxDistance = lower;
+        hit = true;
+        *distance = lower;
+        *normal = Mat2MultiplyVector2(body->shape.transform, data->normals[face]);
     }
+
+    return hit;
 }
 
-// Returns the extreme point along a direction within a polygon
-static Vector2 GetSupport(PhysicsShape shape, Vector2 dir)
+// Returns true if a ray hits a bounding box before max distance
+static bool RaycastBounds(Vector2 origin, Vector2 direction, float maxDistance, Vector2 min, Vector2 max)
 {
-    float bestProjection = -PHYSAC_FLT_MAX;
-    Vector2 bestVertex = { 0.0f, 0.0f };
-    PolygonData data = shape.vertexData;
+    float lower = 0.0f;
+    float upper = maxDistance;
 
-    for (int i = 0; i < data.vertexCount; i++)
-    {
-        Vector2 vertex = data.positions[i];
-        float projection = MathDot(vertex, dir);
+    float originAxis[2] = { origin.x, origin.y };
+    float directionAxis[2] = { direction.x, direction.y };
+    float minAxis[2] = { min.x, min.y };
+    float maxAxis[2] = { max.x, max.y };
 
-        if (projection > bestProjection)
+    for (int i = 0; i < 2; i++)
+    {
+        if (directionAxis[i] == 0.0f)
         {
-            bestVertex = vertex;
-            bestProjection = projection;
+            if ((originAxis[i] < minAxis[i]) || (originAxis[i] > maxAxis[i])) return false;
+        }
+        else
+        {
+            float inverse = 1.0f/directionAxis[i];
+            float enter = (minAxis[i] - originAxis[i])*inverse;
+            float leave = (maxAxis[i] - originAxis[i])*inverse;
+
+            if (enter > leave)
+            {
+                float swap = enter;
+                enter = leave;
+                leave = swap;
+            }
+
+            lower = max(lower, enter);
+            upper = min(upper, leave);
+
+            if (lower > upper) return false;
         }
     }
 
-    return bestVertex;
+    return true;
+}
+
+// Returns the perimeter of a bounding box
+static float BoundsPerimeter(Vector2 min, Vector2 max)
+{
+    return 2.0f*((max.x - min.x) + (max.y - min.y));
 }
 
 // Finds polygon shapes axis least penetration
+// NOTE: Support point of B shape along -n is the vertex with minimum projection over n, so every face only
+// needs a minimum of B vertices projections, computed with SIMD over B vertices in SoA layout
 static float FindAxisLeastPenetration(int *faceIndex, PhysicsShape shapeA, PhysicsShape shapeB)
 {
     float bestDistance = -PHYSAC_FLT_MAX;
     int bestIndex = 0;
 
-    PolygonData dataA = shapeA.vertexData;
-    //PolygonData dataB = shapeB.vertexData;
+    PolygonData *dataA = shapeA.vertexData;
+    PolygonData *dataB = shapeB.vertexData;
+
+    // Store B shape vertices in SoA layout, padded to SIMD width repeating first vertex (minimum does not change)
+    float verticesX[PHYSAC_MAX_VERTICES + PHYSAC_SIMD_WIDTH];
+    float verticesY[PHYSAC_MAX_VERTICES + PHYSAC_SIMD_WIDTH];
+    int count = ((dataB->vertexCount + PHYSAC_SIMD_WIDTH - 1)/PHYSAC_SIMD_WIDTH)*PHYSAC_SIMD_WIDTH;
+
+    for (int i = 0; i < count; i++)
+    {
+        Vector2 vertex = dataB->positions[(i < dataB->vertexCount) ? i : 0];
+        verticesX[i] = vertex.x;
+        verticesY[i] = vertex.y;
+    }
 
-    for (int i = 0; i < dataA.vertexCount; i++)
+    Matrix2x2 buT = Mat2Transpose(shapeB.transform);
+
+    for (int i = 0; i < dataA->vertexCount; i++)
     {
         // Retrieve a face normal from A shape
-        Vector2 normal = dataA.normals[i];
+        Vector2 normal = dataA->normals[i];
         Vector2 transNormal = Mat2MultiplyVector2(shapeA.transform, normal);
 
         // Transform face normal into B shape's model space
-        Matrix2x2 buT = Mat2Transpose(shapeB.transform);
         normal = Mat2MultiplyVector2(buT, transNormal);
 
-        // Retrieve support point from B shape along -n
-        Vector2 support = GetSupport(shapeB, (Vector2){ -normal.x, -normal.y });
-
         // Retrieve vertex on face from A shape, transform into B shape's model space
-        Vector2 vertex = dataA.positions[i];
+        Vector2 vertex = dataA->positions[i];
         vertex = Mat2MultiplyVector2(shapeA.transform, vertex);
         vertex = Vector2Add(vertex, shapeA.body->position);
         vertex = Vector2Subtract(vertex, shapeB.body->position);
         vertex = Mat2MultiplyVector2(buT, vertex);
 
         // Compute penetration distance in B shape's model space
-        float distance = MathDot(normal, Vector2Subtract(support, vertex));
+        float distance = FindMinProjection(verticesX, verticesY, count, normal) - MathDot(normal, vertex);
 
         // Store greatest distance
         if (distance > bestDistance)
@@ -1812,13 +6142,52 @@ static float FindAxisLeastPenetration(int *faceIndex, PhysicsShape shapeA, Physi
     return bestDistance;
 }
 
+// Returns minimum projection over a direction of a SoA vertex block (count multiple of SIMD width)
+static float FindMinProjection(const float *x, const float *y, int count, Vector2 direction)
+{
+    float result = PHYSAC_FLT_MAX;
+
+#if defined(PHYSAC_SIMD_SSE)
+    __m128 dirX = _mm_set1_ps(direction.x);
+    __m128 dirY = _mm_set1_ps(direction.y);
+    __m128 minimum = _mm_set1_ps(PHYSAC_FLT_MAX);
+
+    for (int i = 0; i < count; i += PHYSAC_SIMD_WIDTH)
+    {
+        __m128 projection = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&x[i]), dirX), _mm_mul_ps(_mm_loadu_ps(&y[i]), dirY));
+        minimum = _mm_min_ps(minimum, projection);
+    }
+
+    float lanes[PHYSAC_SIMD_WIDTH];
+    _mm_storeu_ps(lanes, minimum);
+    for (int i = 0; i < PHYSAC_SIMD_WIDTH; i++) result = min(result, lanes[i]);
+#elif defined(PHYSAC_SIMD_WASM)
+    v128_t dirX = wasm_f32x4_splat(direction.x);
+    v128_t dirY = wasm_f32x4_splat(direction.y);
+    v128_t minimum = wasm_f32x4_splat(PHYSAC_FLT_MAX);
+
+    for (int i = 0; i < count; i += PHYSAC_SIMD_WIDTH)
+    {
+        v128_t projection = wasm_f32x4_add(wasm_f32x4_mul(wasm_v128_load(&x[i]), dirX), wasm_f32x4_mul(wasm_v128_load(&y[i]), dirY));
+        minimum = wasm_f32x4_min(minimum, projection);
+    }
+
+    result = min(min(wasm_f32x4_extract_lane(minimum, 0), wasm_f32x4_extract_lane(minimum, 1)),
+                 min(wasm_f32x4_extract_lane(minimum, 2), wasm_f32x4_extract_lane(minimum, 3)));
+#else
+    for (int i = 0; i < count; i++) result = min(result, x[i]*direction.x + y[i]*direction.y);
+#endif
+
+    return result;
+}
+
 // Finds two polygon shapes incident face
-static void FindIncidentFace(Vector2 *v0, Vector2 *v1, PhysicsShape ref, PhysicsShape inc, int index)
+static void FindIncidentFace(PhysicsClipVertex *v0, PhysicsClipVertex *v1, PhysicsShape ref, PhysicsShape inc, int index)
 {
-    PolygonData refData = ref.vertexData;
-    PolygonData incData = inc.vertexData;
+    PolygonData *refData = ref.vertexData;
+    PolygonData *incData = inc.vertexData;
 
-    Vector2 referenceNormal = refData.normals[index];
+    Vector2 referenceNormal = refData->normals[index];
 
     // Calculate normal in incident's frame of reference
     referenceNormal = Mat2MultiplyVector2(ref.transform, referenceNormal); // To world space
@@ -1828,9 +6197,9 @@ static void FindIncidentFace(Vector2 *v0, Vector2 *v1, PhysicsShape ref, Physics
     int incidentFace = 0;
     float minDot = PHYSAC_FLT_MAX;
 
-    for (int i = 0; i < incData.vertexCount; i++)
+    for (int i = 0; i < incData->vertexCount; i++)
     {
-        float dot = MathDot(referenceNormal, incData.normals[i]);
+        float dot = MathDot(referenceNormal, incData->normals[i]);
 
         if (dot < minDot)
         {
@@ -1840,22 +6209,25 @@ static void FindIncidentFace(Vector2 *v0, Vector2 *v1, PhysicsShape ref, Physics
     }
 
     // Assign face vertices for incident face
-    *v0 = Mat2MultiplyVector2(inc.transform, incData.positions[incidentFace]);
-    *v0 = Vector2Add(*v0, inc.body->position);
-    incidentFace = (((incidentFace + 1) < incData.vertexCount) ? (incidentFace + 1) : 0);
-    *v1 = Mat2MultiplyVector2(inc.transform, incData.positions[incidentFace]);
-    *v1 = Vector2Add(*v1, inc.body->position);
+    v0->position = Mat2MultiplyVector2(inc.transform, incData->positions[incidentFace]);
+    v0->position = Vector2Add(v0->position, inc.body->position);
+    v0->feature = incidentFace;
+    incidentFace = (((incidentFace + 1) < incData->vertexCount) ? (incidentFace + 1) : 0);
+    v1->position = Mat2MultiplyVector2(inc.transform, incData->positions[incidentFace]);
+    v1->position = Vector2Add(v1->position, inc.body->position);
+    v1->feature = incidentFace;
 }
 
 // Calculates clipping based on a normal and two faces
-static int Clip(Vector2 normal, float clip, Vector2 *faceA, Vector2 *faceB)
+// NOTE: Intersection point takes clipping plane feature, kept vertices keep their features
+static int Clip(Vector2 normal, float clip, PhysicsClipVertex *faceA, PhysicsClipVertex *faceB, unsigned int feature)
 {
     int sp = 0;
-    Vector2 out[2] = { *faceA, *faceB };
+    PhysicsClipVertex out[2] = { *faceA, *faceB };
 
     // Retrieve distances from each endpoint to the line
-    float distanceA = MathDot(normal, *faceA) - clip;
-    float distanceB = MathDot(normal, *faceB) - clip;
+    float distanceA = MathDot(normal, faceA->position) - clip;
+    float distanceB = MathDot(normal, faceB->position) - clip;
 
     // If negative (behind plane)
     if (distanceA <= 0.0f) out[sp++] = *faceA;
@@ -1866,11 +6238,12 @@ static int Clip(Vector2 normal, float clip, Vector2 *faceA, Vector2 *faceB)
     {
         // Push intersection point
         float alpha = distanceA/(distanceA - distanceB);
-        out[sp] = *faceA;
-        Vector2 delta = Vector2Subtract(*faceB, *faceA);
+        out[sp].position = faceA->position;
+        Vector2 delta = Vector2Subtract(faceB->position, faceA->position);
         delta.x *= alpha;
         delta.y *= alpha;
-        out[sp] = Vector2Add(out[sp], delta);
+        out[sp].position = Vector2Add(out[sp].position, delta);
+        out[sp].feature = feature;
         sp++;
     }
 
@@ -1901,7 +6274,9 @@ static Vector2 TriangleBarycenter(Vector2 v1, Vector2 v2, Vector2 v3)
 // Initializes hi-resolution MONOTONIC timer
 static void InitTimer(void)
 {
+#if !defined(PHYSAC_DETERMINISTIC)
     srand(time(NULL));              // Initialize random seed
+#endif
 
 #if defined(_WIN32)
     QueryPerformanceFrequency((unsigned long long int *) &frequency);
@@ -1919,7 +6294,6 @@ static void InitTimer(void)
 #endif
 
     baseTime = GetTimeCount();      // Get MONOTONIC clock time offset
-    startTime = GetCurrentTime();   // Get current time
 }
 
 // Get hi-res MONOTONIC time measure in seconds
@@ -1931,7 +6305,7 @@ static uint64_t GetTimeCount(void)
     QueryPerformanceCounter((unsigned long long int *) &value);
 #endif
 
-#if defined(__linux__)
+#if defined(__EMSCRIPTEN__) || defined(__linux__)
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
     value = (uint64_t)now.tv_sec*(uint64_t)1000000000 + (uint64_t)now.tv_nsec;
@@ -1950,6 +6324,37 @@ static double GetCurrentTime(void)
     return (double)(GetTimeCount() - baseTime)/frequency*1000;
 }
 
+#if defined(PHYSAC_STATS)
+// Stores current time as physics step phase start time
+static void BeginPhysicsStatsPhase(int phase)
+{
+    physicsWorld->phasesStart[phase] = GetCurrentTime();
+}
+
+// Accumulates elapsed time since physics step phase start time
+// NOTE: Integrate phase runs in several parts every step, all of them are accumulated
+static void EndPhysicsStatsPhase(int phase)
+{
+    physicsWorld->stats.phaseTime[phase] += GetCurrentTime() - physicsWorld->phasesStart[phase];
+}
+#endif
+
+// Initializes data shared by all physics worlds (timer, random seed and circle vertices), only once
+// NOTE: Timer offset is never reset, so physics worlds running in other threads keep a consistent time
+static void InitPhysicsGlobals(void)
+{
+    if (frequency != 0) return;
+
+    InitTimer();
+    InitCircleVertices();
+}
+
+// Initializes circle shape vertices table of unit radius
+static void InitCircleVertices(void)
+{
+    for (int i = 0; i < PHYSAC_CIRCLE_VERTICES; i++) MathSinCos(360.0f/PHYSAC_CIRCLE_VERTICES*i*PHYSAC_DEG2RAD, &circleVertices[i].y, &circleVertices[i].x);
+}
+
 // Returns the cross product of a vector and a value
 static inline Vector2 MathCross(float value, Vector2 vector)
 {
@@ -1997,6 +6402,32 @@ static void MathNormalize(Vector2 *vector)
     vector->y *= ilength;
 }
 
+// Computes sine and cosine of an angle in radians
+// NOTE: Deterministic mode reduces angle to [-pi/4, pi/4] with pi/2 split in three parts (Cody-Waite) and evaluates
+// minimax polynomials, so results do not depend on C library implementation
+static void MathSinCos(float radians, float *sine, float *cosine)
+{
+#if defined(PHYSAC_DETERMINISTIC)
+    float quadrant = floorf(radians*0.636619772f + 0.5f);
+    float x = ((radians - quadrant*1.5703125f) - quadrant*4.837512969970703125e-4f) - quadrant*7.54978995489188216e-8f;
+    float z = x*x;
+
+    float s = ((-1.9515295891e-4f*z + 8.3321608736e-3f)*z - 1.6666654611e-1f)*z*x + x;
+    float c = ((2.443315711809948e-5f*z - 1.388731625493765e-3f)*z + 4.166664568298827e-2f)*z*z - 0.5f*z + 1.0f;
+
+    switch (((int)quadrant) & 3)
+    {
+        case 0: *sine = s; *cosine = c; break;
+        case 1: *sine = c; *cosine = -s; break;
+        case 2: *sine = -s; *cosine = -c; break;
+        default: *sine = -c; *cosine = s; break;
+    }
+#else
+    *sine = sinf(radians);
+    *cosine = cosf(radians);
+#endif
+}
+
 #if defined(PHYSAC_STANDALONE)
 // Returns the sum of two given vectors
 static inline Vector2 Vector2Add(Vector2 v1, Vector2 v2)
@@ -2014,8 +6445,9 @@ static inline Vector2 Vector2Subtract(Vector2 v1, Vector2 v2)
 // Creates a matrix 2x2 from a given radians value
 static Matrix2x2 Mat2Radians(float radians)
 {
-    float c = cosf(radians);
-    float s = sinf(radians);
+    float c = 0.0f;
+    float s = 0.0f;
+    MathSinCos(radians, &s, &c);
 
     return (Matrix2x2){ c, -s, s, c };
 }
@@ -2023,8 +6455,9 @@ static Matrix2x2 Mat2Radians(float radians)
 // Set values from radians to a created matrix 2x2
 static void Mat2Set(Matrix2x2 *matrix, float radians)
 {
-    float cos = cosf(radians);
-    float sin = sinf(radians);
+    float cos = 0.0f;
+    float sin = 0.0f;
+    MathSinCos(radians, &sin, &cos);
 
     matrix->m00 = cos;
     matrix->m01 = -sin;
@@ -2044,4 +6477,8 @@ static inline Vector2 Mat2MultiplyVector2(Matrix2x2 matrix, Vector2 vector)
     return (Vector2){ matrix.m00*vector.x + matrix.m01*vector.y, matrix.m10*vector.x + matrix.m11*vector.y };
 }
 
+#if defined(PHYSAC_DETERMINISTIC) && defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC pop_options
+#endif
+
 #endif  // PHYSAC_IMPLEMENTATION
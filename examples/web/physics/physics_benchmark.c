@@ -0,0 +1,342 @@
+/*******************************************************************************************
+*
+*   Physac - Headless benchmark
+*
+*   NOTE 1: Benchmark runs without window and threads (PHYSAC_STANDALONE and PHYSAC_NO_THREADS),
+*           steps are run back to back with fixed time step so results only depend on the scene.
+*   NOTE 2: Every physics step phase is timed by physac statistics (PHYSAC_STATS), read with GetPhysicsStats().
+*   NOTE 3: Final state hash (bodies positions, rotations and velocities) must match between runs,
+*           compare it to check that an optimization does not change simulation results.
+*
+*   Use the following line to compile:
+*
+*   gcc -o physics_benchmark physics_benchmark.c -std=c99 -O2 -D_DEFAULT_SOURCE -lm
+*
+*   Usage: physics_benchmark [stack|pile|shatter|grid|all] [bodies] [steps] [hashFile]
+*
+*   Copyright (c) 2026 Physac contributors
+*
+********************************************************************************************/
+
+#include <stdio.h>                  // Required for: printf(), fprintf(), fopen(), fclose()
+#include <stdlib.h>                 // Required for: atoi(), malloc(), free()
+#include <string.h>                 // Required for: strcmp()
+
+#define PHYSAC_STANDALONE
+#define PHYSAC_STATS
+#define PHYSAC_NO_THREADS
+#define PHYSAC_IMPLEMENTATION
+#include "physac.h"
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define DEFAULT_BODIES          200         // Default bodies created by a scene
+#define DEFAULT_STEPS           2000        // Default physics steps simulated by a scene
+#define SHATTER_INTERVAL        300         // Steps between shatter cascade waves
+#define SHATTER_MIN_MASS        40.0f       // Minimum mass of a polygon to be shattered again
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct BenchmarkResult {
+    double phaseTime[PHYSICS_PHASE_COUNT];  // Total time spent in every physics step phase (milliseconds)
+    double totalTime;                       // Total time spent in physics steps (milliseconds)
+    unsigned long long pairs;               // Total broad-phase pairs tested over all steps
+    unsigned long long manifolds;           // Total manifolds in contact over all steps
+    unsigned long long contacts;            // Total contact points over all steps
+    unsigned long long iterations;          // Total contact solver iterations over all steps
+    unsigned int allocations;               // Total pools allocations while stepping
+    unsigned int peakMemory;                // Peak physac dynamic memory (bytes)
+    int bodies;                             // Physics bodies alive at the end of the scene
+    unsigned int hash;                      // Final state hash
+} BenchmarkResult;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const char *phaseNames[PHYSICS_PHASE_COUNT] = { "broad", "narrow", "solve", "integrate", "correct" };
+static const char *sceneNames[] = { "stack", "pile", "shatter", "grid" };
+
+static unsigned int randomSeed = 1;                         // Scenes random generator state, reset by every scene
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+static float GetRandomFloat(float min, float max);          // Returns a deterministic pseudo-random value between min and max
+static void CreateGround(float width);                      // Creates a static ground rectangle
+static void CreateStackScene(int count);                    // Creates box stacks, 10 boxes height
+static void CreatePileScene(int count);                     // Creates circles falling into a box
+static void CreateShatterScene(int count);                  // Creates big polygons shattered in waves
+static void CreateGridScene(int count);                     // Creates a grid of bodies moving without gravity inside walls
+static void ShatterBodies(void);                            // Shatters every dynamic polygon heavier than SHATTER_MIN_MASS
+static unsigned int HashPhysicsState(void);                 // Returns FNV-1a hash of bodies positions, rotations and velocities
+static BenchmarkResult RunScene(int scene, int bodies, int steps);  // Runs a scene and returns its measures
+
+//----------------------------------------------------------------------------------
+// Program Main Entry Point
+//----------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    int scene = -1;                 // All scenes by default
+    int bodies = DEFAULT_BODIES;
+    int steps = DEFAULT_STEPS;
+    const char *hashFileName = NULL;
+
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "all") != 0)
+        {
+            for (int i = 0; i < 4; i++) if (strcmp(argv[1], sceneNames[i]) == 0) scene = i;
+
+            if (scene < 0)
+            {
+                fprintf(stderr, "Usage: %s [stack|pile|shatter|grid|all] [bodies] [steps] [hashFile]\n", argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if (argc > 2) bodies = atoi(argv[2]);
+    if (argc > 3) steps = atoi(argv[3]);
+    if (argc > 4) hashFileName = argv[4];
+
+    FILE *hashFile = NULL;
+
+    if (hashFileName != NULL)
+    {
+        hashFile = fopen(hashFileName, "w");
+        if (hashFile == NULL) fprintf(stderr, "Could not open hash file: %s\n", hashFileName);
+    }
+
+    printf("%-8s %7s %6s %10s", "scene", "bodies", "steps", "ns/step");
+    for (int i = 0; i < PHYSICS_PHASE_COUNT; i++) printf(" %10s", phaseNames[i]);
+    printf(" %9s %9s %9s %9s %6s %10s %8s\n", "pairs", "manifolds", "contacts", "iters", "allocs", "memory", "hash");
+
+    for (int i = 0; i < 4; i++)
+    {
+        if ((scene >= 0) && (scene != i)) continue;
+
+        BenchmarkResult result = RunScene(i, bodies, steps);
+
+        printf("%-8s %7i %6i %10.0f", sceneNames[i], result.bodies, steps, result.totalTime*1000000.0/steps);
+        for (int j = 0; j < PHYSICS_PHASE_COUNT; j++) printf(" %10.0f", result.phaseTime[j]*1000000.0/steps);
+        printf(" %9.1f %9.1f %9.1f %9.1f %6u %10u %08x\n", (double)result.pairs/steps, (double)result.manifolds/steps, (double)result.contacts/steps,
+               (double)result.iterations/steps, result.allocations, result.peakMemory, result.hash);
+
+        if (hashFile != NULL) fprintf(hashFile, "%s %i %i %08x\n", sceneNames[i], bodies, steps, result.hash);
+    }
+
+    if (hashFile != NULL) fclose(hashFile);
+
+    return 0;
+}
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+// Returns a deterministic pseudo-random value between min and max
+// NOTE: Linear congruential generator, scenes do not depend on C library rand()
+static float GetRandomFloat(float min, float max)
+{
+    randomSeed = randomSeed*1664525u + 1013904223u;
+
+    return min + (max - min)*(float)(randomSeed >> 8)/16777216.0f;
+}
+
+// Creates a static ground rectangle
+static void CreateGround(float width)
+{
+    PhysicsBody ground = CreatePhysicsBodyRectangle((Vector2){ 0.0f, 500.0f }, width, 100.0f, 10.0f);
+    ground->enabled = false;
+}
+
+// Creates box stacks, 10 boxes height
+static void CreateStackScene(int count)
+{
+    int columns = (count + 9)/10;
+
+    CreateGround(columns*60.0f + 100.0f);
+
+    for (int i = 0; i < count; i++)
+    {
+        float x = -columns*30.0f + (i/10)*60.0f + 30.0f;
+        float y = 430.0f - (i%10)*41.0f;
+
+        CreatePhysicsBodyRectangle((Vector2){ x, y }, 40.0f, 40.0f, 10.0f);
+    }
+}
+
+// Creates circles falling into a box
+static void CreatePileScene(int count)
+{
+    int columns = 20;
+    float width = columns*24.0f;
+
+    CreateGround(width + 100.0f);
+
+    PhysicsBody wall = CreatePhysicsBodyRectangle((Vector2){ -width/2.0f - 20.0f, 200.0f }, 40.0f, 600.0f, 10.0f);
+    wall->enabled = false;
+    wall = CreatePhysicsBodyRectangle((Vector2){ width/2.0f + 20.0f, 200.0f }, 40.0f, 600.0f, 10.0f);
+    wall->enabled = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        float x = -width/2.0f + (i%columns)*24.0f + 12.0f + GetRandomFloat(-2.0f, 2.0f);
+        float y = 400.0f - (i/columns)*24.0f;
+
+        CreatePhysicsBodyCircle((Vector2){ x, y }, GetRandomFloat(6.0f, 10.0f), 10.0f);
+    }
+}
+
+// Creates big polygons shattered in waves
+// NOTE: Every shatter wave creates a triangle per polygon side, big triangles are shattered again by next waves
+static void CreateShatterScene(int count)
+{
+    int columns = 10;
+
+    CreateGround(columns*80.0f + 100.0f);
+
+    for (int i = 0; i < count; i++)
+    {
+        float x = -columns*40.0f + (i%columns)*80.0f + 40.0f;
+        float y = 380.0f - (i/columns)*80.0f;
+
+        CreatePhysicsBodyPolygon((Vector2){ x, y }, 35.0f, 5 + i%4, 10.0f);
+    }
+}
+
+// Creates a grid of bodies moving without gravity inside walls
+static void CreateGridScene(int count)
+{
+    int columns = 1;
+    while (columns*columns < count) columns++;
+
+    float size = columns*30.0f;
+
+    SetPhysicsGravity(0.0f, 0.0f);
+
+    PhysicsBody wall = CreatePhysicsBodyRectangle((Vector2){ 0.0f, -size/2.0f - 20.0f }, size + 80.0f, 40.0f, 10.0f);
+    wall->enabled = false;
+    wall = CreatePhysicsBodyRectangle((Vector2){ 0.0f, size/2.0f + 20.0f }, size + 80.0f, 40.0f, 10.0f);
+    wall->enabled = false;
+    wall = CreatePhysicsBodyRectangle((Vector2){ -size/2.0f - 20.0f, 0.0f }, 40.0f, size, 10.0f);
+    wall->enabled = false;
+    wall = CreatePhysicsBodyRectangle((Vector2){ size/2.0f + 20.0f, 0.0f }, 40.0f, size, 10.0f);
+    wall->enabled = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        Vector2 position = { -size/2.0f + (i%columns)*30.0f + 15.0f, -size/2.0f + (i/columns)*30.0f + 15.0f };
+        PhysicsBody body = NULL;
+
+        if ((i%2) == 0) body = CreatePhysicsBodyCircle(position, 10.0f, 10.0f);
+        else body = CreatePhysicsBodyPolygon(position, 11.0f, 3 + i%6, 10.0f);
+
+        body->velocity = (Vector2){ GetRandomFloat(-0.2f, 0.2f), GetRandomFloat(-0.2f, 0.2f) };
+        body->restitution = 0.9f;
+        body->staticFriction = 0.0f;
+        body->dynamicFriction = 0.0f;
+    }
+}
+
+// Shatters every dynamic polygon heavier than SHATTER_MIN_MASS
+static void ShatterBodies(void)
+{
+    // Shattered bodies are destroyed and new bodies are appended, so only bodies alive before the wave are checked
+    int count = GetPhysicsBodiesCount();
+    unsigned int *ids = (unsigned int *)malloc(sizeof(unsigned int)*(count + 1));
+    int idsCount = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        PhysicsBody body = GetPhysicsBody(i);
+
+        if ((body != NULL) && body->enabled && (body->shape.type == PHYSICS_POLYGON) && (body->mass > SHATTER_MIN_MASS)) ids[idsCount++] = body->id;
+    }
+
+    for (int i = 0; i < idsCount; i++)
+    {
+        for (int j = 0; j < GetPhysicsBodiesCount(); j++)
+        {
+            PhysicsBody body = GetPhysicsBody(j);
+
+            if ((body != NULL) && (body->id == ids[i]))
+            {
+                PhysicsShatter(body, (Vector2){ body->position.x + 0.5f, body->position.y + 0.25f }, 2.0f*body->mass);
+                break;
+            }
+        }
+    }
+
+    free(ids);
+}
+
+// Returns FNV-1a hash of bodies positions, rotations and velocities
+static unsigned int HashPhysicsState(void)
+{
+    unsigned int hash = 2166136261u;
+
+    for (int i = 0; i < GetPhysicsBodiesCount(); i++)
+    {
+        PhysicsBody body = GetPhysicsBody(i);
+        if (body == NULL) continue;
+
+        float state[6] = { body->position.x, body->position.y, body->orient, body->velocity.x, body->velocity.y, body->angularVelocity };
+        const unsigned char *bytes = (const unsigned char *)state;
+
+        for (int j = 0; j < (int)sizeof(state); j++)
+        {
+            hash ^= bytes[j];
+            hash *= 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+// Runs a scene and returns its measures
+static BenchmarkResult RunScene(int scene, int bodies, int steps)
+{
+    BenchmarkResult result = { 0 };
+
+    randomSeed = 1;
+
+    InitPhysics();
+    SetPhysicsGravity(0.0f, 9.81f);
+
+    switch (scene)
+    {
+        case 0: CreateStackScene(bodies); break;
+        case 1: CreatePileScene(bodies); break;
+        case 2: CreateShatterScene(bodies); break;
+        case 3: CreateGridScene(bodies); break;
+        default: break;
+    }
+
+    for (int i = 0; i < steps; i++)
+    {
+        if ((scene == 2) && ((i%SHATTER_INTERVAL) == SHATTER_INTERVAL/2)) ShatterBodies();
+
+        PhysicsStep();
+
+        PhysicsStats stats = GetPhysicsStats();
+
+        for (int j = 0; j < PHYSICS_PHASE_COUNT; j++) result.phaseTime[j] += stats.phaseTime[j];
+        result.totalTime += stats.stepTime;
+        result.pairs += stats.pairsCount;
+        result.manifolds += stats.manifoldsCount;
+        result.contacts += stats.contactsCount;
+        result.iterations += stats.solverIterations;
+        result.allocations += stats.allocations;
+
+        if (stats.usedMemory > result.peakMemory) result.peakMemory = stats.usedMemory;
+    }
+
+    result.bodies = GetPhysicsBodiesCount();
+    result.hash = HashPhysicsState();
+
+    ClosePhysics();
+
+    return result;
+}
@@ -36,6 +36,10 @@ int logoY = 15;
 PhysicsBody ground = { 0 };
 PhysicsBody circle = { 0 };
 
+// Physics bodies shapes lines buffer (two vertices per shape edge)
+Vector2 *lines = NULL;
+int linesCapacity = 0;
+
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
@@ -81,6 +85,7 @@ int main(void)
     // De-Initialization
     //--------------------------------------------------------------------------------------
     ClosePhysics();       // Uninitialize physics
+    free(lines);          // Unload shapes lines buffer
 
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
@@ -95,7 +100,7 @@ void UpdateDrawFrame(void)
 {
     // Update
     //----------------------------------------------------------------------------------
-    PhysicsStep();
+    UpdatePhysicsSnapshot();    // Acquire bodies transforms published by physics thread (it runs the physics steps)
     
     if (IsKeyPressed('R'))    // Reset physics input
     {
@@ -112,13 +117,13 @@ void UpdateDrawFrame(void)
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) CreatePhysicsBodyPolygon(GetMousePosition(), GetRandomValue(20, 80), GetRandomValue(3, 8), 10);
     else if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) CreatePhysicsBodyCircle(GetMousePosition(), GetRandomValue(10, 45), 10);
 
-    // Destroy falling physics bodies
+    // Destroy falling physics bodies (positions of last step in acquired snapshot)
     int bodiesCount = GetPhysicsBodiesCount();
 
     for (int i = bodiesCount - 1; i >= 0; i--)
     {
         PhysicsBody body = GetPhysicsBody(i);
-        if (body != NULL && (body->position.y > screenHeight*2)) DestroyPhysicsBody(body);
+        if (body != NULL && (GetPhysicsBodyTransform(body, 1.0f).position.y > screenHeight*2)) DestroyPhysicsBody(body);
     }
     //----------------------------------------------------------------------------------
 
@@ -130,30 +135,19 @@ void UpdateDrawFrame(void)
 
         DrawFPS(screenWidth - 90, screenHeight - 30);
 
-        // Draw created physics bodies
-        bodiesCount = GetPhysicsBodiesCount();
-
-        for (int i = 0; i < bodiesCount; i++)
+        // Draw created physics bodies, interpolated between the two steps of acquired snapshot
+        // NOTE: GetPhysicsShapesLines() writes every shape edge as a pair of transformed vertices in one pass
+        float alpha = GetPhysicsSnapshotAlpha();
+        int linesCount = GetPhysicsShapesLinesCount();
+        if (linesCount > linesCapacity)
         {
-            PhysicsBody body = GetPhysicsBody(i);
-
-            if (body != NULL)
-            {
-                int vertexCount = GetPhysicsShapeVerticesCount(i);
-                for (int j = 0; j < vertexCount; j++)
-                {
-                    // Get physics bodies shape vertices to draw lines
-                    // Note: GetPhysicsShapeVertex() already calculates rotation transformations
-                    Vector2 vertexA = GetPhysicsShapeVertex(body, j);
-
-                    int jj = (((j + 1) < vertexCount) ? (j + 1) : 0);   // Get next vertex or first to close the shape
-                    Vector2 vertexB = GetPhysicsShapeVertex(body, jj);
-
-                    DrawLineV(vertexA, vertexB, GREEN);     // Draw a line between two vertex positions
-                }
-            }
+            lines = (Vector2 *)realloc(lines, linesCount*sizeof(Vector2));
+            linesCapacity = linesCount;
         }
 
+        linesCount = GetPhysicsShapesLines(lines, linesCapacity, NULL, alpha);
+        for (int i = 0; i < linesCount; i += 2) DrawLineV(lines[i], lines[i + 1], GREEN);     // Draw a line between two vertex positions
+
         DrawText("Left mouse button to create a polygon", 10, 10, 10, WHITE);
         DrawText("Right mouse button to create a circle", 10, 25, 10, WHITE);
         DrawText("Press 'R' to reset example", 10, 40, 10, WHITE);
@@ -36,6 +36,10 @@ int logoY = 15;
 PhysicsBody bodyA = { 0 };
 PhysicsBody bodyB = { 0 };
 
+// Physics bodies shapes lines buffer (two vertices per shape edge)
+Vector2 *lines = NULL;
+int linesCapacity = 0;
+
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
@@ -101,6 +105,7 @@ int main(void)
     // De-Initialization
     //--------------------------------------------------------------------------------------
     ClosePhysics();       // Uninitialize physics
+    free(lines);          // Unload shapes lines buffer
 
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
@@ -115,7 +120,7 @@ void UpdateDrawFrame(void)
 {
     // Update
     //----------------------------------------------------------------------------------
-    PhysicsStep();
+    UpdatePhysicsSnapshot();    // Acquire bodies transforms published by physics thread (it runs the physics steps)
     
     if (IsKeyPressed('R'))    // Reset physics input
     {
@@ -140,34 +145,29 @@ void UpdateDrawFrame(void)
 
         DrawFPS(screenWidth - 90, screenHeight - 30);
 
-        // Draw created physics bodies
-        int bodiesCount = GetPhysicsBodiesCount();
-        for (int i = 0; i < bodiesCount; i++)
+        // Draw created physics bodies, interpolated between the two steps of acquired snapshot
+        // NOTE: GetPhysicsShapesLines() writes every shape edge as a pair of transformed vertices in one pass
+        float alpha = GetPhysicsSnapshotAlpha();
+        int linesCount = GetPhysicsShapesLinesCount();
+        if (linesCount > linesCapacity)
         {
-            PhysicsBody body = GetPhysicsBody(i);
-
-            if (body != NULL)
-            {
-                int vertexCount = GetPhysicsShapeVerticesCount(i);
-                for (int j = 0; j < vertexCount; j++)
-                {
-                    // Get physics bodies shape vertices to draw lines
-                    // Note: GetPhysicsShapeVertex() already calculates rotation transformations
-                    Vector2 vertexA = GetPhysicsShapeVertex(body, j);
-
-                    int jj = (((j + 1) < vertexCount) ? (j + 1) : 0);   // Get next vertex or first to close the shape
-                    Vector2 vertexB = GetPhysicsShapeVertex(body, jj);
-
-                    DrawLineV(vertexA, vertexB, GREEN);     // Draw a line between two vertex positions
-                }
-            }
+            lines = (Vector2 *)realloc(lines, linesCount*sizeof(Vector2));
+            linesCapacity = linesCount;
         }
 
+        linesCount = GetPhysicsShapesLines(lines, linesCapacity, NULL, alpha);
+        for (int i = 0; i < linesCount; i += 2) DrawLineV(lines[i], lines[i + 1], GREEN);     // Draw a line between two vertex positions
+
         DrawRectangle(0, screenHeight - 49, screenWidth, 49, BLACK);
 
         DrawText("Friction amount", (screenWidth - MeasureText("Friction amount", 30))/2, 75, 30, WHITE);
-        DrawText("0.1", bodyA->position.x - MeasureText("0.1", 20)/2, bodyA->position.y - 7, 20, WHITE);
-        DrawText("1", bodyB->position.x - MeasureText("1", 20)/2, bodyB->position.y - 7, 20, WHITE);
+
+        // Draw labels at bodies positions interpolated from acquired snapshot
+        Vector2 positionA = GetPhysicsBodyTransform(bodyA, alpha).position;
+        Vector2 positionB = GetPhysicsBodyTransform(bodyB, alpha).position;
+
+        DrawText("0.1", positionA.x - MeasureText("0.1", 20)/2, positionA.y - 7, 20, WHITE);
+        DrawText("1", positionB.x - MeasureText("1", 20)/2, positionB.y - 7, 20, WHITE);
 
         DrawText("Press 'R' to reset example", 10, 10, 10, WHITE);
 
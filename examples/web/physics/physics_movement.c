@@ -37,6 +37,10 @@ int logoY = 15;
 
 PhysicsBody body = { 0 };
 
+// Physics bodies shapes lines buffer (two vertices per shape edge)
+Vector2 *lines = NULL;
+int linesCapacity = 0;
+
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
@@ -93,6 +97,7 @@ int main(void)
     // De-Initialization
     //--------------------------------------------------------------------------------------
     ClosePhysics();       // Uninitialize physics
+    free(lines);          // Unload shapes lines buffer
 
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
@@ -107,7 +112,7 @@ void UpdateDrawFrame(void)
 {
     // Update
     //----------------------------------------------------------------------------------
-    PhysicsStep();
+    UpdatePhysicsSnapshot();    // Acquire bodies transforms published by physics thread (it runs the physics steps)
 
     if (IsKeyPressed('R'))    // Reset physics input
     {
@@ -133,26 +138,19 @@ void UpdateDrawFrame(void)
 
         DrawFPS(screenWidth - 90, screenHeight - 30);
 
-        // Draw created physics bodies
-        int bodiesCount = GetPhysicsBodiesCount();
-        for (int i = 0; i < bodiesCount; i++)
+        // Draw created physics bodies, interpolated between the two steps of acquired snapshot
+        // NOTE: GetPhysicsShapesLines() writes every shape edge as a pair of transformed vertices in one pass
+        float alpha = GetPhysicsSnapshotAlpha();
+        int linesCount = GetPhysicsShapesLinesCount();
+        if (linesCount > linesCapacity)
         {
-            PhysicsBody body = GetPhysicsBody(i);
-
-            int vertexCount = GetPhysicsShapeVerticesCount(i);
-            for (int j = 0; j < vertexCount; j++)
-            {
-                // Get physics bodies shape vertices to draw lines
-                // Note: GetPhysicsShapeVertex() already calculates rotation transformations
-                Vector2 vertexA = GetPhysicsShapeVertex(body, j);
-
-                int jj = (((j + 1) < vertexCount) ? (j + 1) : 0);   // Get next vertex or first to close the shape
-                Vector2 vertexB = GetPhysicsShapeVertex(body, jj);
-
-                DrawLineV(vertexA, vertexB, GREEN);     // Draw a line between two vertex positions
-            }
+            lines = (Vector2 *)realloc(lines, linesCount*sizeof(Vector2));
+            linesCapacity = linesCount;
         }
 
+        linesCount = GetPhysicsShapesLines(lines, linesCapacity, NULL, alpha);
+        for (int i = 0; i < linesCount; i += 2) DrawLineV(lines[i], lines[i + 1], GREEN);     // Draw a line between two vertex positions
+
         DrawText("Use 'ARROWS' to move player", 10, 10, 10, WHITE);
         DrawText("Press 'R' to reset example", 10, 30, 10, WHITE);
 
@@ -37,6 +37,10 @@ PhysicsBody circleA = { 0 };
 PhysicsBody circleB = { 0 };
 PhysicsBody circleC = { 0 };
 
+// Physics bodies shapes lines buffer (two vertices per shape edge)
+Vector2 *lines = NULL;
+int linesCapacity = 0;
+
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
@@ -87,6 +91,7 @@ int main(void)
     // De-Initialization
     //--------------------------------------------------------------------------------------
     ClosePhysics();       // Uninitialize physics
+    free(lines);          // Unload shapes lines buffer
 
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
@@ -101,7 +106,7 @@ void UpdateDrawFrame(void)
 {
     // Update
     //----------------------------------------------------------------------------------
-    PhysicsStep();
+    UpdatePhysicsSnapshot();    // Acquire bodies transforms published by physics thread (it runs the physics steps)
 
     if (IsKeyPressed('R'))    // Reset physics input
     {
@@ -123,30 +128,29 @@ void UpdateDrawFrame(void)
 
         DrawFPS(screenWidth - 90, screenHeight - 30);
 
-        // Draw created physics bodies
-        int bodiesCount = GetPhysicsBodiesCount();
-        for (int i = 0; i < bodiesCount; i++)
+        // Draw created physics bodies, interpolated between the two steps of acquired snapshot
+        // NOTE: GetPhysicsShapesLines() writes every shape edge as a pair of transformed vertices in one pass
+        float alpha = GetPhysicsSnapshotAlpha();
+        int linesCount = GetPhysicsShapesLinesCount();
+        if (linesCount > linesCapacity)
         {
-            PhysicsBody body = GetPhysicsBody(i);
+            lines = (Vector2 *)realloc(lines, linesCount*sizeof(Vector2));
+            linesCapacity = linesCount;
+        }
 
-            int vertexCount = GetPhysicsShapeVerticesCount(i);
-            for (int j = 0; j < vertexCount; j++)
-            {
-                // Get physics bodies shape vertices to draw lines
-                // Note: GetPhysicsShapeVertex() already calculates rotation transformations
-                Vector2 vertexA = GetPhysicsShapeVertex(body, j);
+        linesCount = GetPhysicsShapesLines(lines, linesCapacity, NULL, alpha);
+        for (int i = 0; i < linesCount; i += 2) DrawLineV(lines[i], lines[i + 1], GREEN);     // Draw a line between two vertex positions
 
-                int jj = (((j + 1) < vertexCount) ? (j + 1) : 0);   // Get next vertex or first to close the shape
-                Vector2 vertexB = GetPhysicsShapeVertex(body, jj);
+        DrawText("Restitution amount", (screenWidth - MeasureText("Restitution amount", 30))/2, 75, 30, WHITE);
 
-                DrawLineV(vertexA, vertexB, GREEN);     // Draw a line between two vertex positions
-            }
-        }
+        // Draw labels at bodies positions interpolated from acquired snapshot
+        Vector2 positionA = GetPhysicsBodyTransform(circleA, alpha).position;
+        Vector2 positionB = GetPhysicsBodyTransform(circleB, alpha).position;
+        Vector2 positionC = GetPhysicsBodyTransform(circleC, alpha).position;
 
-        DrawText("Restitution amount", (screenWidth - MeasureText("Restitution amount", 30))/2, 75, 30, WHITE);
-        DrawText("0", circleA->position.x - MeasureText("0", 20)/2, circleA->position.y - 7, 20, WHITE);
-        DrawText("0.5", circleB->position.x - MeasureText("0.5", 20)/2, circleB->position.y - 7, 20, WHITE);
-        DrawText("1", circleC->position.x - MeasureText("1", 20)/2, circleC->position.y - 7, 20, WHITE);
+        DrawText("0", positionA.x - MeasureText("0", 20)/2, positionA.y - 7, 20, WHITE);
+        DrawText("0.5", positionB.x - MeasureText("0.5", 20)/2, positionB.y - 7, 20, WHITE);
+        DrawText("1", positionC.x - MeasureText("1", 20)/2, positionC.y - 7, 20, WHITE);
 
         DrawText("Press 'R' to reset example", 10, 10, 10, WHITE);
 
@@ -23,6 +23,8 @@
     #include <emscripten/emscripten.h>
 #endif
 
+#define MAX_SHATTER_BODIES      16      // Max bodies shattered by a mouse click
+
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
@@ -35,6 +37,10 @@ int logoY = 15;
 
 PhysicsBody body = { 0 };
 
+// Physics bodies shapes lines buffer (two vertices per shape edge)
+Vector2 *lines = NULL;
+int linesCapacity = 0;
+
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
@@ -76,6 +82,7 @@ int main(void)
     // De-Initialization
     //--------------------------------------------------------------------------------------
     ClosePhysics();       // Uninitialize physics
+    free(lines);          // Unload shapes lines buffer
 
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
@@ -90,7 +97,7 @@ void UpdateDrawFrame(void)
 {
     // Update
     //----------------------------------------------------------------------------------
-    PhysicsStep();
+    UpdatePhysicsSnapshot();    // Acquire bodies transforms published by physics thread (it runs the physics steps)
 
     if (IsKeyPressed('R'))    // Reset physics input
     {
@@ -102,13 +109,11 @@ void UpdateDrawFrame(void)
 
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))    // Physics shatter input
     {
-        // Note: some values need to be stored in variables due to asynchronous changes during main thread
-        int count = GetPhysicsBodiesCount();
-        for (int i = count - 1; i >= 0; i--)
-        {
-            PhysicsBody currentBody = GetPhysicsBody(i);
-            if (currentBody != NULL) PhysicsShatter(currentBody, GetMousePosition(), 10/currentBody->inverseMass);
-        }
+        // Find bodies under mouse with a point query instead of testing every body
+        PhysicsBody hitBodies[MAX_SHATTER_BODIES] = { 0 };
+        int count = PhysicsQueryPoint(GetMousePosition(), hitBodies, MAX_SHATTER_BODIES);
+
+        for (int i = 0; i < count; i++) PhysicsShatter(hitBodies[i], GetMousePosition(), 10/hitBodies[i]->inverseMass);
     }
     //----------------------------------------------------------------------------------
 
@@ -118,26 +123,19 @@ void UpdateDrawFrame(void)
 
         ClearBackground(BLACK);
 
-        // Draw created physics bodies
-        int bodiesCount = GetPhysicsBodiesCount();
-        for (int i = 0; i < bodiesCount; i++)
+        // Draw created physics bodies, interpolated between the two steps of acquired snapshot
+        // NOTE: GetPhysicsShapesLines() writes every shape edge as a pair of transformed vertices in one pass
+        float alpha = GetPhysicsSnapshotAlpha();
+        int linesCount = GetPhysicsShapesLinesCount();
+        if (linesCount > linesCapacity)
         {
-            PhysicsBody currentBody = GetPhysicsBody(i);
-
-            int vertexCount = GetPhysicsShapeVerticesCount(i);
-            for (int j = 0; j < vertexCount; j++)
-            {
-                // Get physics bodies shape vertices to draw lines
-                // Note: GetPhysicsShapeVertex() already calculates rotation transformations
-                Vector2 vertexA = GetPhysicsShapeVertex(currentBody, j);
-
-                int jj = (((j + 1) < vertexCount) ? (j + 1) : 0);   // Get next vertex or first to close the shape
-                Vector2 vertexB = GetPhysicsShapeVertex(currentBody, jj);
-
-                DrawLineV(vertexA, vertexB, GREEN);     // Draw a line between two vertex positions
-            }
+            lines = (Vector2 *)realloc(lines, linesCount*sizeof(Vector2));
+            linesCapacity = linesCount;
         }
 
+        linesCount = GetPhysicsShapesLines(lines, linesCapacity, NULL, alpha);
+        for (int i = 0; i < linesCount; i += 2) DrawLineV(lines[i], lines[i + 1], GREEN);     // Draw a line between two vertex positions
+
         DrawText("Left mouse button in polygon area to shatter body\nPress 'R' to reset example", 10, 10, 10, WHITE);
 
         DrawText("Physac", logoX, logoY, 30, WHITE);
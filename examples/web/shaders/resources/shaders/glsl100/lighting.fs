@@ -12,29 +12,78 @@ varying vec3 fragNormal;
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
 
-#define MAX_LIGHTS 4
+#define MAX_LIGHTS 16    // WebGL 1.0 devices may only allow 64 fragment uniform vectors, every light takes three
 #define LIGHT_DIRECTIONAL 0
 #define LIGHT_POINT 1
 
+#define LIGHTS_MASKS ((MAX_LIGHTS + 31)/32)
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+
 struct MaterialProperty {
     vec3 color;
     int useSampler;
     sampler2D sampler;
 };
 
-struct Light {
-    int enabled;
-    int type;
-    vec3 position;
-    vec3 target;
-    vec4 color;
-};
-
 // Input lighting values
-uniform Light lights[MAX_LIGHTS];
+// NOTE: Every light is packed into three vec4: position (direction for directional lights) and type (negative if disabled), color, radius
+uniform vec4 lightsData[MAX_LIGHTS*3];
+uniform int lightsCount;
 uniform vec4 ambient;
 uniform vec3 viewPos;
 
+// Input lights clusters values
+// NOTE: Clusters texture keeps a lights bitmask for every view frustum cluster, clusters view
+// rows map fragment position to cluster tile and depth slice (all zero if clusters not available)
+uniform sampler2D lightsClusters;
+uniform vec4 lightsClustersView[4];
+
+// Get fragment cluster first lights mask texture coordinates
+vec2 GetClusterCoords(vec3 position)
+{
+    vec4 point = vec4(position, 1.0);
+    float depth = max(dot(lightsClustersView[2], point), 0.0001);
+
+    float x = clamp(floor(dot(lightsClustersView[0], point)/depth + lightsClustersView[3].x), 0.0, float(CLUSTERS_X - 1));
+    float y = clamp(floor(dot(lightsClustersView[1], point)/depth + lightsClustersView[3].y), 0.0, float(CLUSTERS_Y - 1));
+    float z = clamp(floor(log(depth)*lightsClustersView[3].z + lightsClustersView[3].w), 0.0, float(CLUSTERS_Z - 1));
+
+    return vec2((x + y*float(CLUSTERS_X) + 0.5)/float(CLUSTERS_X*CLUSTERS_Y), (z*float(LIGHTS_MASKS) + 0.5)/float(CLUSTERS_Z*LIGHTS_MASKS));
+}
+
+// Add light diffuse and specular contribution
+void AddLight(vec4 lightData, vec4 lightColor, vec4 lightRadius, vec3 normal, vec3 viewD, inout vec3 lightDot, inout vec3 specular)
+{
+    int lightType = int(lightData.w);
+    if (lightType < 0) return;
+
+    vec3 light = vec3(0.0);
+    float attenuation = 1.0;
+
+    if (lightType == LIGHT_DIRECTIONAL) light = normalize(lightData.xyz);
+    if (lightType == LIGHT_POINT)
+    {
+        light = normalize(lightData.xyz - fragPosition);
+
+        // Fade light out to zero at light radius (if any)
+        if (lightRadius.x > 0.0)
+        {
+            float distance = length(lightData.xyz - fragPosition)/lightRadius.x;
+            float window = clamp(1.0 - distance*distance*distance*distance, 0.0, 1.0);
+            attenuation = window*window;
+        }
+    }
+
+    float NdotL = max(dot(normal, light), 0.0);
+    lightDot += lightColor.rgb*NdotL*attenuation;
+
+    float specCo = 0.0;
+    if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
+    specular += specCo*attenuation;
+}
+
 void main()
 {
     // Texel color fetching from texture sampler
@@ -44,21 +93,27 @@ void main()
     vec3 viewD = normalize(viewPos - fragPosition);
     vec3 specular = vec3(0.0);
 
-    for (int i = 0; i < MAX_LIGHTS; i++)
+    // Evaluate only the lights in fragment cluster (every light if clusters not available)
+    // NOTE: Lights masks are scanned by bytes, so empty groups of eight lights are skipped
+    bool clustered = (lightsClustersView[3].x > 0.0);
+    vec2 clusterCoords = GetClusterCoords(fragPosition);
+
+    for (int m = 0; m < LIGHTS_MASKS; m++)
     {
-        if (lights[i].enabled == 1)
-        {
-            vec3 light = vec3(0.0);
+        vec4 mask = vec4(255.0);
+        if (clustered) mask = floor(texture2D(lightsClusters, clusterCoords + vec2(0.0, float(m)/float(CLUSTERS_Z*LIGHTS_MASKS)))*255.0 + 0.5);
 
-            if (lights[i].type == LIGHT_DIRECTIONAL) light = -normalize(lights[i].target - lights[i].position);
-            if (lights[i].type == LIGHT_POINT) light = normalize(lights[i].position - fragPosition);
+        for (int c = 0; c < 4; c++)
+        {
+            float bits = mask[c];
 
-            float NdotL = max(dot(normal, light), 0.0);
-            lightDot += lights[i].color.rgb*NdotL;
+            for (int b = 0; b < 8; b++)
+            {
+                if ((bits < 1.0) || ((m*32 + c*8 + b) >= lightsCount)) break;
 
-            float specCo = 0.0;
-            if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0);
-            specular += specCo;
+                if (mod(bits, 2.0) >= 1.0) AddLight(lightsData[(m*32 + c*8 + b)*3], lightsData[(m*32 + c*8 + b)*3 + 1], lightsData[(m*32 + c*8 + b)*3 + 2], normal, viewD, lightDot, specular);
+                bits = floor(bits*0.5);
+            }
         }
     }
 
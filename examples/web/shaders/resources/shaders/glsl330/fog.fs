@@ -15,7 +15,7 @@ out vec4 finalColor;
 
 // NOTE: Add here your custom variables
 
-#define     MAX_LIGHTS              4
+#define     MAX_LIGHTS              64
 #define     LIGHT_DIRECTIONAL       0
 #define     LIGHT_POINT             1
 
@@ -25,16 +25,10 @@ struct MaterialProperty {
     sampler2D sampler;
 };
 
-struct Light {
-    int enabled;
-    int type;
-    vec3 position;
-    vec3 target;
-    vec4 color;
-};
-
 // Input lighting values
-uniform Light lights[MAX_LIGHTS];
+// NOTE: Every light is packed into three vec4: position (direction for directional lights) and type (negative if disabled), color, radius
+uniform vec4 lightsData[MAX_LIGHTS*3];
+uniform int lightsCount;
 uniform vec4 ambient;
 uniform vec3 viewPos;
 uniform float fogDensity;
@@ -52,15 +46,21 @@ void main()
 
     for (int i = 0; i < MAX_LIGHTS; i++)
     {
-        if (lights[i].enabled == 1)
+        if (i >= lightsCount) break;
+
+        vec4 lightData = lightsData[i*3];
+        vec4 lightColor = lightsData[i*3 + 1];
+        int lightType = int(lightData.w);
+
+        if (lightType >= 0)
         {
             vec3 light = vec3(0.0);
             
-            if (lights[i].type == LIGHT_DIRECTIONAL) light = -normalize(lights[i].target - lights[i].position);
-            if (lights[i].type == LIGHT_POINT) light = normalize(lights[i].position - fragPosition);
+            if (lightType == LIGHT_DIRECTIONAL) light = normalize(lightData.xyz);
+            if (lightType == LIGHT_POINT) light = normalize(lightData.xyz - fragPosition);
 
             float NdotL = max(dot(normal, light), 0.0);
-            lightDot += lights[i].color.rgb*NdotL;
+            lightDot += lightColor.rgb*NdotL;
 
             float specCo = 0.0;
             if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // Shine: 16.0
@@ -29,6 +29,10 @@
 
 #include "raymath.h"
 
+#if !defined(PLATFORM_DESKTOP)
+    #define MAX_LIGHTS              16      // Max lights supported by GLSL 100 shaders (must match shaders MAX_LIGHTS)
+#endif
+
 #define RLIGHTS_IMPLEMENTATION
 #include "rlights.h"
 
@@ -55,6 +59,8 @@ static Model modelB =  { 0 };
 static Model modelC =  { 0 };
 static Texture texture = { 0 };
 static Shader shader = { 0 };
+static Texture lightsClusters = { 0 };
+static LightsBinding lightsBinding = { 0 };
 static int ambientLoc = 0;
 static float angle = 6.282f;
 
@@ -115,10 +121,22 @@ int main(void)
     modelC.materials[0].shader = shader;
 
     // Using 4 point lights, white, red, green and blue
-    lights[0] = CreateLight(LIGHT_POINT, (Vector3){ 4, 2, 4 }, Vector3Zero(), WHITE, shader);
-    lights[1] = CreateLight(LIGHT_POINT, (Vector3){ 4, 2, 4 }, Vector3Zero(), RED, shader);
-    lights[2] = CreateLight(LIGHT_POINT, (Vector3){ 0, 4, 2 }, Vector3Zero(), GREEN, shader);
-    lights[3] = CreateLight(LIGHT_POINT, (Vector3){ 0, 4, 2 }, Vector3Zero(), BLUE, shader);
+    // NOTE: Lights radius reaches the models from any point of their orbits, clusters farther away skip them
+    lights[0] = CreateLight(LIGHT_POINT, (Vector3){ 4, 2, 4 }, Vector3Zero(), WHITE, 10.0f);
+    lights[1] = CreateLight(LIGHT_POINT, (Vector3){ 4, 2, 4 }, Vector3Zero(), RED, 10.0f);
+    lights[2] = CreateLight(LIGHT_POINT, (Vector3){ 0, 4, 2 }, Vector3Zero(), GREEN, 10.0f);
+    lights[3] = CreateLight(LIGHT_POINT, (Vector3){ 0, 4, 2 }, Vector3Zero(), BLUE, 10.0f);
+
+    // Lights uniforms locations are retrieved once by the binding (load it again if shader is reloaded)
+    lightsBinding = LoadLightsBinding(shader);
+
+    // Load lights clusters texture, shader only evaluates the lights affecting every fragment cluster
+    // NOTE: Using MATERIAL_MAP_EMISSION as a spare slot to bind the lights clusters texture
+    lightsClusters = LoadLightsClusters();
+    modelA.materials[0].maps[MATERIAL_MAP_EMISSION].texture = lightsClusters;
+    modelB.materials[0].maps[MATERIAL_MAP_EMISSION].texture = lightsClusters;
+    modelC.materials[0].maps[MATERIAL_MAP_EMISSION].texture = lightsClusters;
+    shader.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(shader, "lightsClusters");
 
     SetCameraMode(camera, CAMERA_ORBITAL);  // Set an orbital camera mode
 
@@ -142,6 +160,7 @@ int main(void)
     UnloadModel(modelC);        // Unload the modelC
     
     UnloadTexture(texture);     // Unload the texture
+    UnloadLightsClusters();     // Unload lights clusters texture
     UnloadShader(shader);       // Unload shader
 
     CloseWindow();              // Close window and OpenGL context
@@ -175,10 +194,10 @@ void UpdateDrawFrame(void)
     lights[3].position.y = cosf(-angle*0.35f)*4.0f;
     lights[3].position.z = sinf(-angle*0.35f)*4.0f;
     
-    UpdateLightValues(shader, lights[0]);
-    UpdateLightValues(shader, lights[1]);
-    UpdateLightValues(shader, lights[2]);
-    UpdateLightValues(shader, lights[3]);
+    UpdateLightValues(lights[0]);
+    UpdateLightValues(lights[1]);
+    UpdateLightValues(lights[2]);
+    UpdateLightValues(lights[3]);
 
     // Rotate the torus
     modelA.transform = MatrixMultiply(modelA.transform, MatrixRotateX(-0.025));
@@ -187,6 +206,11 @@ void UpdateDrawFrame(void)
     // Update the light shader with the camera view position
     float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
     SetShaderValue(shader, shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+
+    // Assign lights to camera view clusters
+    UpdateLightsClusters(camera, (float)GetScreenWidth()/(float)GetScreenHeight());
+
+    UpdateLightsBuffer(&lightsBinding);     // Send all updated lights and clusters in one upload
     //----------------------------------------------------------------------------------
 
     // Draw
@@ -29,6 +29,10 @@
 
 #include "raymath.h"
 
+#if !defined(PLATFORM_DESKTOP)
+    #define MAX_LIGHTS              16      // Max lights supported by GLSL 100 shaders (must match shaders MAX_LIGHTS)
+#endif
+
 #define RLIGHTS_IMPLEMENTATION
 #include "rlights.h"
 
@@ -117,7 +121,11 @@ int main(void)
     modelC.materials[0].shader = shader;
 
     // Using just 1 point lights
-    CreateLight(LIGHT_POINT, (Vector3){ 0, 2, 6 }, Vector3Zero(), WHITE, shader);
+    CreateLight(LIGHT_POINT, (Vector3){ 0, 2, 6 }, Vector3Zero(), WHITE, 0.0f);
+
+    // Send lights to shader (lights uniforms locations are retrieved once by the binding)
+    LightsBinding lightsBinding = LoadLightsBinding(shader);
+    UpdateLightsBuffer(&lightsBinding);
 
     SetCameraMode(camera, CAMERA_ORBITAL);  // Set an orbital camera mode
 
@@ -18,6 +18,10 @@
 #include "raymath.h"
 #include "rlgl.h"
 
+#if !defined(PLATFORM_DESKTOP)
+    #define MAX_LIGHTS              16      // Max lights supported by GLSL 100 shaders (must match shaders MAX_LIGHTS)
+#endif
+
 #define RLIGHTS_IMPLEMENTATION
 #include "rlights.h"
 
@@ -117,7 +121,11 @@ int main(void)
     ambientLoc = GetShaderLocation(shader, "ambient");
     SetShaderValue(shader, ambientLoc, (float[4]){ 0.2f, 0.2f, 0.2f, 1.0f }, SHADER_UNIFORM_VEC4);
 
-    CreateLight(LIGHT_DIRECTIONAL, (Vector3){ 50, 50, 0 }, Vector3Zero(), WHITE, shader);
+    CreateLight(LIGHT_DIRECTIONAL, (Vector3){ 50, 50, 0 }, Vector3Zero(), WHITE, 0.0f);
+
+    // Send lights to shader (lights uniforms locations are retrieved once by the binding)
+    LightsBinding lightsBinding = LoadLightsBinding(shader);
+    UpdateLightsBuffer(&lightsBinding);
 
     material = LoadMaterialDefault();
     material.shader = shader;